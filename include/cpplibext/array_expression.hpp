@@ -0,0 +1,472 @@
+/*
+ * array_expression.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_ARRAY_EXPRESSION_H
+#define CPPLIBEXT_ARRAY_EXPRESSION_H
+
+
+#include <type_traits>
+#include <utility>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+
+/*
+Lazy element-wise expressions (expression templates).
+An expression like "a = b * c + d" only builds a small tree of operand pointers,
+which is evaluated in a single loop over all elements when it is assigned to an array.
+*/
+
+
+/**
+\brief Traits for the operands of array expressions.
+\remarks Specialize this template for containers which can be used as operands of element-wise array expressions.
+A specialization must provide "is_expression = true", "operand_type", and "static operand_type make_operand(const E&)".
+*/
+template <class E>
+struct array_expression_traits
+{
+    static const bool is_expression = false;
+};
+
+
+// This namespace is only used internally
+namespace details
+{
+
+
+/* ----- Element-wise operations ----- */
+
+#define CPPLIBEXT_DECL_EXPR_UNARY_OP(NAME, OP)                          \
+    struct NAME                                                         \
+    {                                                                   \
+        template <class A>                                              \
+        auto operator () (const A& a) const -> decltype(OP a)           \
+        {                                                               \
+            return (OP a);                                              \
+        }                                                               \
+    }
+
+#define CPPLIBEXT_DECL_EXPR_BINARY_OP(NAME, OP)                         \
+    struct NAME                                                         \
+    {                                                                   \
+        template <class A, class B>                                     \
+        auto operator () (const A& a, const B& b) const -> decltype(a OP b) \
+        {                                                               \
+            return (a OP b);                                            \
+        }                                                               \
+    }
+
+CPPLIBEXT_DECL_EXPR_UNARY_OP(expr_negate, -);
+
+CPPLIBEXT_DECL_EXPR_BINARY_OP(expr_add,             + );
+CPPLIBEXT_DECL_EXPR_BINARY_OP(expr_subtract,        - );
+CPPLIBEXT_DECL_EXPR_BINARY_OP(expr_multiply,        * );
+CPPLIBEXT_DECL_EXPR_BINARY_OP(expr_divide,          / );
+CPPLIBEXT_DECL_EXPR_BINARY_OP(expr_equal,           ==);
+CPPLIBEXT_DECL_EXPR_BINARY_OP(expr_not_equal,       !=);
+CPPLIBEXT_DECL_EXPR_BINARY_OP(expr_less,            < );
+CPPLIBEXT_DECL_EXPR_BINARY_OP(expr_less_equal,      <=);
+CPPLIBEXT_DECL_EXPR_BINARY_OP(expr_greater,         > );
+CPPLIBEXT_DECL_EXPR_BINARY_OP(expr_greater_equal,   >=);
+
+#undef CPPLIBEXT_DECL_EXPR_UNARY_OP
+#undef CPPLIBEXT_DECL_EXPR_BINARY_OP
+
+// Same semantics as std::min and std::max, i.e. the first argument is returned if both are equivalent.
+struct expr_min
+{
+    template <class A, class B>
+    typename std::common_type<A, B>::type operator () (A a, B b) const
+    {
+        return (b < a ? b : a);
+    }
+};
+
+struct expr_max
+{
+    template <class A, class B>
+    typename std::common_type<A, B>::type operator () (A a, B b) const
+    {
+        return (a < b ? b : a);
+    }
+};
+
+// Written as "a * b + c" (instead of std::fma), so the compiler can vectorize it and contract it to FMA instructions if they are available.
+struct expr_fma
+{
+    template <class A, class B, class C>
+    auto operator () (const A& a, const B& b, const C& c) const -> decltype(a * b + c)
+    {
+        return (a * b + c);
+    }
+};
+
+
+/* ----- Operands ----- */
+
+/*
+Leaf operand for the densely packed elements of an array.
+'Layout' is the layout mapping of the array, so arrays with different element orders can not be mixed up (void for no specific layout).
+*/
+template <typename T, std::size_t N, class Layout = void>
+class array_operand
+{
+
+    public:
+
+        using value_type    = T;
+        using layout_type   = Layout;
+
+        static const std::size_t num_elements = N;
+
+        explicit array_operand(const T* ptr) :
+            ptr_ { ptr }
+        {
+        }
+
+        const T& eval(std::size_t i) const
+        {
+            return ptr_[i];
+        }
+
+    private:
+
+        const T* ptr_;
+
+};
+
+// Leaf operand for a scalar that is broadcast to all elements (num_elements = 0).
+template <typename T>
+class scalar_operand
+{
+
+    public:
+
+        using value_type    = T;
+        using layout_type   = void;
+
+        static const std::size_t num_elements = 0;
+
+        explicit scalar_operand(const T& value) :
+            value_ { value }
+        {
+        }
+
+        T eval(std::size_t) const
+        {
+            return value_;
+        }
+
+    private:
+
+        T value_;
+
+};
+
+// Returns the number of elements of two operands, where 0 is used for scalars.
+template <std::size_t N1, std::size_t N2>
+struct expr_num_elements
+{
+    static_assert(N1 == 0 || N2 == 0 || N1 == N2, "array expression operands must have the same number of elements");
+    static const std::size_t value = (N1 != 0 ? N1 : N2);
+};
+
+// Returns the layout mapping of two operands, where void is used for scalars and operands without a specific layout.
+template <class L1, class L2>
+struct expr_layout
+{
+    static_assert(std::is_void<L1>::value || std::is_void<L2>::value || std::is_same<L1, L2>::value, "array expression operands must have the same layout");
+    using type = typename std::conditional<std::is_void<L1>::value, L2, L1>::type;
+};
+
+// Operand type of either an array expression or an arithmetic scalar.
+template <class E, bool IsExpression = array_expression_traits<E>::is_expression>
+struct expr_operand
+{
+    using type = typename array_expression_traits<E>::operand_type;
+
+    static type make(const E& e)
+    {
+        return array_expression_traits<E>::make_operand(e);
+    }
+};
+
+template <class E>
+struct expr_operand<E, false>
+{
+    using type = scalar_operand<E>;
+
+    static type make(const E& e)
+    {
+        return type(e);
+    }
+};
+
+// Returns true if E is either an array expression or an arithmetic scalar.
+template <class E>
+struct is_expr_operand
+{
+    static const bool value = (array_expression_traits<E>::is_expression || std::is_arithmetic<E>::value);
+};
+
+// Returns true if the arguments are valid for an element-wise operation, i.e. at least one of them must be an array expression.
+template <class... Args>
+struct is_expr_operation;
+
+template <>
+struct is_expr_operation<>
+{
+    static const bool all_operands  = true;
+    static const bool any_array     = false;
+    static const bool value         = false;
+};
+
+template <class Arg1, class... ArgN>
+struct is_expr_operation<Arg1, ArgN...>
+{
+    static const bool all_operands  = (is_expr_operand<Arg1>::value && is_expr_operation<ArgN...>::all_operands);
+    static const bool any_array     = (array_expression_traits<Arg1>::is_expression || is_expr_operation<ArgN...>::any_array);
+    static const bool value         = (all_operands && any_array);
+};
+
+
+} // /namespace details
+
+
+/* ----- Expression nodes ----- */
+
+//! Unary element-wise array expression.
+template <class Op, class A>
+class unary_array_expression
+{
+
+    public:
+
+        using value_type = typename std::decay<decltype(Op()(std::declval<typename A::value_type>()))>::type;
+
+        using layout_type = typename A::layout_type;
+
+        static const std::size_t num_elements = A::num_elements;
+
+        explicit unary_array_expression(const A& a) :
+            a_ { a }
+        {
+        }
+
+        value_type eval(std::size_t i) const
+        {
+            return Op()(a_.eval(i));
+        }
+
+    private:
+
+        A a_;
+
+};
+
+//! Binary element-wise array expression.
+template <class Op, class A, class B>
+class binary_array_expression
+{
+
+    public:
+
+        using value_type = typename std::decay<decltype(Op()(std::declval<typename A::value_type>(), std::declval<typename B::value_type>()))>::type;
+
+        using layout_type = typename details::expr_layout<typename A::layout_type, typename B::layout_type>::type;
+
+        static const std::size_t num_elements = details::expr_num_elements<A::num_elements, B::num_elements>::value;
+
+        binary_array_expression(const A& a, const B& b) :
+            a_ { a },
+            b_ { b }
+        {
+        }
+
+        value_type eval(std::size_t i) const
+        {
+            return Op()(a_.eval(i), b_.eval(i));
+        }
+
+    private:
+
+        A a_;
+        B b_;
+
+};
+
+//! Ternary element-wise array expression.
+template <class Op, class A, class B, class C>
+class ternary_array_expression
+{
+
+    public:
+
+        using value_type = typename std::decay<decltype(Op()(std::declval<typename A::value_type>(), std::declval<typename B::value_type>(), std::declval<typename C::value_type>()))>::type;
+
+        using layout_type = typename details::expr_layout<typename details::expr_layout<typename A::layout_type, typename B::layout_type>::type, typename C::layout_type>::type;
+
+        static const std::size_t num_elements = details::expr_num_elements<details::expr_num_elements<A::num_elements, B::num_elements>::value, C::num_elements>::value;
+
+        ternary_array_expression(const A& a, const B& b, const C& c) :
+            a_ { a },
+            b_ { b },
+            c_ { c }
+        {
+        }
+
+        value_type eval(std::size_t i) const
+        {
+            return Op()(a_.eval(i), b_.eval(i), c_.eval(i));
+        }
+
+    private:
+
+        A a_;
+        B b_;
+        C c_;
+
+};
+
+template <class Op, class A>
+struct array_expression_traits<unary_array_expression<Op, A>>
+{
+    static const bool is_expression = true;
+
+    using operand_type = unary_array_expression<Op, A>;
+
+    static const operand_type& make_operand(const operand_type& e)
+    {
+        return e;
+    }
+};
+
+template <class Op, class A, class B>
+struct array_expression_traits<binary_array_expression<Op, A, B>>
+{
+    static const bool is_expression = true;
+
+    using operand_type = binary_array_expression<Op, A, B>;
+
+    static const operand_type& make_operand(const operand_type& e)
+    {
+        return e;
+    }
+};
+
+template <class Op, class A, class B, class C>
+struct array_expression_traits<ternary_array_expression<Op, A, B, C>>
+{
+    static const bool is_expression = true;
+
+    using operand_type = ternary_array_expression<Op, A, B, C>;
+
+    static const operand_type& make_operand(const operand_type& e)
+    {
+        return e;
+    }
+};
+
+//! Returns true if E is an expression node (i.e. not a container), which can be assigned to an array.
+template <class E>
+struct is_array_expression_node
+{
+    static const bool value = false;
+};
+
+template <class Op, class A>
+struct is_array_expression_node<unary_array_expression<Op, A>>
+{
+    static const bool value = true;
+};
+
+template <class Op, class A, class B>
+struct is_array_expression_node<binary_array_expression<Op, A, B>>
+{
+    static const bool value = true;
+};
+
+template <class Op, class A, class B, class C>
+struct is_array_expression_node<ternary_array_expression<Op, A, B, C>>
+{
+    static const bool value = true;
+};
+
+
+/* ----- Operators ----- */
+
+#define CPPLIBEXT_DEF_EXPR_BINARY_FUNC(FUNC, OP)                                                                    \
+    template <class A, class B>                                                                                     \
+    typename std::enable_if                                                                                         \
+    <                                                                                                               \
+        details::is_expr_operation<A, B>::value,                                                                    \
+        binary_array_expression<OP, typename details::expr_operand<A>::type, typename details::expr_operand<B>::type> \
+    >::type FUNC(const A& a, const B& b)                                                                            \
+    {                                                                                                               \
+        using result_type = binary_array_expression<OP, typename details::expr_operand<A>::type, typename details::expr_operand<B>::type>; \
+        return result_type(details::expr_operand<A>::make(a), details::expr_operand<B>::make(b));                   \
+    }
+
+CPPLIBEXT_DEF_EXPR_BINARY_FUNC(operator +,  details::expr_add           )
+CPPLIBEXT_DEF_EXPR_BINARY_FUNC(operator -,  details::expr_subtract      )
+CPPLIBEXT_DEF_EXPR_BINARY_FUNC(operator *,  details::expr_multiply      )
+CPPLIBEXT_DEF_EXPR_BINARY_FUNC(operator /,  details::expr_divide        )
+CPPLIBEXT_DEF_EXPR_BINARY_FUNC(operator ==, details::expr_equal         )
+CPPLIBEXT_DEF_EXPR_BINARY_FUNC(operator !=, details::expr_not_equal     )
+CPPLIBEXT_DEF_EXPR_BINARY_FUNC(operator <,  details::expr_less          )
+CPPLIBEXT_DEF_EXPR_BINARY_FUNC(operator <=, details::expr_less_equal    )
+CPPLIBEXT_DEF_EXPR_BINARY_FUNC(operator >,  details::expr_greater       )
+CPPLIBEXT_DEF_EXPR_BINARY_FUNC(operator >=, details::expr_greater_equal )
+
+//! Element-wise minimum of two array expressions (or an array expression and a scalar).
+CPPLIBEXT_DEF_EXPR_BINARY_FUNC(min, details::expr_min)
+
+//! Element-wise maximum of two array expressions (or an array expression and a scalar).
+CPPLIBEXT_DEF_EXPR_BINARY_FUNC(max, details::expr_max)
+
+#undef CPPLIBEXT_DEF_EXPR_BINARY_FUNC
+
+template <class A>
+typename std::enable_if
+<
+    array_expression_traits<A>::is_expression,
+    unary_array_expression<details::expr_negate, typename details::expr_operand<A>::type>
+>::type operator - (const A& a)
+{
+    using result_type = unary_array_expression<details::expr_negate, typename details::expr_operand<A>::type>;
+    return result_type(details::expr_operand<A>::make(a));
+}
+
+/**
+\brief Element-wise fused multiply-add, i.e. "a * b + c" for each element.
+\remarks This is evaluated as "a * b + c", so the compiler may contract it into FMA instructions (and round only once) if the target supports them.
+*/
+template <class A, class B, class C>
+typename std::enable_if
+<
+    details::is_expr_operation<A, B, C>::value,
+    ternary_array_expression<details::expr_fma, typename details::expr_operand<A>::type, typename details::expr_operand<B>::type, typename details::expr_operand<C>::type>
+>::type fma(const A& a, const B& b, const C& c)
+{
+    using result_type = ternary_array_expression<details::expr_fma, typename details::expr_operand<A>::type, typename details::expr_operand<B>::type, typename details::expr_operand<C>::type>;
+    return result_type(details::expr_operand<A>::make(a), details::expr_operand<B>::make(b), details::expr_operand<C>::make(c));
+}
+
+
+} // /namespace ext
+
+
+#endif
+
+
@@ -0,0 +1,92 @@
+/*
+ * border_policy.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_BORDER_POLICY_H
+#define CPPLIBEXT_BORDER_POLICY_H
+
+
+#include <cstdlib>
+
+
+namespace ext
+{
+
+
+/*
+Border policies for stencil_transform and convolve, which map an index outside of [0, extent) to an index inside,
+or to -1 for elements that are replaced by a constant value.
+*/
+
+//! Border policy which repeats the nearest element inside the array.
+struct clamp_border
+{
+    std::ptrdiff_t resolve(std::ptrdiff_t index, std::ptrdiff_t extent) const
+    {
+        return (index < 0 ? 0 : (index >= extent ? extent - 1 : index));
+    }
+};
+
+//! Border policy which continues at the opposite side of the array.
+struct wrap_border
+{
+    std::ptrdiff_t resolve(std::ptrdiff_t index, std::ptrdiff_t extent) const
+    {
+        return ((index % extent) + extent) % extent;
+    }
+};
+
+//! Border policy which returns a constant value for all elements outside of the array.
+template <typename T>
+struct constant_border
+{
+    std::ptrdiff_t resolve(std::ptrdiff_t index, std::ptrdiff_t extent) const
+    {
+        return (index < 0 || index >= extent ? -1 : index);
+    }
+
+    T value;
+};
+
+//! Returns a constant_border with the specified value, e.g. "make_constant_border(0.0f)".
+template <typename T>
+constant_border<T> make_constant_border(const T& value)
+{
+    return { value };
+}
+
+
+// This namespace is only used internally
+namespace details
+{
+
+
+// Returns the value of the elements outside of the array, which is only used for constant_border.
+template <typename T, class Border>
+T border_value(const Border&)
+{
+    return T();
+}
+
+template <typename T, typename U>
+T border_value(const constant_border<U>& border)
+{
+    return static_cast<T>(border.value);
+}
+
+
+} // /namespace details
+
+} // /namespace ext
+
+
+#endif
+
+
+
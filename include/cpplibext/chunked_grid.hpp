@@ -0,0 +1,527 @@
+/*
+ * chunked_grid.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_CHUNKED_GRID_H
+#define CPPLIBEXT_CHUNKED_GRID_H
+
+
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+#include <memory>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+
+/**
+\brief Unbounded 2-dimensional grid, which only allocates chunks of ChunkWidth x ChunkHeight elements on the first write into them.
+\tparam T Specifies the data type for the grid elements.
+\tparam ChunkWidth Specifies the number of columns in each chunk. This should be a power of two, so the divisions are cheap.
+\tparam ChunkHeight Specifies the number of rows in each chunk. This should be a power of two, so the divisions are cheap.
+\remarks The coordinates are signed, so the grid extends into all directions. The chunks are found with an open-addressed hash table
+on the chunk coordinates, and the last chunk that was hit through a non-const function is cached, so neighboring accesses skip the hash lookup.
+Reading an element of an unallocated chunk returns the background value without allocating anything.
+The const functions only read the cache, so they can be called concurrently from multiple threads, like the const functions of the standard containers.
+\code
+// Example usage:
+ext::chunked_grid<int, 32, 32> world(0);
+world(-1000, 5000) = 1;             // Allocates the chunk of 32x32 elements which contains (-1000, 5000)
+int x = world(123456, -789);        // Returns the background 0
+world.for_each_chunk([](ext::chunked_grid<int, 32, 32>::chunk& c)
+{
+    // c.x(), c.y() are the chunk coordinates, c(x, y) are the elements of the chunk
+});
+\endcode
+*/
+template <typename T, std::size_t ChunkWidth = 32, std::size_t ChunkHeight = ChunkWidth>
+class chunked_grid
+{
+
+    public:
+
+        static_assert(ChunkWidth > 0 && ChunkHeight > 0, "chunk size of chunked_grid must be greater than zero");
+
+        using value_type        = T;
+        using size_type         = std::size_t;
+        using difference_type   = std::ptrdiff_t;
+        using const_reference   = const value_type&;
+
+        //! Signed type of the grid coordinates.
+        using coord_type        = std::ptrdiff_t;
+
+        //! Number of columns in each chunk.
+        static const size_type chunk_width      = ChunkWidth;
+
+        //! Number of rows in each chunk.
+        static const size_type chunk_height     = ChunkHeight;
+
+        //! Number of elements per chunk.
+        static const size_type chunk_elements   = ChunkWidth * ChunkHeight;
+
+    private:
+
+        using this_type = chunked_grid<T, ChunkWidth, ChunkHeight>;
+
+        // Hash table entry for empty slots (otherwise the entry is the index in 'chunks_').
+        enum : std::uint32_t { no_chunk = 0xFFFFFFFFu };
+
+        // Initial number of hash table slots (must be a power of two).
+        enum : size_type { initial_slots = 16 };
+
+    public:
+
+        //! Dense chunk of ChunkWidth x ChunkHeight elements in row-major order.
+        class chunk
+        {
+
+            public:
+
+                //! Returns the x coordinate of this chunk, i.e. the grid x coordinate of its first column divided by ChunkWidth.
+                coord_type x() const
+                {
+                    return x_;
+                }
+
+                //! Returns the y coordinate of this chunk, i.e. the grid y coordinate of its first row divided by ChunkHeight.
+                coord_type y() const
+                {
+                    return y_;
+                }
+
+                //! Returns the element at the specified coordinates relative to this chunk.
+                value_type& operator () (size_type x, size_type y)
+                {
+                    return data_[y*ChunkWidth + x];
+                }
+
+                const_reference operator () (size_type x, size_type y) const
+                {
+                    return data_[y*ChunkWidth + x];
+                }
+
+                value_type* data()
+                {
+                    return data_.data();
+                }
+
+                const value_type* data() const
+                {
+                    return data_.data();
+                }
+
+            private:
+
+                friend class chunked_grid;
+
+                chunk(coord_type x, coord_type y, const value_type& background) :
+                    x_ { x },
+                    y_ { y }
+                {
+                    data_.fill(background);
+                }
+
+                coord_type                              x_;
+                coord_type                              y_;
+                std::array<value_type, chunk_elements>  data_;
+
+        };
+
+        /**
+        \brief Proxy reference to an element, which only allocates the chunk when a value is assigned.
+        \remarks Reading through this proxy does not allocate anything.
+        */
+        class reference
+        {
+
+            public:
+
+                operator const_reference () const
+                {
+                    return owner_->get_cached(x_, y_);
+                }
+
+                reference& operator = (const value_type& value)
+                {
+                    owner_->element(x_, y_) = value;
+                    return *this;
+                }
+
+                reference& operator = (const reference& rhs)
+                {
+                    return (*this = static_cast<const_reference>(rhs));
+                }
+
+            private:
+
+                friend class chunked_grid;
+
+                reference(this_type* owner, coord_type x, coord_type y) :
+                    owner_ { owner },
+                    x_     { x     },
+                    y_     { y     }
+                {
+                }
+
+                this_type*  owner_;
+                coord_type  x_;
+                coord_type  y_;
+
+        };
+
+        //! Forward iterator over the elements of all allocated chunks.
+        template <class Owner, typename Ref>
+        class basic_iterator
+        {
+
+            public:
+
+                using iterator_category = std::forward_iterator_tag;
+                using value_type        = typename this_type::value_type;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = typename std::remove_reference<Ref>::type*;
+                using reference         = Ref;
+
+                basic_iterator() = default;
+
+                reference operator * () const
+                {
+                    return owner_->chunks_[chunk_]->data_[element_];
+                }
+
+                pointer operator -> () const
+                {
+                    return &(owner_->chunks_[chunk_]->data_[element_]);
+                }
+
+                basic_iterator& operator ++ ()
+                {
+                    if (++element_ == chunk_elements)
+                    {
+                        element_ = 0;
+                        ++chunk_;
+                    }
+                    return *this;
+                }
+
+                basic_iterator operator ++ (int)
+                {
+                    auto tmp = *this;
+                    operator ++ ();
+                    return tmp;
+                }
+
+                bool operator == (const basic_iterator& rhs) const
+                {
+                    return (chunk_ == rhs.chunk_ && element_ == rhs.element_);
+                }
+
+                bool operator != (const basic_iterator& rhs) const
+                {
+                    return !(*this == rhs);
+                }
+
+                //! Returns the x coordinate of the current element in the grid.
+                coord_type x() const
+                {
+                    return owner_->chunks_[chunk_]->x_ * static_cast<coord_type>(ChunkWidth) + static_cast<coord_type>(element_ % ChunkWidth);
+                }
+
+                //! Returns the y coordinate of the current element in the grid.
+                coord_type y() const
+                {
+                    return owner_->chunks_[chunk_]->y_ * static_cast<coord_type>(ChunkHeight) + static_cast<coord_type>(element_ / ChunkWidth);
+                }
+
+            private:
+
+                friend class chunked_grid;
+
+                basic_iterator(Owner* owner, size_type chunk) :
+                    owner_ { owner },
+                    chunk_ { chunk }
+                {
+                }
+
+                Owner*      owner_      = nullptr;
+                size_type   chunk_      = 0;
+                size_type   element_    = 0;
+
+        };
+
+        using iterator          = basic_iterator<this_type, value_type&>;
+        using const_iterator    = basic_iterator<const this_type, const value_type&>;
+
+    public:
+
+        /**
+        \brief Constructs the grid without any allocated chunks.
+        \param[in] background Specifies the value of all elements in unallocated chunks.
+        */
+        explicit chunked_grid(const value_type& background = value_type()) :
+            background_ ( background )
+        {
+        }
+
+        chunked_grid(const this_type& rhs) :
+            slots_      ( rhs.slots_      ),
+            background_ ( rhs.background_ )
+        {
+            chunks_.reserve(rhs.chunks_.size());
+            for (const auto& c : rhs.chunks_)
+                chunks_.emplace_back(new chunk(*c));
+        }
+
+        chunked_grid(this_type&& rhs) :
+            slots_      ( std::move(rhs.slots_)      ),
+            chunks_     ( std::move(rhs.chunks_)     ),
+            background_ ( std::move(rhs.background_) ),
+            cache_      ( rhs.cache_                 )
+        {
+            rhs.cache_ = nullptr;
+        }
+
+        this_type& operator = (const this_type& rhs)
+        {
+            if (this != &rhs)
+            {
+                this_type tmp(rhs);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        this_type& operator = (this_type&& rhs)
+        {
+            this_type tmp(std::move(rhs));
+            swap(tmp);
+            return *this;
+        }
+
+        void swap(this_type& other)
+        {
+            slots_.swap(other.slots_);
+            chunks_.swap(other.chunks_);
+            std::swap(background_, other.background_);
+            std::swap(cache_, other.cache_);
+        }
+
+        //! Returns the value of all elements in unallocated chunks.
+        const_reference background() const
+        {
+            return background_;
+        }
+
+        //! Returns the number of allocated chunks.
+        size_type allocated_chunks() const
+        {
+            return chunks_.size();
+        }
+
+        //! Returns true if no chunk is allocated, i.e. all elements have the background value.
+        bool empty() const
+        {
+            return chunks_.empty();
+        }
+
+        //! Releases all chunks, so all elements have the background value again.
+        void clear()
+        {
+            cache_ = nullptr;
+            chunks_.clear();
+            slots_.clear();
+        }
+
+        //! Returns true if the chunk of the element at the specified coordinates is allocated.
+        bool is_allocated(coord_type x, coord_type y) const
+        {
+            return (find_chunk(chunk_coord(x, ChunkWidth), chunk_coord(y, ChunkHeight)) != nullptr);
+        }
+
+        //! Returns the chunk with the specified chunk coordinates, or null if this chunk is not allocated. The chunk is cached for the next access.
+        chunk* find_chunk(coord_type chunk_x, coord_type chunk_y)
+        {
+            auto c = lookup_chunk(chunk_x, chunk_y);
+            if (c != nullptr)
+                cache_ = c;
+            return c;
+        }
+
+        //! Returns the chunk with the specified chunk coordinates, or null if this chunk is not allocated. This does not modify the cache.
+        const chunk* find_chunk(coord_type chunk_x, coord_type chunk_y) const
+        {
+            return lookup_chunk(chunk_x, chunk_y);
+        }
+
+        //! Calls the specified function for each allocated chunk with the signature "void func(chunk& c)".
+        template <class Function>
+        void for_each_chunk(Function func)
+        {
+            for (const auto& c : chunks_)
+                func(*c);
+        }
+
+        //! Calls the specified function for each allocated chunk with the signature "void func(const chunk& c)".
+        template <class Function>
+        void for_each_chunk(Function func) const
+        {
+            for (const auto& c : chunks_)
+                func(static_cast<const chunk&>(*c));
+        }
+
+        iterator begin()
+        {
+            return iterator(this, 0);
+        }
+
+        const_iterator begin() const
+        {
+            return const_iterator(this, 0);
+        }
+
+        iterator end()
+        {
+            return iterator(this, chunks_.size());
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator(this, chunks_.size());
+        }
+
+        //! Returns a proxy reference to the element at the specified coordinates.
+        reference operator () (coord_type x, coord_type y)
+        {
+            return reference(this, x, y);
+        }
+
+        //! Returns the element at the specified coordinates, or the background value if its chunk is not allocated.
+        const_reference operator () (coord_type x, coord_type y) const
+        {
+            return get(x, y);
+        }
+
+    private:
+
+        // Returns the chunk coordinate for the specified grid coordinate, i.e. the division rounded towards negative infinity.
+        static coord_type chunk_coord(coord_type coord, size_type size)
+        {
+            const auto n = static_cast<coord_type>(size);
+            return (coord >= 0 ? coord / n : -((-coord - 1) / n) - 1);
+        }
+
+        // Returns the offset of the element at the specified grid coordinates within its chunk.
+        static size_type element_offset(coord_type x, coord_type y, coord_type chunk_x, coord_type chunk_y)
+        {
+            const auto local_x = static_cast<size_type>(x - chunk_x * static_cast<coord_type>(ChunkWidth));
+            const auto local_y = static_cast<size_type>(y - chunk_y * static_cast<coord_type>(ChunkHeight));
+            return (local_y * ChunkWidth + local_x);
+        }
+
+        static size_type hash(coord_type chunk_x, coord_type chunk_y)
+        {
+            auto h = static_cast<std::uint64_t>(chunk_x) * 0x9E3779B97F4A7C15ull ^ static_cast<std::uint64_t>(chunk_y) * 0xC2B2AE3D27D4EB4Full;
+            return static_cast<size_type>(h ^ (h >> 32));
+        }
+
+        // Returns the slot of the specified chunk, or the empty slot where it would be inserted (with linear probing).
+        size_type find_slot(coord_type chunk_x, coord_type chunk_y) const
+        {
+            const auto mask = slots_.size() - 1;
+            for (auto i = hash(chunk_x, chunk_y) & mask;; i = (i + 1) & mask)
+            {
+                const auto entry = slots_[i];
+                if (entry == no_chunk || (chunks_[entry]->x_ == chunk_x && chunks_[entry]->y_ == chunk_y))
+                    return i;
+            }
+        }
+
+        // Doubles the number of hash table slots and re-inserts all chunks.
+        void grow_slots()
+        {
+            slots_.assign(std::max<size_type>(initial_slots, slots_.size() * 2), no_chunk);
+            for (size_type i = 0; i < chunks_.size(); ++i)
+                slots_[find_slot(chunks_[i]->x_, chunks_[i]->y_)] = static_cast<std::uint32_t>(i);
+        }
+
+        // Returns the cached chunk if it matches, or looks up the chunk in the hash table.
+        chunk* lookup_chunk(coord_type chunk_x, coord_type chunk_y) const
+        {
+            if (cache_ != nullptr && cache_->x_ == chunk_x && cache_->y_ == chunk_y)
+                return cache_;
+            if (slots_.empty())
+                return nullptr;
+            const auto entry = slots_[find_slot(chunk_x, chunk_y)];
+            return (entry == no_chunk ? nullptr : chunks_[entry].get());
+        }
+
+        const_reference get(coord_type x, coord_type y) const
+        {
+            const auto chunk_x = chunk_coord(x, ChunkWidth);
+            const auto chunk_y = chunk_coord(y, ChunkHeight);
+            if (auto c = lookup_chunk(chunk_x, chunk_y))
+                return c->data_[element_offset(x, y, chunk_x, chunk_y)];
+            return background_;
+        }
+
+        // Same as get, but caches the chunk for the next access (used by the proxy reference of non-const grids).
+        const_reference get_cached(coord_type x, coord_type y)
+        {
+            const auto chunk_x = chunk_coord(x, ChunkWidth);
+            const auto chunk_y = chunk_coord(y, ChunkHeight);
+            if (auto c = find_chunk(chunk_x, chunk_y))
+                return c->data_[element_offset(x, y, chunk_x, chunk_y)];
+            return background_;
+        }
+
+        // Returns the element at the specified coordinates and allocates its chunk if necessary.
+        value_type& element(coord_type x, coord_type y)
+        {
+            const auto chunk_x = chunk_coord(x, ChunkWidth);
+            const auto chunk_y = chunk_coord(y, ChunkHeight);
+
+            auto c = find_chunk(chunk_x, chunk_y);
+            if (c == nullptr)
+            {
+                /* Keep the load factor of the hash table below 1/2 */
+                if ((chunks_.size() + 1) * 2 > slots_.size())
+                    grow_slots();
+
+                chunks_.emplace_back(new chunk(chunk_x, chunk_y, background_));
+                slots_[find_slot(chunk_x, chunk_y)] = static_cast<std::uint32_t>(chunks_.size() - 1);
+                c = chunks_.back().get();
+                cache_ = c;
+            }
+
+            return c->data_[element_offset(x, y, chunk_x, chunk_y)];
+        }
+
+    private:
+
+        std::vector<std::uint32_t>              slots_;
+        std::vector<std::unique_ptr<chunk>>     chunks_;
+        value_type                              background_;
+        chunk*                                  cache_      = nullptr; // Last chunk that was hit through a non-const function
+
+};
+
+
+} // /namespace ext
+
+
+#endif
+
+
+
@@ -0,0 +1,316 @@
+/*
+ * convolution.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_CONVOLUTION_H
+#define CPPLIBEXT_CONVOLUTION_H
+
+
+#include "grid_vector.hpp"
+#include "border_policy.hpp"
+#include "thread_pool.hpp"
+#include "details/convolution_kernel.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+// Converts a convolution result to the element type, with rounding and saturation for integral types (e.g. uint8_t).
+template <typename T>
+T convolution_cast(float value, std::true_type)
+{
+    const float lo = static_cast<float>(std::numeric_limits<T>::lowest());
+    const float hi = static_cast<float>(std::numeric_limits<T>::max());
+    value = (value < lo ? lo : (value > hi ? hi : value));
+    return static_cast<T>(value < 0.0f ? value - 0.5f : value + 0.5f);
+}
+
+template <typename T>
+T convolution_cast(float value, std::false_type)
+{
+    return static_cast<T>(value);
+}
+
+template <typename T>
+void store_convolution_row(const float* src, T* dst, std::size_t width)
+{
+    for (std::size_t x = 0; x < width; ++x)
+        dst[x] = convolution_cast<T>(src[x], std::integral_constant<bool, std::is_integral<T>::value>());
+}
+
+/*
+Converts the specified source row into floats with 'left' and 'right' border elements.
+If 'src' is null, the entire row is outside of the grid and is filled with the value of the constant_border.
+*/
+template <typename T, class Border>
+void load_convolution_row(const T* src, std::size_t width, std::size_t left, std::size_t right, const Border& border, float* dst)
+{
+    const auto outside = border_value<float>(border);
+
+    if (src == nullptr)
+    {
+        std::fill(dst, dst + left + width + right, outside);
+        return;
+    }
+
+    const auto extent = static_cast<std::ptrdiff_t>(width);
+
+    for (std::size_t i = 0; i < left; ++i)
+    {
+        const auto index = border.resolve(static_cast<std::ptrdiff_t>(i) - static_cast<std::ptrdiff_t>(left), extent);
+        dst[i] = (index < 0 ? outside : static_cast<float>(src[index]));
+    }
+
+    for (std::size_t x = 0; x < width; ++x)
+        dst[left + x] = static_cast<float>(src[x]);
+
+    for (std::size_t i = 0; i < right; ++i)
+    {
+        const auto index = border.resolve(extent + static_cast<std::ptrdiff_t>(i), extent);
+        dst[left + width + i] = (index < 0 ? outside : static_cast<float>(src[index]));
+    }
+}
+
+// Returns the source row for the row index 'y', which may be outside of the grid, or null for rows with the constant border value.
+template <typename T, class Border>
+const T* convolution_source_row(const T* src, std::size_t src_pitch, std::size_t height, std::ptrdiff_t y, const Border& border)
+{
+    const auto index = border.resolve(y, static_cast<std::ptrdiff_t>(height));
+    return (index < 0 ? nullptr : src + static_cast<std::size_t>(index) * src_pitch);
+}
+
+// Splits the rows into chunks for the thread pool and calls 'func(first, last)' for each chunk.
+template <class Func>
+void convolution_chunks(thread_pool& pool, std::size_t width, std::size_t height, Func func)
+{
+    if (width == 0)
+        return;
+    const std::size_t num_chunks = std::min(height, pool.concurrency() * 4);
+    pool.run(
+        num_chunks,
+        [&](std::size_t chunk)
+        {
+            func(height * chunk / num_chunks, height * (chunk + 1) / num_chunks);
+        }
+    );
+}
+
+/*
+Non-separable convolution with a kernel of 'kernel_width' x 'kernel_height' weights in row-major order.
+Each chunk converts the source rows it needs (including the rows above and below) into padded float rows once.
+*/
+template <typename T, typename U, class Border>
+void convolve_2d(
+    simd_level level, thread_pool& pool,
+    const T* src, std::size_t src_pitch, U* dst, std::size_t dst_pitch, std::size_t width, std::size_t height,
+    const float* kernel, std::size_t kernel_width, std::size_t kernel_height, const Border& border)
+{
+    const std::size_t left          = kernel_width / 2;
+    const std::size_t top           = kernel_height / 2;
+    const std::size_t padded_width  = width + kernel_width - 1;
+
+    convolution_chunks(
+        pool, width, height,
+        [&](std::size_t first, std::size_t last)
+        {
+            const std::size_t num_rows = last - first + kernel_height - 1;
+            std::vector<float> padded(num_rows * padded_width), result(width);
+            std::vector<const float*> rows(kernel_height);
+
+            for (std::size_t r = 0; r < num_rows; ++r)
+            {
+                const auto y = static_cast<std::ptrdiff_t>(first + r) - static_cast<std::ptrdiff_t>(top);
+                const T* src_row = convolution_source_row(src, src_pitch, height, y, border);
+                load_convolution_row(src_row, width, left, kernel_width - 1 - left, border, padded.data() + r*padded_width);
+            }
+
+            for (std::size_t y = first; y < last; ++y)
+            {
+                for (std::size_t j = 0; j < kernel_height; ++j)
+                    rows[j] = padded.data() + (y - first + j)*padded_width;
+                convolve_rows(level, rows.data(), kernel_height, kernel, kernel_width, result.data(), width);
+                store_convolution_row(result.data(), dst + y*dst_pitch, width);
+            }
+        }
+    );
+}
+
+/*
+Separable convolution: each chunk filters the source rows it needs horizontally with 'kernel_x',
+and then filters the intermediate rows vertically with 'kernel_y'.
+*/
+template <typename T, typename U, class Border>
+void convolve_separable(
+    simd_level level, thread_pool& pool,
+    const T* src, std::size_t src_pitch, U* dst, std::size_t dst_pitch, std::size_t width, std::size_t height,
+    const float* kernel_x, std::size_t taps_x, const float* kernel_y, std::size_t taps_y, const Border& border)
+{
+    const std::size_t left          = taps_x / 2;
+    const std::size_t top           = taps_y / 2;
+    const std::size_t padded_width  = width + taps_x - 1;
+
+    convolution_chunks(
+        pool, width, height,
+        [&](std::size_t first, std::size_t last)
+        {
+            const std::size_t num_rows = last - first + taps_y - 1;
+            std::vector<float> padded(padded_width), filtered(num_rows * width), result(width);
+            std::vector<const float*> rows(taps_y);
+
+            /* Horizontal pass */
+            for (std::size_t r = 0; r < num_rows; ++r)
+            {
+                const auto y = static_cast<std::ptrdiff_t>(first + r) - static_cast<std::ptrdiff_t>(top);
+                const T* src_row = convolution_source_row(src, src_pitch, height, y, border);
+                load_convolution_row(src_row, width, left, taps_x - 1 - left, border, padded.data());
+                const float* padded_row = padded.data();
+                convolve_rows(level, &padded_row, 1, kernel_x, taps_x, filtered.data() + r*width, width);
+            }
+
+            /* Vertical pass */
+            for (std::size_t y = first; y < last; ++y)
+            {
+                for (std::size_t j = 0; j < taps_y; ++j)
+                    rows[j] = filtered.data() + (y - first + j)*width;
+                convolve_rows(level, rows.data(), taps_y, kernel_y, 1, result.data(), width);
+                store_convolution_row(result.data(), dst + y*dst_pitch, width);
+            }
+        }
+    );
+}
+
+template <class Src, class Dst>
+void check_convolution_grids(const Src& src, const Dst& dst)
+{
+    if (static_cast<const void*>(&src) == static_cast<const void*>(&dst))
+        throw std::invalid_argument("convolve source and destination must not be the same grid");
+}
+
+
+} // /namespace details
+
+
+/**
+\brief Convolves a grid_vector with a 2-dimensional kernel, i.e. dst(x, y) = sum of kernel(i, j) * src(x + i - kw/2, y + j - kh/2).
+\param[in] pool Specifies the thread pool that executes the work. The rows are split into chunks.
+\param[in] src Specifies the source grid, e.g. grid_vector<float> or grid_vector<uint8_t>.
+\param[out] dst Specifies the destination grid. This will be resized to the size of 'src' and must not refer to the same grid.
+\param[in] kernel Specifies the kernel weights. The center of the kernel is at (kernel.width()/2, kernel.height()/2).
+\param[in] border Specifies the border policy for elements outside of the grid: clamp_border, wrap_border, or constant_border.
+\remarks The sums are computed with float precision. Integral results are rounded and saturated, e.g. to [0, 255] for uint8_t.
+The kernel is chosen at runtime from AVX2+FMA, SSE, and a scalar fallback.
+\throws std::invalid_argument If the kernel is empty or 'src' and 'dst' refer to the same grid.
+\see convolve_separable
+\code
+// Example usage (Laplace filter):
+ext::grid_vector<float> laplace;
+laplace.resize(3, 3, 0.0f);
+laplace(1, 0) = laplace(0, 1) = laplace(2, 1) = laplace(1, 2) = 1.0f;
+laplace(1, 1) = -4.0f;
+ext::convolve(image, edges, laplace, ext::clamp_border());
+\endcode
+*/
+template <typename T, class AllocSrc, class TrackingSrc, class PaddingSrc, typename U, class AllocDst, class TrackingDst, class PaddingDst, class AllocK, class TrackingK, class PaddingK, class Border>
+void convolve(
+    thread_pool&                                        pool,
+    const grid_vector<T, AllocSrc, TrackingSrc, PaddingSrc>&        src,
+    grid_vector<U, AllocDst, TrackingDst, PaddingDst>&              dst,
+    const grid_vector<float, AllocK, TrackingK, PaddingK>&        kernel,
+    const Border&                                       border)
+{
+    if (kernel.empty())
+        throw std::invalid_argument("convolve kernel must not be empty");
+    details::check_convolution_grids(src, dst);
+
+    /* Copy the kernel into a dense array (without the row padding) */
+    std::vector<float> weights(kernel.begin(), kernel.end());
+
+    dst.resize(src.width(), src.height());
+    details::convolve_2d(
+        details::cpu_simd_level(), pool,
+        src.data(), src.pitch(), dst.data(), dst.pitch(), src.width(), src.height(),
+        weights.data(), kernel.width(), kernel.height(), border
+    );
+}
+
+//! \see convolve(thread_pool&, src, dst, kernel, border)
+template <typename T, class AllocSrc, class TrackingSrc, class PaddingSrc, typename U, class AllocDst, class TrackingDst, class PaddingDst, class AllocK, class TrackingK, class PaddingK, class Border>
+void convolve(
+    const grid_vector<T, AllocSrc, TrackingSrc, PaddingSrc>&        src,
+    grid_vector<U, AllocDst, TrackingDst, PaddingDst>&              dst,
+    const grid_vector<float, AllocK, TrackingK, PaddingK>&        kernel,
+    const Border&                                       border)
+{
+    convolve(default_thread_pool(), src, dst, kernel, border);
+}
+
+/**
+\brief Convolves a grid_vector with a separable kernel, i.e. first with 'kernel_x' along each row and then with 'kernel_y' along each column.
+\remarks This is equivalent to convolve with the outer product of both kernels, but only needs kernel_x.size() + kernel_y.size() multiplications per element.
+\throws std::invalid_argument If any kernel is empty or 'src' and 'dst' refer to the same grid.
+\see convolve
+\code
+// Example usage (Gaussian blur):
+const std::vector<float> gauss { 1/16.0f, 4/16.0f, 6/16.0f, 4/16.0f, 1/16.0f };
+ext::convolve_separable(image, blurred, gauss, gauss, ext::clamp_border());
+\endcode
+*/
+template <typename T, class AllocSrc, class TrackingSrc, class PaddingSrc, typename U, class AllocDst, class TrackingDst, class PaddingDst, class Border>
+void convolve_separable(
+    thread_pool&                                        pool,
+    const grid_vector<T, AllocSrc, TrackingSrc, PaddingSrc>&        src,
+    grid_vector<U, AllocDst, TrackingDst, PaddingDst>&              dst,
+    const std::vector<float>&                           kernel_x,
+    const std::vector<float>&                           kernel_y,
+    const Border&                                       border)
+{
+    if (kernel_x.empty() || kernel_y.empty())
+        throw std::invalid_argument("convolve_separable kernels must not be empty");
+    details::check_convolution_grids(src, dst);
+
+    dst.resize(src.width(), src.height());
+    details::convolve_separable(
+        details::cpu_simd_level(), pool,
+        src.data(), src.pitch(), dst.data(), dst.pitch(), src.width(), src.height(),
+        kernel_x.data(), kernel_x.size(), kernel_y.data(), kernel_y.size(), border
+    );
+}
+
+//! \see convolve_separable(thread_pool&, src, dst, kernel_x, kernel_y, border)
+template <typename T, class AllocSrc, class TrackingSrc, class PaddingSrc, typename U, class AllocDst, class TrackingDst, class PaddingDst, class Border>
+void convolve_separable(
+    const grid_vector<T, AllocSrc, TrackingSrc, PaddingSrc>&        src,
+    grid_vector<U, AllocDst, TrackingDst, PaddingDst>&              dst,
+    const std::vector<float>&                           kernel_x,
+    const std::vector<float>&                           kernel_y,
+    const Border&                                       border)
+{
+    convolve_separable(default_thread_pool(), src, dst, kernel_x, kernel_y, border);
+}
+
+
+} // /namespace ext
+
+
+#endif
+
+
+
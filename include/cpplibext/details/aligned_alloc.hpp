@@ -0,0 +1,88 @@
+/*
+ * aligned_alloc.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_ALIGNED_ALLOC_H
+#define CPPLIBEXT_ALIGNED_ALLOC_H
+
+
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#   include <malloc.h>
+#elif defined(__linux__)
+#   include <sys/mman.h>
+#endif
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+// Size of a transparent huge page (2 MiB on x86-64 and most AArch64 kernels).
+static const std::size_t huge_page_size = (std::size_t(1) << 21);
+
+/*
+Allocates 'size' bytes with the specified alignment (must be a power of two and a multiple of sizeof(void*)).
+Throws std::bad_alloc on failure. The memory must be released with 'free_aligned'.
+*/
+inline void* alloc_aligned(std::size_t size, std::size_t alignment)
+{
+    void* ptr = nullptr;
+
+    #if defined(_WIN32)
+    ptr = _aligned_malloc(size, alignment);
+    #else
+    if (posix_memalign(&ptr, alignment, size) != 0)
+        ptr = nullptr;
+    #endif
+
+    if (ptr == nullptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+inline void free_aligned(void* ptr)
+{
+    #if defined(_WIN32)
+    _aligned_free(ptr);
+    #else
+    std::free(ptr);
+    #endif
+}
+
+/*
+Requests transparent huge pages for the specified memory range.
+This is only a hint, which is ignored on platforms other than Linux.
+*/
+inline void advise_huge_pages(void* ptr, std::size_t size)
+{
+    #if defined(__linux__) && defined(MADV_HUGEPAGE)
+    madvise(ptr, size, MADV_HUGEPAGE);
+    #else
+    (void)ptr;
+    (void)size;
+    #endif
+}
+
+
+} // /namespace details
+
+} // /namespace ext
+
+
+#endif
+
+
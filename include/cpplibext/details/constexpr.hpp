@@ -0,0 +1,60 @@
+/*
+ * constexpr.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_CONSTEXPR_H
+#define CPPLIBEXT_CONSTEXPR_H
+
+
+/*
+C++ language version (MSVC only reports the actual version in _MSVC_LANG).
+*/
+#if defined(_MSVC_LANG)
+#   define CPPLIBEXT_CPLUSPLUS _MSVC_LANG
+#else
+#   define CPPLIBEXT_CPLUSPLUS __cplusplus
+#endif
+
+/*
+'constexpr' for functions that require the relaxed rules of C++14 (loops, multiple statements, non-const member functions).
+This is empty for C++11, so these functions can only be evaluated at runtime then.
+*/
+#if CPPLIBEXT_CPLUSPLUS >= 201402L
+#   define CPPLIBEXT_CONSTEXPR14 constexpr
+#else
+#   define CPPLIBEXT_CONSTEXPR14
+#endif
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+// Same as std::fill, but constexpr with C++14 (std::fill is only constexpr since C++20).
+template <typename T>
+CPPLIBEXT_CONSTEXPR14 void constexpr_fill(T* first, T* last, const T& value)
+{
+    for (; first != last; ++first)
+        *first = value;
+}
+
+
+} // /namespace details
+
+} // /namespace ext
+
+
+#endif
+
+
+
@@ -0,0 +1,172 @@
+/*
+ * convolution_kernel.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_CONVOLUTION_KERNEL_H
+#define CPPLIBEXT_CONVOLUTION_KERNEL_H
+
+
+#include "cpu_dispatch.hpp"
+
+#include <cstdlib>
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+/*
+Row kernels of the convolution:
+dst[x] = sum_j sum_i weights[j*taps + i] * rows[j][x + i]   for x in [0, width)
+Each row must have 'width + taps - 1' readable elements. All kernels accumulate the products in the same order (j, then i),
+so they only differ in the rounding of the fused multiply-add of the AVX2 kernel.
+*/
+
+/* ----- Scalar kernel (reference) ----- */
+
+inline float convolve_element(const float* const* rows, std::size_t num_rows, const float* weights, std::size_t taps, std::size_t x)
+{
+    float sum = 0.0f;
+    for (std::size_t j = 0; j < num_rows; ++j)
+    {
+        for (std::size_t i = 0; i < taps; ++i)
+            sum += weights[j*taps + i] * rows[j][x + i];
+    }
+    return sum;
+}
+
+inline void convolve_rows_scalar(const float* const* rows, std::size_t num_rows, const float* weights, std::size_t taps, float* dst, std::size_t width)
+{
+    for (std::size_t x = 0; x < width; ++x)
+        dst[x] = convolve_element(rows, num_rows, weights, taps, x);
+}
+
+#if defined(CPPLIBEXT_X86_64)
+
+/* ----- SSE kernel (16 elements per iteration) ----- */
+
+inline void convolve_rows_sse(const float* const* rows, std::size_t num_rows, const float* weights, std::size_t taps, float* dst, std::size_t width)
+{
+    std::size_t x = 0;
+
+    for (; x + 16 <= width; x += 16)
+    {
+        __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps(), acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+        for (std::size_t j = 0; j < num_rows; ++j)
+        {
+            for (std::size_t i = 0; i < taps; ++i)
+            {
+                const __m128 w = _mm_set1_ps(weights[j*taps + i]);
+                const float* src = rows[j] + x + i;
+                acc0 = _mm_add_ps(acc0, _mm_mul_ps(w, _mm_loadu_ps(src)));
+                acc1 = _mm_add_ps(acc1, _mm_mul_ps(w, _mm_loadu_ps(src + 4)));
+                acc2 = _mm_add_ps(acc2, _mm_mul_ps(w, _mm_loadu_ps(src + 8)));
+                acc3 = _mm_add_ps(acc3, _mm_mul_ps(w, _mm_loadu_ps(src + 12)));
+            }
+        }
+        _mm_storeu_ps(dst + x, acc0);
+        _mm_storeu_ps(dst + x + 4, acc1);
+        _mm_storeu_ps(dst + x + 8, acc2);
+        _mm_storeu_ps(dst + x + 12, acc3);
+    }
+
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128 acc = _mm_setzero_ps();
+        for (std::size_t j = 0; j < num_rows; ++j)
+        {
+            for (std::size_t i = 0; i < taps; ++i)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(weights[j*taps + i]), _mm_loadu_ps(rows[j] + x + i)));
+        }
+        _mm_storeu_ps(dst + x, acc);
+    }
+
+    for (; x < width; ++x)
+        dst[x] = convolve_element(rows, num_rows, weights, taps, x);
+}
+
+/* ----- AVX2 kernel (32 elements per iteration with FMA) ----- */
+
+CPPLIBEXT_TARGET_AVX2
+inline void convolve_rows_avx2(const float* const* rows, std::size_t num_rows, const float* weights, std::size_t taps, float* dst, std::size_t width)
+{
+    std::size_t x = 0;
+
+    for (; x + 32 <= width; x += 32)
+    {
+        __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps(), acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+        for (std::size_t j = 0; j < num_rows; ++j)
+        {
+            for (std::size_t i = 0; i < taps; ++i)
+            {
+                const __m256 w = _mm256_broadcast_ss(weights + j*taps + i);
+                const float* src = rows[j] + x + i;
+                acc0 = _mm256_fmadd_ps(w, _mm256_loadu_ps(src), acc0);
+                acc1 = _mm256_fmadd_ps(w, _mm256_loadu_ps(src + 8), acc1);
+                acc2 = _mm256_fmadd_ps(w, _mm256_loadu_ps(src + 16), acc2);
+                acc3 = _mm256_fmadd_ps(w, _mm256_loadu_ps(src + 24), acc3);
+            }
+        }
+        _mm256_storeu_ps(dst + x, acc0);
+        _mm256_storeu_ps(dst + x + 8, acc1);
+        _mm256_storeu_ps(dst + x + 16, acc2);
+        _mm256_storeu_ps(dst + x + 24, acc3);
+    }
+
+    for (; x + 8 <= width; x += 8)
+    {
+        __m256 acc = _mm256_setzero_ps();
+        for (std::size_t j = 0; j < num_rows; ++j)
+        {
+            for (std::size_t i = 0; i < taps; ++i)
+                acc = _mm256_fmadd_ps(_mm256_broadcast_ss(weights + j*taps + i), _mm256_loadu_ps(rows[j] + x + i), acc);
+        }
+        _mm256_storeu_ps(dst + x, acc);
+    }
+
+    for (; x < width; ++x)
+        dst[x] = convolve_element(rows, num_rows, weights, taps, x);
+}
+
+#endif // /CPPLIBEXT_X86_64
+
+/* ----- Dispatch ----- */
+
+inline void convolve_rows(simd_level level, const float* const* rows, std::size_t num_rows, const float* weights, std::size_t taps, float* dst, std::size_t width)
+{
+    switch (level)
+    {
+        #if defined(CPPLIBEXT_X86_64)
+        case simd_level::avx2:
+            convolve_rows_avx2(rows, num_rows, weights, taps, dst, width);
+            break;
+        case simd_level::sse:
+            convolve_rows_sse(rows, num_rows, weights, taps, dst, width);
+            break;
+        #endif
+        default:
+            convolve_rows_scalar(rows, num_rows, weights, taps, dst, width);
+            break;
+    }
+}
+
+
+} // /namespace details
+
+} // /namespace ext
+
+
+#endif
+
+
+
@@ -0,0 +1,99 @@
+/*
+ * cpu_dispatch.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_CPU_DISPATCH_H
+#define CPPLIBEXT_CPU_DISPATCH_H
+
+
+#if defined(__x86_64__) || defined(_M_X64)
+#   define CPPLIBEXT_X86_64
+#   include <immintrin.h>
+#   if defined(_MSC_VER)
+#       include <intrin.h>
+#   endif
+#endif
+
+/*
+Enables AVX2 and FMA instructions for a single function, so the rest of the code does not require these instructions.
+Such functions must only be called after cpu_simd_level() returned simd_level::avx2.
+MSVC does not need any attribute to use these intrinsics.
+*/
+#if defined(CPPLIBEXT_X86_64) && (defined(__GNUC__) || defined(__clang__))
+#   define CPPLIBEXT_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#   define CPPLIBEXT_TARGET_AVX2
+#endif
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+// SIMD instruction sets for the runtime dispatch (SSE2 is always available on x86-64).
+enum class simd_level
+{
+    scalar,
+    sse,
+    avx2,
+};
+
+inline simd_level detect_simd_level()
+{
+    #if defined(CPPLIBEXT_X86_64)
+
+    #if defined(_MSC_VER)
+
+    int info[4] = { 0 };
+    __cpuid(info, 1);
+    const bool fma      = ((info[2] & (1 << 12)) != 0);
+    const bool osxsave  = ((info[2] & (1 << 27)) != 0);
+    __cpuidex(info, 7, 0);
+    const bool avx2     = ((info[1] & (1 << 5)) != 0);
+    if (fma && osxsave && avx2 && (_xgetbv(0) & 0x6) == 0x6)
+        return simd_level::avx2;
+
+    #else
+
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return simd_level::avx2;
+
+    #endif
+
+    return simd_level::sse;
+
+    #else
+
+    return simd_level::scalar;
+
+    #endif
+}
+
+// Returns the best SIMD instruction set of the CPU. This is only detected once.
+inline simd_level cpu_simd_level()
+{
+    static const simd_level level = detect_simd_level();
+    return level;
+}
+
+
+} // /namespace details
+
+} // /namespace ext
+
+
+#endif
+
+
+
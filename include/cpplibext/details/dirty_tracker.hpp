@@ -0,0 +1,453 @@
+/*
+ * dirty_tracker.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_DIRTY_TRACKER_H
+#define CPPLIBEXT_DIRTY_TRACKER_H
+
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+
+//! Rectangular region of a 2-dimensional grid.
+struct grid_region
+{
+    std::size_t x;
+    std::size_t y;
+    std::size_t width;
+    std::size_t height;
+};
+
+//! Dirty tracking modes of grid_vector.
+enum class dirty_tracking
+{
+    none,       //!< Writes are not tracked.
+    rectangles, //!< Written cells are coalesced into a small number of rectangles.
+    tiles,      //!< Written cells are recorded in a bitmap with one bit per tile.
+};
+
+//! Tracking policy of grid_vector which does not track any writes (default). Writes have no overhead.
+struct untracked {};
+
+//! Tracking policy of grid_vector which can track the writes at runtime. \see grid_vector::enable_dirty_tracking
+struct dirty_tracked {};
+
+
+// This namespace is only used internally
+namespace details
+{
+
+
+/*
+Records the written cells of a grid with the specified size, either as coalesced rectangles or as a per-tile dirty bitmap.
+In rectangle mode, a cell that touches the most recent rectangle extends that rectangle, so row-wise writes produce a single region.
+The number of rectangles is limited to 'max_rects'; beyond that, the two rectangles whose union adds the smallest area are merged.
+*/
+class dirty_tracker
+{
+
+    public:
+
+        enum : std::size_t { max_rects = 32 };
+
+        dirty_tracker(dirty_tracking mode, std::size_t width, std::size_t height, std::size_t tile_width, std::size_t tile_height) :
+            mode_        { mode                                           },
+            width_       { width                                          },
+            height_      { height                                         },
+            tile_width_  { std::max<std::size_t>(1, tile_width)           },
+            tile_height_ { std::max<std::size_t>(1, tile_height)          },
+            tiles_x_     { (width + tile_width_ - 1) / tile_width_        }
+        {
+            if (mode_ == dirty_tracking::tiles)
+                tiles_.resize(tiles_x_ * ((height + tile_height_ - 1) / tile_height_), 0);
+        }
+
+        dirty_tracking mode() const
+        {
+            return mode_;
+        }
+
+        std::size_t tile_width() const
+        {
+            return tile_width_;
+        }
+
+        std::size_t tile_height() const
+        {
+            return tile_height_;
+        }
+
+        // Marks the cell (x, y) as dirty.
+        void mark(std::size_t x, std::size_t y)
+        {
+            if (mode_ == dirty_tracking::tiles)
+                tiles_[(y / tile_height_) * tiles_x_ + x / tile_width_] = 1;
+            else if (!extend_last(x, y))
+                add_rect({ x, y, 1, 1 });
+        }
+
+        // Marks the region as dirty, which is clipped to the grid.
+        void mark(const grid_region& region)
+        {
+            const auto x1 = std::min(region.x + region.width, width_);
+            const auto y1 = std::min(region.y + region.height, height_);
+            if (region.x >= x1 || region.y >= y1)
+                return;
+
+            if (mode_ == dirty_tracking::tiles)
+            {
+                for (auto ty = region.y / tile_height_; ty <= (y1 - 1) / tile_height_; ++ty)
+                {
+                    auto row = tiles_.begin() + ty * tiles_x_;
+                    std::fill(row + region.x / tile_width_, row + (x1 - 1) / tile_width_ + 1, 1);
+                }
+            }
+            else
+                add_rect({ region.x, region.y, x1 - region.x, y1 - region.y });
+        }
+
+        bool empty() const
+        {
+            if (mode_ == dirty_tracking::tiles)
+                return (std::find(tiles_.begin(), tiles_.end(), 1) == tiles_.end());
+            return rects_.empty();
+        }
+
+        void clear()
+        {
+            std::fill(tiles_.begin(), tiles_.end(), 0);
+            rects_.clear();
+        }
+
+        // Returns the dirty regions, which do not overlap each other. In tile mode, the regions are aligned to the tiles (but clipped to the grid).
+        std::vector<grid_region> regions() const
+        {
+            return (mode_ == dirty_tracking::tiles ? tile_regions() : rect_regions());
+        }
+
+    private:
+
+        static std::size_t area(const grid_region& r)
+        {
+            return r.width * r.height;
+        }
+
+        static grid_region unite(const grid_region& a, const grid_region& b)
+        {
+            const auto x0 = std::min(a.x, b.x);
+            const auto y0 = std::min(a.y, b.y);
+            const auto x1 = std::max(a.x + a.width, b.x + b.width);
+            const auto y1 = std::max(a.y + a.height, b.y + b.height);
+            return { x0, y0, x1 - x0, y1 - y0 };
+        }
+
+        static bool overlap(const grid_region& a, const grid_region& b)
+        {
+            return (a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height);
+        }
+
+        // Returns true if the union of both rectangles does not contain any additional cells, i.e. they share a complete edge.
+        static bool is_exact_union(const grid_region& a, const grid_region& b)
+        {
+            return (area(unite(a, b)) == area(a) + area(b) && !overlap(a, b));
+        }
+
+        // Extends the most recent rectangle by the cell (x, y) if the cell is inside or right next to it without adding any clean cells.
+        bool extend_last(std::size_t x, std::size_t y)
+        {
+            if (rects_.empty())
+                return false;
+
+            auto& r = rects_.back();
+            const bool inside_x = (x >= r.x && x < r.x + r.width);
+            const bool inside_y = (y >= r.y && y < r.y + r.height);
+
+            if (inside_x && inside_y)
+                return true;
+
+            if ( ( inside_y && r.height == 1 && (x + 1 == r.x || x == r.x + r.width ) ) ||
+                 ( inside_x && r.width  == 1 && (y + 1 == r.y || y == r.y + r.height) ) )
+            {
+                r = unite(r, { x, y, 1, 1 });
+                coalesce_last();
+                return true;
+            }
+
+            return false;
+        }
+
+        // Merges the two most recent rectangles if they form a rectangle, e.g. two consecutive rows that were written completely.
+        void coalesce_last()
+        {
+            const auto n = rects_.size();
+            if (n >= 2 && is_exact_union(rects_[n - 2], rects_[n - 1]))
+            {
+                rects_[n - 2] = unite(rects_[n - 2], rects_[n - 1]);
+                rects_.pop_back();
+            }
+        }
+
+        void add_rect(const grid_region& region)
+        {
+            for (std::size_t i = 0; i < rects_.size(); ++i)
+            {
+                const auto& r = rects_[i];
+                if (region.x >= r.x && region.y >= r.y && region.x + region.width <= r.x + r.width && region.y + region.height <= r.y + r.height)
+                {
+                    /* Move the enclosing rectangle to the back, so subsequent writes find it first */
+                    std::swap(rects_[i], rects_.back());
+                    return;
+                }
+            }
+
+            rects_.push_back(region);
+            coalesce_last();
+
+            if (rects_.size() > max_rects)
+                merge_closest();
+        }
+
+        // Merges the two rectangles whose union adds the smallest number of clean cells.
+        void merge_closest()
+        {
+            std::size_t best_i = 0, best_j = 1;
+            long long best_cost = 0;
+            for (std::size_t i = 0; i < rects_.size(); ++i)
+            {
+                for (std::size_t j = i + 1; j < rects_.size(); ++j)
+                {
+                    const auto cost =
+                    (
+                        static_cast<long long>(area(unite(rects_[i], rects_[j]))) -
+                        static_cast<long long>(area(rects_[i])) -
+                        static_cast<long long>(area(rects_[j]))
+                    );
+                    if (j == 1 || cost < best_cost)
+                    {
+                        best_cost = cost;
+                        best_i = i;
+                        best_j = j;
+                    }
+                }
+            }
+            rects_[best_i] = unite(rects_[best_i], rects_[best_j]);
+            rects_.erase(rects_.begin() + best_j);
+        }
+
+        // Merges overlapping rectangles until none of them overlap.
+        std::vector<grid_region> rect_regions() const
+        {
+            auto regions = rects_;
+            for (bool merged = true; merged;)
+            {
+                merged = false;
+                for (std::size_t i = 0; i < regions.size() && !merged; ++i)
+                {
+                    for (std::size_t j = i + 1; j < regions.size() && !merged; ++j)
+                    {
+                        if (overlap(regions[i], regions[j]))
+                        {
+                            regions[i] = unite(regions[i], regions[j]);
+                            regions.erase(regions.begin() + j);
+                            merged = true;
+                        }
+                    }
+                }
+            }
+            return regions;
+        }
+
+        // Returns runs of dirty tiles per tile row, where equal runs of consecutive tile rows are combined.
+        std::vector<grid_region> tile_regions() const
+        {
+            std::vector<grid_region> regions;
+            std::vector<std::size_t> open, next_open; // Indices of the regions that end at the current tile row
+
+            for (std::size_t ty = 0, y = 0; y < height_; ++ty, y += tile_height_)
+            {
+                const auto h = std::min(tile_height_, height_ - y);
+                const auto row = tiles_.begin() + ty * tiles_x_;
+
+                next_open.clear();
+                for (std::size_t tx = 0; tx < tiles_x_;)
+                {
+                    if (!row[tx])
+                    {
+                        ++tx;
+                        continue;
+                    }
+
+                    auto end = tx;
+                    while (end < tiles_x_ && row[end])
+                        ++end;
+
+                    const auto x = tx * tile_width_;
+                    const auto w = std::min(end * tile_width_, width_) - x;
+
+                    /* Extend the equal run of the previous tile row, or add a new region */
+                    auto prev = std::find_if(open.begin(), open.end(), [&](std::size_t i) { return (regions[i].x == x && regions[i].width == w); });
+                    if (prev != open.end())
+                    {
+                        regions[*prev].height += h;
+                        next_open.push_back(*prev);
+                    }
+                    else
+                    {
+                        next_open.push_back(regions.size());
+                        regions.push_back({ x, y, w, h });
+                    }
+
+                    tx = end;
+                }
+
+                open.swap(next_open);
+            }
+
+            return regions;
+        }
+
+    private:
+
+        dirty_tracking              mode_;
+        std::size_t                 width_;
+        std::size_t                 height_;
+        std::size_t                 tile_width_;
+        std::size_t                 tile_height_;
+        std::size_t                 tiles_x_;
+        std::vector<std::uint8_t>   tiles_;
+        std::vector<grid_region>    rects_;
+
+};
+
+
+template <class Tracking>
+class grid_tracker;
+
+// Tracker for the 'untracked' policy, where all functions are no-ops.
+template <>
+class grid_tracker<untracked>
+{
+
+    public:
+
+        void mark(std::size_t, std::size_t)
+        {
+        }
+
+        void mark(const grid_region&)
+        {
+        }
+
+        void resize(std::size_t, std::size_t)
+        {
+        }
+
+        dirty_tracking mode() const
+        {
+            return dirty_tracking::none;
+        }
+
+        bool empty() const
+        {
+            return true;
+        }
+
+        std::vector<grid_region> regions() const
+        {
+            return {};
+        }
+
+        void clear()
+        {
+        }
+
+};
+
+// Tracker for the 'dirty_tracked' policy. While tracking is disabled, each mark is a null pointer check, which is still a branch per element for single writes.
+template <>
+class grid_tracker<dirty_tracked>
+{
+
+    public:
+
+        void enable(dirty_tracking mode, std::size_t width, std::size_t height, std::size_t tile_width, std::size_t tile_height)
+        {
+            if (mode == dirty_tracking::none)
+                tracker_.reset();
+            else
+                tracker_.reset(new dirty_tracker(mode, width, height, tile_width, tile_height));
+        }
+
+        void mark(std::size_t x, std::size_t y)
+        {
+            if (tracker_)
+                tracker_->mark(x, y);
+        }
+
+        void mark(const grid_region& region)
+        {
+            if (tracker_)
+                tracker_->mark(region);
+        }
+
+        // Resets the tracker to the new grid size and marks all elements as dirty.
+        void resize(std::size_t width, std::size_t height)
+        {
+            if (tracker_)
+            {
+                enable(tracker_->mode(), width, height, tracker_->tile_width(), tracker_->tile_height());
+                tracker_->mark({ 0, 0, width, height });
+            }
+        }
+
+        dirty_tracking mode() const
+        {
+            return (tracker_ ? tracker_->mode() : dirty_tracking::none);
+        }
+
+        bool empty() const
+        {
+            return (!tracker_ || tracker_->empty());
+        }
+
+        std::vector<grid_region> regions() const
+        {
+            return (tracker_ ? tracker_->regions() : std::vector<grid_region>());
+        }
+
+        void clear()
+        {
+            if (tracker_)
+                tracker_->clear();
+        }
+
+    private:
+
+        std::unique_ptr<dirty_tracker> tracker_;
+
+};
+
+
+} // /namespace details
+
+} // /namespace ext
+
+
+#endif
+
+
+
@@ -0,0 +1,75 @@
+/*
+ * flat_index.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_FLAT_INDEX_H
+#define CPPLIBEXT_FLAT_INDEX_H
+
+
+#include <cstdlib>
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+/*
+meta template to compute the storage offset of N indices for the dimensions D1, D2, ..., DN with the specified layout mapping
+(computes Mapping::offset<0>(I1) + Mapping::offset<1>(I2) + ... + Mapping::offset<N-1>(IN)).
+For the row-major layout this is I1 * (D2 * ... * DN) + I2 * (D3 * ... * DN) + ... + IN:
+flat_index<row_major_layout::mapping<3, 4, 2>, 0, 3, 4, 2>::compute(2, 1, 1) == 2*8 + 1*2 + 1 = 19;
+*/
+
+template <class Mapping, std::size_t Dim, std::size_t... DN>
+struct flat_index;
+
+template <class Mapping, std::size_t Dim, std::size_t D1, std::size_t... DN>
+struct flat_index<Mapping, Dim, D1, DN...>
+{
+    template <typename I1, typename... IN>
+    static constexpr std::size_t compute(I1 i1, IN... in)
+    {
+        return (Mapping::template offset<Dim>(static_cast<std::size_t>(i1)) + flat_index<Mapping, (Dim + 1), DN...>::compute(in...));
+    }
+
+    // Returns true if all indices are inside their dimensions.
+    template <typename I1, typename... IN>
+    static constexpr bool in_range(I1 i1, IN... in)
+    {
+        return (static_cast<std::size_t>(i1) < D1 && flat_index<Mapping, (Dim + 1), DN...>::in_range(in...));
+    }
+};
+
+template <class Mapping, std::size_t Dim>
+struct flat_index<Mapping, Dim>
+{
+    static constexpr std::size_t compute()
+    {
+        return 0;
+    }
+
+    static constexpr bool in_range()
+    {
+        return true;
+    }
+};
+
+
+} // /namespace details
+
+} // /namespace ext
+
+
+#endif
+
+
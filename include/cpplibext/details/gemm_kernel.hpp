@@ -0,0 +1,327 @@
+/*
+ * gemm_kernel.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_GEMM_KERNEL_H
+#define CPPLIBEXT_GEMM_KERNEL_H
+
+
+#include "cpu_dispatch.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+/*
+Matrix kernels for row-major matrices with leading dimensions (i.e. the number of elements from one row to the next):
+gemm:   C[m][n] = A[m][k] * B[k][n]
+gemv:   y[m]    = A[m][n] * x[n]
+*/
+
+// Block sizes along k and n, so one block of B (gemm_block_k * gemm_block_n floats = 128 KiB) stays in the L2 cache.
+static const std::size_t gemm_block_k = 128;
+static const std::size_t gemm_block_n = 256;
+
+/* ----- Scalar kernels ----- */
+
+template <typename T>
+void gemm_scalar(std::size_t m, std::size_t n, std::size_t k, const T* a, std::size_t lda, const T* b, std::size_t ldb, T* c, std::size_t ldc)
+{
+    for (std::size_t i = 0; i < m; ++i)
+        std::fill(c + i*ldc, c + i*ldc + n, T(0));
+
+    for (std::size_t k0 = 0; k0 < k; k0 += gemm_block_k)
+    {
+        const std::size_t k1 = std::min(k0 + gemm_block_k, k);
+        for (std::size_t j0 = 0; j0 < n; j0 += gemm_block_n)
+        {
+            const std::size_t j1 = std::min(j0 + gemm_block_n, n);
+            for (std::size_t i = 0; i < m; ++i)
+            {
+                T* c_row = c + i*ldc;
+                for (std::size_t p = k0; p < k1; ++p)
+                {
+                    const T a_ip = a[i*lda + p];
+                    const T* b_row = b + p*ldb;
+                    for (std::size_t j = j0; j < j1; ++j)
+                        c_row[j] += a_ip * b_row[j];
+                }
+            }
+        }
+    }
+}
+
+template <typename T>
+void gemv_scalar(std::size_t m, std::size_t n, const T* a, std::size_t lda, const T* x, T* y)
+{
+    for (std::size_t i = 0; i < m; ++i)
+    {
+        const T* a_row = a + i*lda;
+        T sum = T(0);
+        for (std::size_t j = 0; j < n; ++j)
+            sum += a_row[j] * x[j];
+        y[i] = sum;
+    }
+}
+
+// Adds the product of rows [i, i+rows) of A and columns [j0, j1) of B over [k0, k1) to C (edges of the SIMD kernels).
+inline void gemm_edge_f32(
+    std::size_t i, std::size_t rows, std::size_t j0, std::size_t j1, std::size_t k0, std::size_t k1,
+    const float* a, std::size_t lda, const float* b, std::size_t ldb, float* c, std::size_t ldc)
+{
+    for (std::size_t r = i; r < i + rows; ++r)
+    {
+        for (std::size_t j = j0; j < j1; ++j)
+        {
+            float sum = c[r*ldc + j];
+            for (std::size_t p = k0; p < k1; ++p)
+                sum += a[r*lda + p] * b[p*ldb + j];
+            c[r*ldc + j] = sum;
+        }
+    }
+}
+
+#if defined(CPPLIBEXT_X86_64)
+
+/* ----- SSE kernels (4 x 8 register tiles) ----- */
+
+template <std::size_t Rows>
+void gemm_tile_sse(std::size_t k0, std::size_t k1, const float* a, std::size_t lda, const float* b, std::size_t ldb, float* c, std::size_t ldc)
+{
+    __m128 acc[Rows][2];
+
+    for (std::size_t r = 0; r < Rows; ++r)
+    {
+        acc[r][0] = _mm_loadu_ps(c + r*ldc);
+        acc[r][1] = _mm_loadu_ps(c + r*ldc + 4);
+    }
+
+    for (std::size_t p = k0; p < k1; ++p)
+    {
+        const __m128 b0 = _mm_loadu_ps(b + p*ldb);
+        const __m128 b1 = _mm_loadu_ps(b + p*ldb + 4);
+        for (std::size_t r = 0; r < Rows; ++r)
+        {
+            const __m128 a_rp = _mm_set1_ps(a[r*lda + p]);
+            acc[r][0] = _mm_add_ps(acc[r][0], _mm_mul_ps(a_rp, b0));
+            acc[r][1] = _mm_add_ps(acc[r][1], _mm_mul_ps(a_rp, b1));
+        }
+    }
+
+    for (std::size_t r = 0; r < Rows; ++r)
+    {
+        _mm_storeu_ps(c + r*ldc, acc[r][0]);
+        _mm_storeu_ps(c + r*ldc + 4, acc[r][1]);
+    }
+}
+
+inline void gemm_sse(std::size_t m, std::size_t n, std::size_t k, const float* a, std::size_t lda, const float* b, std::size_t ldb, float* c, std::size_t ldc)
+{
+    for (std::size_t i = 0; i < m; ++i)
+        std::fill(c + i*ldc, c + i*ldc + n, 0.0f);
+
+    for (std::size_t k0 = 0; k0 < k; k0 += gemm_block_k)
+    {
+        const std::size_t k1 = std::min(k0 + gemm_block_k, k);
+        for (std::size_t j0 = 0; j0 < n; j0 += gemm_block_n)
+        {
+            const std::size_t j1 = std::min(j0 + gemm_block_n, n);
+            const std::size_t j_tiles = j0 + (j1 - j0) / 8 * 8;
+
+            const std::size_t m4 = m - m % 4;
+            for (std::size_t i = 0; i < m4; i += 4)
+            {
+                for (std::size_t j = j0; j < j_tiles; j += 8)
+                    gemm_tile_sse<4>(k0, k1, a + i*lda, lda, b + j, ldb, c + i*ldc + j, ldc);
+                gemm_edge_f32(i, 4, j_tiles, j1, k0, k1, a, lda, b, ldb, c, ldc);
+            }
+            for (std::size_t i = m4; i < m; ++i)
+            {
+                for (std::size_t j = j0; j < j_tiles; j += 8)
+                    gemm_tile_sse<1>(k0, k1, a + i*lda, lda, b + j, ldb, c + i*ldc + j, ldc);
+                gemm_edge_f32(i, 1, j_tiles, j1, k0, k1, a, lda, b, ldb, c, ldc);
+            }
+        }
+    }
+}
+
+inline void gemv_sse(std::size_t m, std::size_t n, const float* a, std::size_t lda, const float* x, float* y)
+{
+    const std::size_t n4 = n / 4 * 4;
+    for (std::size_t i = 0; i < m; ++i)
+    {
+        const float* a_row = a + i*lda;
+        __m128 acc = _mm_setzero_ps();
+        for (std::size_t j = 0; j < n4; j += 4)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a_row + j), _mm_loadu_ps(x + j)));
+
+        float lanes[4];
+        _mm_storeu_ps(lanes, acc);
+        float sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        for (std::size_t j = n4; j < n; ++j)
+            sum += a_row[j] * x[j];
+        y[i] = sum;
+    }
+}
+
+/* ----- AVX2 kernels (6 x 16 register tiles with FMA) ----- */
+
+template <std::size_t Rows>
+CPPLIBEXT_TARGET_AVX2
+void gemm_tile_avx2(std::size_t k0, std::size_t k1, const float* a, std::size_t lda, const float* b, std::size_t ldb, float* c, std::size_t ldc)
+{
+    __m256 acc[Rows][2];
+
+    for (std::size_t r = 0; r < Rows; ++r)
+    {
+        acc[r][0] = _mm256_loadu_ps(c + r*ldc);
+        acc[r][1] = _mm256_loadu_ps(c + r*ldc + 8);
+    }
+
+    for (std::size_t p = k0; p < k1; ++p)
+    {
+        const __m256 b0 = _mm256_loadu_ps(b + p*ldb);
+        const __m256 b1 = _mm256_loadu_ps(b + p*ldb + 8);
+        for (std::size_t r = 0; r < Rows; ++r)
+        {
+            const __m256 a_rp = _mm256_broadcast_ss(a + r*lda + p);
+            acc[r][0] = _mm256_fmadd_ps(a_rp, b0, acc[r][0]);
+            acc[r][1] = _mm256_fmadd_ps(a_rp, b1, acc[r][1]);
+        }
+    }
+
+    for (std::size_t r = 0; r < Rows; ++r)
+    {
+        _mm256_storeu_ps(c + r*ldc, acc[r][0]);
+        _mm256_storeu_ps(c + r*ldc + 8, acc[r][1]);
+    }
+}
+
+CPPLIBEXT_TARGET_AVX2
+inline void gemm_avx2(std::size_t m, std::size_t n, std::size_t k, const float* a, std::size_t lda, const float* b, std::size_t ldb, float* c, std::size_t ldc)
+{
+    for (std::size_t i = 0; i < m; ++i)
+        std::fill(c + i*ldc, c + i*ldc + n, 0.0f);
+
+    for (std::size_t k0 = 0; k0 < k; k0 += gemm_block_k)
+    {
+        const std::size_t k1 = std::min(k0 + gemm_block_k, k);
+        for (std::size_t j0 = 0; j0 < n; j0 += gemm_block_n)
+        {
+            const std::size_t j1 = std::min(j0 + gemm_block_n, n);
+            const std::size_t j_tiles = j0 + (j1 - j0) / 16 * 16;
+
+            const std::size_t m6 = m - m % 6;
+            for (std::size_t i = 0; i < m6; i += 6)
+            {
+                for (std::size_t j = j0; j < j_tiles; j += 16)
+                    gemm_tile_avx2<6>(k0, k1, a + i*lda, lda, b + j, ldb, c + i*ldc + j, ldc);
+                gemm_edge_f32(i, 6, j_tiles, j1, k0, k1, a, lda, b, ldb, c, ldc);
+            }
+            for (std::size_t i = m6; i < m; ++i)
+            {
+                for (std::size_t j = j0; j < j_tiles; j += 16)
+                    gemm_tile_avx2<1>(k0, k1, a + i*lda, lda, b + j, ldb, c + i*ldc + j, ldc);
+                gemm_edge_f32(i, 1, j_tiles, j1, k0, k1, a, lda, b, ldb, c, ldc);
+            }
+        }
+    }
+}
+
+CPPLIBEXT_TARGET_AVX2
+inline void gemv_avx2(std::size_t m, std::size_t n, const float* a, std::size_t lda, const float* x, float* y)
+{
+    const std::size_t n8 = n / 8 * 8;
+    for (std::size_t i = 0; i < m; ++i)
+    {
+        const float* a_row = a + i*lda;
+        __m256 acc = _mm256_setzero_ps();
+        for (std::size_t j = 0; j < n8; j += 8)
+            acc = _mm256_fmadd_ps(_mm256_loadu_ps(a_row + j), _mm256_loadu_ps(x + j), acc);
+
+        const __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        float lanes[4];
+        _mm_storeu_ps(lanes, half);
+        float sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        for (std::size_t j = n8; j < n; ++j)
+            sum += a_row[j] * x[j];
+        y[i] = sum;
+    }
+}
+
+#endif // /CPPLIBEXT_X86_64
+
+/* ----- Dispatch ----- */
+
+template <typename T>
+void gemm(simd_level, std::size_t m, std::size_t n, std::size_t k, const T* a, std::size_t lda, const T* b, std::size_t ldb, T* c, std::size_t ldc)
+{
+    gemm_scalar(m, n, k, a, lda, b, ldb, c, ldc);
+}
+
+inline void gemm(simd_level level, std::size_t m, std::size_t n, std::size_t k, const float* a, std::size_t lda, const float* b, std::size_t ldb, float* c, std::size_t ldc)
+{
+    switch (level)
+    {
+        #if defined(CPPLIBEXT_X86_64)
+        case simd_level::avx2:
+            gemm_avx2(m, n, k, a, lda, b, ldb, c, ldc);
+            break;
+        case simd_level::sse:
+            gemm_sse(m, n, k, a, lda, b, ldb, c, ldc);
+            break;
+        #endif
+        default:
+            gemm_scalar(m, n, k, a, lda, b, ldb, c, ldc);
+            break;
+    }
+}
+
+template <typename T>
+void gemv(simd_level, std::size_t m, std::size_t n, const T* a, std::size_t lda, const T* x, T* y)
+{
+    gemv_scalar(m, n, a, lda, x, y);
+}
+
+inline void gemv(simd_level level, std::size_t m, std::size_t n, const float* a, std::size_t lda, const float* x, float* y)
+{
+    switch (level)
+    {
+        #if defined(CPPLIBEXT_X86_64)
+        case simd_level::avx2:
+            gemv_avx2(m, n, a, lda, x, y);
+            break;
+        case simd_level::sse:
+            gemv_sse(m, n, a, lda, x, y);
+            break;
+        #endif
+        default:
+            gemv_scalar(m, n, a, lda, x, y);
+            break;
+    }
+}
+
+
+} // /namespace details
+
+} // /namespace ext
+
+
+#endif
+
+
+
@@ -0,0 +1,343 @@
+/*
+ * grid_views.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_GRID_VIEWS_H
+#define CPPLIBEXT_GRID_VIEWS_H
+
+
+#include "strided_iterator.hpp"
+
+#include <iterator>
+#include <type_traits>
+#include <cstddef>
+
+
+namespace ext
+{
+
+
+/**
+\brief View of the contiguous elements of a single grid_vector row.
+\remarks The view converts implicitly to a pointer to the first element, so it can be used in place of a raw row pointer.
+\see grid_vector::row
+*/
+template <typename T>
+class grid_row
+{
+
+    public:
+
+        using value_type        = typename std::remove_const<T>::type;
+        using size_type         = std::size_t;
+        using pointer           = T*;
+        using reference         = T&;
+        using iterator          = T*;
+
+        grid_row() = default;
+
+        grid_row(T* data, size_type size) :
+            data_ { data },
+            size_ { size }
+        {
+        }
+
+        // Allows conversion from a mutable row to a constant row.
+        template <typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+        grid_row(const grid_row<U>& rhs) :
+            data_ { rhs.data() },
+            size_ { rhs.size() }
+        {
+        }
+
+        operator T* () const
+        {
+            return data_;
+        }
+
+        reference operator [] (size_type x) const
+        {
+            return data_[x];
+        }
+
+        T* data() const
+        {
+            return data_;
+        }
+
+        size_type size() const
+        {
+            return size_;
+        }
+
+        bool empty() const
+        {
+            return (size_ == 0);
+        }
+
+        iterator begin() const
+        {
+            return data_;
+        }
+
+        iterator end() const
+        {
+            return data_ + size_;
+        }
+
+    private:
+
+        T*          data_ = nullptr;
+        size_type   size_ = 0;
+
+};
+
+/**
+\brief View of the elements of a single grid_vector column, which are one pitch apart.
+\see grid_vector::column
+*/
+template <typename T>
+class grid_column
+{
+
+    public:
+
+        using value_type        = typename std::remove_const<T>::type;
+        using size_type         = std::size_t;
+        using reference         = T&;
+        using iterator          = details::strided_iterator<T>;
+
+        grid_column() = default;
+
+        grid_column(T* data, size_type size, size_type stride) :
+            data_   { data   },
+            size_   { size   },
+            stride_ { stride }
+        {
+        }
+
+        // Allows conversion from a mutable column to a constant column.
+        template <typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+        grid_column(const grid_column<U>& rhs) :
+            data_   { rhs.data()   },
+            size_   { rhs.size()   },
+            stride_ { rhs.stride() }
+        {
+        }
+
+        reference operator [] (size_type y) const
+        {
+            return data_[y * stride_];
+        }
+
+        //! Returns a pointer to the first element of the column.
+        T* data() const
+        {
+            return data_;
+        }
+
+        size_type size() const
+        {
+            return size_;
+        }
+
+        //! Returns the number of elements from one element of the column to the next.
+        size_type stride() const
+        {
+            return stride_;
+        }
+
+        bool empty() const
+        {
+            return (size_ == 0);
+        }
+
+        iterator begin() const
+        {
+            return iterator(data_, 0, stride_);
+        }
+
+        iterator end() const
+        {
+            return iterator(data_, size_, stride_);
+        }
+
+    private:
+
+        T*          data_   = nullptr;
+        size_type   size_   = 0;
+        size_type   stride_ = 0;
+
+};
+
+/**
+\brief Range of consecutive grid_vector rows [first, last), which can be split into blocks of rows, e.g. one per thread.
+\remarks Dereferencing the iterators returns a grid_row by value. The iterators also provide the y coordinate of their row.
+\code
+// Example usage:
+auto rows = grid.rows();
+pool.run(num_chunks, [&](std::size_t chunk)
+{
+    auto block = rows.split(chunk, num_chunks);
+    for (auto it = block.begin(); it != block.end(); ++it)
+        process(it.y(), *it);
+});
+\endcode
+\see grid_vector::rows, parallel_for_each_row
+*/
+template <typename T>
+class grid_rows
+{
+
+    public:
+
+        using size_type = std::size_t;
+
+        class iterator
+        {
+
+            public:
+
+                using iterator_category = std::input_iterator_tag;
+                using value_type        = grid_row<T>;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = void;
+                using reference         = grid_row<T>;
+
+                iterator() = default;
+
+                iterator(T* data, size_type width, size_type pitch, size_type y) :
+                    data_  { data  },
+                    width_ { width },
+                    pitch_ { pitch },
+                    y_     { y     }
+                {
+                }
+
+                grid_row<T> operator * () const
+                {
+                    return grid_row<T>(data_ + y_ * pitch_, width_);
+                }
+
+                iterator& operator ++ ()
+                {
+                    ++y_;
+                    return *this;
+                }
+
+                iterator operator ++ (int)
+                {
+                    auto tmp = *this;
+                    ++y_;
+                    return tmp;
+                }
+
+                //! Returns the y coordinate of the current row.
+                size_type y() const
+                {
+                    return y_;
+                }
+
+                friend bool operator == (const iterator& lhs, const iterator& rhs)
+                {
+                    return (lhs.y_ == rhs.y_);
+                }
+
+                friend bool operator != (const iterator& lhs, const iterator& rhs)
+                {
+                    return (lhs.y_ != rhs.y_);
+                }
+
+            private:
+
+                T*          data_   = nullptr;
+                size_type   width_  = 0;
+                size_type   pitch_  = 0;
+                size_type   y_      = 0;
+
+        };
+
+        grid_rows() = default;
+
+        grid_rows(T* data, size_type width, size_type pitch, size_type first, size_type last) :
+            data_  { data  },
+            width_ { width },
+            pitch_ { pitch },
+            first_ { first },
+            last_  { last  }
+        {
+        }
+
+        //! Returns the row with the specified index, relative to the first row of this range.
+        grid_row<T> operator [] (size_type index) const
+        {
+            return grid_row<T>(data_ + (first_ + index) * pitch_, width_);
+        }
+
+        //! Returns the number of rows.
+        size_type size() const
+        {
+            return (last_ - first_);
+        }
+
+        bool empty() const
+        {
+            return (first_ == last_);
+        }
+
+        //! Returns the y coordinate of the first row.
+        size_type first() const
+        {
+            return first_;
+        }
+
+        //! Returns the y coordinate after the last row.
+        size_type last() const
+        {
+            return last_;
+        }
+
+        /**
+        \brief Returns the block with the specified index when this range is split into 'count' blocks of (almost) equal size.
+        \remarks The blocks cover all rows in order without overlapping. If 'count' is greater than the number of rows, some blocks are empty.
+        */
+        grid_rows split(size_type index, size_type count) const
+        {
+            const auto n = size();
+            return grid_rows(data_, width_, pitch_, first_ + n * index / count, first_ + n * (index + 1) / count);
+        }
+
+        iterator begin() const
+        {
+            return iterator(data_, width_, pitch_, first_);
+        }
+
+        iterator end() const
+        {
+            return iterator(data_, width_, pitch_, last_);
+        }
+
+    private:
+
+        T*          data_   = nullptr;
+        size_type   width_  = 0;
+        size_type   pitch_  = 0;
+        size_type   first_  = 0;
+        size_type   last_   = 0;
+
+};
+
+
+} // /namespace ext
+
+
+#endif
+
+
+
@@ -0,0 +1,56 @@
+/*
+ * index_sequence.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_INDEX_SEQUENCE_H
+#define CPPLIBEXT_INDEX_SEQUENCE_H
+
+
+#include <cstdlib>
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+/*
+Alternative to std::index_sequence from C++14:
+make_index_sequence<3>::type == index_sequence<0, 1, 2>;
+*/
+
+template <std::size_t... Indices>
+struct index_sequence
+{
+};
+
+template <std::size_t N, std::size_t... Indices>
+struct make_index_sequence
+{
+    using type = typename make_index_sequence<(N - 1), (N - 1), Indices...>::type;
+};
+
+template <std::size_t... Indices>
+struct make_index_sequence<0, Indices...>
+{
+    using type = index_sequence<Indices...>;
+};
+
+
+} // /namespace details
+
+} // /namespace ext
+
+
+#endif
+
+
@@ -0,0 +1,208 @@
+/*
+ * mapped_file.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_MAPPED_FILE_H
+#define CPPLIBEXT_MAPPED_FILE_H
+
+
+#include <string>
+#include <stdexcept>
+#include <cstdlib>
+
+#if defined(_WIN32)
+#   ifndef WIN32_LEAN_AND_MEAN
+#       define WIN32_LEAN_AND_MEAN
+#   endif
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+// Read-only memory mapping of an entire file. Throws std::runtime_error if the file can not be mapped.
+class mapped_file
+{
+
+    public:
+
+        mapped_file() = default;
+
+        explicit mapped_file(const std::string& filename)
+        {
+            #if defined(_WIN32)
+
+            file_ = ::CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file_ == INVALID_HANDLE_VALUE)
+                throw std::runtime_error("failed to open file for memory mapping: " + filename);
+
+            LARGE_INTEGER size;
+            if (!::GetFileSizeEx(file_, &size))
+            {
+                close();
+                throw std::runtime_error("failed to query size of file: " + filename);
+            }
+            size_ = static_cast<std::size_t>(size.QuadPart);
+
+            if (size_ > 0)
+            {
+                mapping_ = ::CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (mapping_ != nullptr)
+                    data_ = ::MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+                if (data_ == nullptr)
+                {
+                    close();
+                    throw std::runtime_error("failed to map file into memory: " + filename);
+                }
+            }
+
+            #else
+
+            file_ = ::open(filename.c_str(), O_RDONLY);
+            if (file_ == -1)
+                throw std::runtime_error("failed to open file for memory mapping: " + filename);
+
+            struct stat info;
+            if (::fstat(file_, &info) != 0)
+            {
+                close();
+                throw std::runtime_error("failed to query size of file: " + filename);
+            }
+            size_ = static_cast<std::size_t>(info.st_size);
+
+            if (size_ > 0)
+            {
+                void* ptr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, file_, 0);
+                if (ptr == MAP_FAILED)
+                {
+                    close();
+                    throw std::runtime_error("failed to map file into memory: " + filename);
+                }
+                data_ = ptr;
+            }
+
+            #endif
+        }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator = (const mapped_file&) = delete;
+
+        mapped_file(mapped_file&& rhs) :
+            data_    { rhs.data_    },
+            size_    { rhs.size_    },
+            file_    { rhs.file_    }
+            #if defined(_WIN32)
+            , mapping_ { rhs.mapping_ }
+            #endif
+        {
+            rhs.release();
+        }
+
+        mapped_file& operator = (mapped_file&& rhs)
+        {
+            if (this != &rhs)
+            {
+                close();
+                data_       = rhs.data_;
+                size_       = rhs.size_;
+                file_       = rhs.file_;
+                #if defined(_WIN32)
+                mapping_    = rhs.mapping_;
+                #endif
+                rhs.release();
+            }
+            return *this;
+        }
+
+        ~mapped_file()
+        {
+            close();
+        }
+
+        const void* data() const
+        {
+            return data_;
+        }
+
+        std::size_t size() const
+        {
+            return size_;
+        }
+
+    private:
+
+        void close()
+        {
+            #if defined(_WIN32)
+            if (data_ != nullptr)
+                ::UnmapViewOfFile(data_);
+            if (mapping_ != nullptr)
+                ::CloseHandle(mapping_);
+            if (file_ != INVALID_HANDLE_VALUE)
+                ::CloseHandle(file_);
+            #else
+            if (data_ != nullptr)
+                ::munmap(data_, size_);
+            if (file_ != -1)
+                ::close(file_);
+            #endif
+            release();
+        }
+
+        // Resets the members without releasing the resources.
+        void release()
+        {
+            data_       = nullptr;
+            size_       = 0;
+            #if defined(_WIN32)
+            file_       = INVALID_HANDLE_VALUE;
+            mapping_    = nullptr;
+            #else
+            file_       = -1;
+            #endif
+        }
+
+    private:
+
+        void*       data_       = nullptr;
+        std::size_t size_       = 0;
+
+        #if defined(_WIN32)
+        HANDLE      file_       = INVALID_HANDLE_VALUE;
+        HANDLE      mapping_    = nullptr;
+        #else
+        int         file_       = -1;
+        #endif
+
+};
+
+
+} // /namespace details
+
+} // /namespace ext
+
+
+#endif
+
+
+
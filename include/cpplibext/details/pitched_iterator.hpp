@@ -0,0 +1,225 @@
+/*
+ * pitched_iterator.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_PITCHED_ITERATOR_H
+#define CPPLIBEXT_PITCHED_ITERATOR_H
+
+
+#include <iterator>
+#include <type_traits>
+#include <cstddef>
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+/*
+Random access iterator over the rows of a 2-dimensional storage, where each row of 'width' elements
+is followed by 'pitch - width' padding elements. The padding is skipped, so the iterator visits the
+elements in the same order as a densely packed storage. If pitch == width, this is equivalent to a pointer.
+*/
+template <typename T>
+class pitched_iterator
+{
+
+    public:
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = typename std::remove_const<T>::type;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = T*;
+        using reference         = T&;
+
+        pitched_iterator() = default;
+
+        // Constructs the iterator for the element with the specified (dense) index.
+        pitched_iterator(T* base, std::size_t index, std::size_t width, std::size_t pitch) :
+            base_  { base  },
+            index_ { index },
+            width_ { width },
+            pitch_ { pitch }
+        {
+            seek();
+        }
+
+        // Allows conversion from iterator to const_iterator.
+        template <typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+        pitched_iterator(const pitched_iterator<U>& rhs) :
+            base_   { rhs.base_   },
+            ptr_    { rhs.ptr_    },
+            index_  { rhs.index_  },
+            column_ { rhs.column_ },
+            width_  { rhs.width_  },
+            pitch_  { rhs.pitch_  }
+        {
+        }
+
+        reference operator * () const
+        {
+            return *ptr_;
+        }
+
+        pointer operator -> () const
+        {
+            return ptr_;
+        }
+
+        reference operator [] (difference_type n) const
+        {
+            return *(*this + n);
+        }
+
+        pitched_iterator& operator ++ ()
+        {
+            ++ptr_;
+            ++index_;
+            if (++column_ == width_)
+            {
+                column_ = 0;
+                ptr_ += (pitch_ - width_);
+            }
+            return *this;
+        }
+
+        pitched_iterator operator ++ (int)
+        {
+            auto tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        pitched_iterator& operator -- ()
+        {
+            if (column_ == 0)
+            {
+                column_ = width_;
+                ptr_ -= (pitch_ - width_);
+            }
+            --column_;
+            --ptr_;
+            --index_;
+            return *this;
+        }
+
+        pitched_iterator operator -- (int)
+        {
+            auto tmp = *this;
+            --(*this);
+            return tmp;
+        }
+
+        pitched_iterator& operator += (difference_type n)
+        {
+            index_ = static_cast<std::size_t>(static_cast<difference_type>(index_) + n);
+            seek();
+            return *this;
+        }
+
+        pitched_iterator& operator -= (difference_type n)
+        {
+            return (*this += -n);
+        }
+
+        friend pitched_iterator operator + (pitched_iterator it, difference_type n)
+        {
+            return (it += n);
+        }
+
+        friend pitched_iterator operator + (difference_type n, pitched_iterator it)
+        {
+            return (it += n);
+        }
+
+        friend pitched_iterator operator - (pitched_iterator it, difference_type n)
+        {
+            return (it -= n);
+        }
+
+        friend difference_type operator - (const pitched_iterator& lhs, const pitched_iterator& rhs)
+        {
+            return (static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_));
+        }
+
+        friend bool operator == (const pitched_iterator& lhs, const pitched_iterator& rhs)
+        {
+            return (lhs.index_ == rhs.index_);
+        }
+
+        friend bool operator != (const pitched_iterator& lhs, const pitched_iterator& rhs)
+        {
+            return (lhs.index_ != rhs.index_);
+        }
+
+        friend bool operator < (const pitched_iterator& lhs, const pitched_iterator& rhs)
+        {
+            return (lhs.index_ < rhs.index_);
+        }
+
+        friend bool operator > (const pitched_iterator& lhs, const pitched_iterator& rhs)
+        {
+            return (lhs.index_ > rhs.index_);
+        }
+
+        friend bool operator <= (const pitched_iterator& lhs, const pitched_iterator& rhs)
+        {
+            return (lhs.index_ <= rhs.index_);
+        }
+
+        friend bool operator >= (const pitched_iterator& lhs, const pitched_iterator& rhs)
+        {
+            return (lhs.index_ >= rhs.index_);
+        }
+
+    private:
+
+        template <typename U>
+        friend class pitched_iterator;
+
+        // Updates the pointer and column for the current index.
+        void seek()
+        {
+            if (width_ > 0)
+            {
+                column_ = index_ % width_;
+                ptr_    = base_ + (index_ / width_) * pitch_ + column_;
+            }
+            else
+            {
+                column_ = 0;
+                ptr_    = base_;
+            }
+        }
+
+    private:
+
+        T*          base_   = nullptr;
+        T*          ptr_    = nullptr;
+        std::size_t index_  = 0;
+        std::size_t column_ = 0;
+        std::size_t width_  = 0;
+        std::size_t pitch_  = 0;
+
+};
+
+
+} // /namespace details
+
+} // /namespace ext
+
+
+#endif
+
+
+
@@ -12,6 +12,9 @@
 #define CPPLIBEXT_PRODUCT_H
 
 
+#include <cstdlib>
+
+
 namespace ext
 {
 
@@ -50,6 +53,49 @@ struct product_secondary<T>
 };
 
 
+/*
+meta template to compute the product of all integral numbers after the specified index:
+product_after<int, 0, 2, 5, 3>::value == 5*3 = 15;
+product_after<int, 2, 2, 5, 3>::value == 1;
+*/
+
+template <typename T, std::size_t Index, T... XN>
+struct product_after;
+
+template <typename T, std::size_t Index, T X1, T... XN>
+struct product_after<T, Index, X1, XN...>
+{
+    static const T value = (product_after<T, (Index - 1), XN...>::value);
+};
+
+template <typename T, T X1, T... XN>
+struct product_after<T, 0, X1, XN...>
+{
+    static const T value = (product_secondary<T, XN...>::value);
+};
+
+/*
+meta template to compute the product of all integral numbers before the specified index:
+product_before<int, 2, 2, 5, 3>::value == 2*5 = 10;
+product_before<int, 0, 2, 5, 3>::value == 1;
+*/
+
+template <typename T, std::size_t Index, T... XN>
+struct product_before;
+
+template <typename T, std::size_t Index, T X1, T... XN>
+struct product_before<T, Index, X1, XN...>
+{
+    static const T value = (X1 * product_before<T, (Index - 1), XN...>::value);
+};
+
+template <typename T, T X1, T... XN>
+struct product_before<T, 0, X1, XN...>
+{
+    static const T value = T(1);
+};
+
+
 } // /namespace details
 
 } // /namespace ext
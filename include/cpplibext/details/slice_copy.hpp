@@ -0,0 +1,226 @@
+/*
+ * slice_copy.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_SLICE_COPY_H
+#define CPPLIBEXT_SLICE_COPY_H
+
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <cstring>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+// Type trait to detect the slice classes of multi_array, i.e. the return values of "ary[i]" or "ary[i][j]".
+template <class T, class = void>
+struct is_multi_array_slice : std::false_type {};
+
+template <class T>
+struct is_multi_array_slice<T, typename std::conditional<true, void, decltype(T::extent() + T::size() + T::is_contiguous)>::type> : std::true_type {};
+
+/*
+Copies 'n' elements from 'src' to 'dst'. The ranges may overlap.
+Trivially copyable types are copied with a single memmove, all other types are copy-assigned element-wise.
+*/
+template <typename T>
+void copy_elements(const T* src, T* dst, std::size_t n, std::true_type)
+{
+    if (n > 0 && src != dst)
+        std::memmove(dst, src, n * sizeof(T));
+}
+
+template <typename T>
+void copy_elements(const T* src, T* dst, std::size_t n, std::false_type)
+{
+    if (std::less<const T*>()(dst, src))
+        std::copy(src, src + n, dst);
+    else if (dst != src)
+        std::copy_backward(src, src + n, dst + n);
+}
+
+template <typename T>
+void copy_elements(const T* src, T* dst, std::size_t n)
+{
+    copy_elements(src, dst, n, std::integral_constant<bool, std::is_trivially_copyable<T>::value>());
+}
+
+// Moves 'n' elements from 'src' to 'dst'. Same as copy_elements, but non-trivial types are move-assigned element-wise.
+template <typename T>
+void move_elements(T* src, T* dst, std::size_t n, std::true_type)
+{
+    copy_elements(src, dst, n, std::true_type());
+}
+
+template <typename T>
+void move_elements(T* src, T* dst, std::size_t n, std::false_type)
+{
+    if (std::less<const T*>()(dst, src))
+        std::move(src, src + n, dst);
+    else if (dst != src)
+        std::move_backward(src, src + n, dst + n);
+}
+
+template <typename T>
+void move_elements(T* src, T* dst, std::size_t n)
+{
+    move_elements(src, dst, n, std::integral_constant<bool, std::is_trivially_copyable<T>::value>());
+}
+
+
+// Specifies whether two slices can be copied as a single range, i.e. both are contiguous and have the same value type.
+template <class Dst, class Src>
+struct is_contiguous_slice_pair
+{
+    static const bool value =
+    (
+        Dst::is_contiguous && Src::is_contiguous &&
+        std::is_same<
+            typename std::remove_pointer<decltype(std::declval<Dst>().data())>::type,
+            typename std::remove_const<typename std::remove_pointer<decltype(std::declval<Src>().data())>::type>::type
+        >::value
+    );
+};
+
+template <class Dst, class Src>
+void copy_slice_elements(Dst dst, Src src);
+
+template <class Dst, class Src>
+void move_slice_elements(Dst dst, Src src);
+
+template <class Dst, class Src>
+void copy_slice_element(Dst&& dst, Src&& src, std::true_type)
+{
+    copy_slice_elements(dst, src);
+}
+
+template <class Dst, class Src>
+void copy_slice_element(Dst&& dst, Src&& src, std::false_type)
+{
+    dst = src;
+}
+
+template <class Dst, class Src>
+void move_slice_element(Dst&& dst, Src&& src, std::true_type)
+{
+    move_slice_elements(dst, src);
+}
+
+template <class Dst, class Src>
+void move_slice_element(Dst&& dst, Src&& src, std::false_type)
+{
+    dst = std::move(src);
+}
+
+template <class Dst, class Src>
+void copy_slice_elements(Dst& dst, Src& src, std::true_type)
+{
+    copy_elements(src.data(), dst.data(), Dst::size());
+}
+
+template <class Dst, class Src>
+void copy_slice_elements(Dst& dst, Src& src, std::false_type)
+{
+    for (std::size_t i = 0; i < Dst::extent(); ++i)
+        copy_slice_element(dst[i], src[i], is_multi_array_slice<typename std::decay<decltype(dst[i])>::type>());
+}
+
+template <class Dst, class Src>
+void move_slice_elements(Dst& dst, Src& src, std::true_type)
+{
+    move_elements(src.data(), dst.data(), Dst::size());
+}
+
+template <class Dst, class Src>
+void move_slice_elements(Dst& dst, Src& src, std::false_type)
+{
+    for (std::size_t i = 0; i < Dst::extent(); ++i)
+        move_slice_element(dst[i], src[i], is_multi_array_slice<typename std::decay<decltype(dst[i])>::type>());
+}
+
+// Copies the elements of the slice 'src' into the slice 'dst' with the same extents.
+template <class Dst, class Src>
+void copy_slice_elements(Dst dst, Src src)
+{
+    static_assert(Dst::size() == Src::size() && Dst::extent() == Src::extent(), "multi_array slices must have the same extents");
+    copy_slice_elements(dst, src, std::integral_constant<bool, is_contiguous_slice_pair<Dst, Src>::value>());
+}
+
+// Moves the elements of the slice 'src' into the slice 'dst' with the same extents.
+template <class Dst, class Src>
+void move_slice_elements(Dst dst, Src src)
+{
+    static_assert(Dst::size() == Src::size() && Dst::extent() == Src::extent(), "multi_array slices must have the same extents");
+    move_slice_elements(dst, src, std::integral_constant<bool, is_contiguous_slice_pair<Dst, Src>::value>());
+}
+
+template <class Dst, class ForwardIt>
+void assign_slice_range(Dst dst, ForwardIt first, ForwardIt last);
+
+template <class Dst, class ForwardIt>
+void assign_slice_range(Dst& dst, ForwardIt first, ForwardIt last, std::true_type)
+{
+    std::copy(first, last, dst.data());
+}
+
+template <class Dst, class ForwardIt>
+void assign_slice_range_element(Dst&& dst, ForwardIt first, ForwardIt last, std::true_type)
+{
+    assign_slice_range(dst, first, last);
+}
+
+template <class Dst, class ForwardIt>
+void assign_slice_range_element(Dst&& dst, ForwardIt first, ForwardIt, std::false_type)
+{
+    dst = *first;
+}
+
+template <class Dst, class ForwardIt>
+void assign_slice_range(Dst& dst, ForwardIt first, ForwardIt, std::false_type)
+{
+    const auto sub_size = static_cast<typename std::iterator_traits<ForwardIt>::difference_type>(Dst::size() / Dst::extent());
+    for (std::size_t i = 0; i < Dst::extent(); ++i)
+    {
+        auto next = std::next(first, sub_size);
+        assign_slice_range_element(dst[i], first, next, is_multi_array_slice<typename std::decay<decltype(dst[i])>::type>());
+        first = next;
+    }
+}
+
+// Copies the elements of the range [first, last) into the slice 'dst' in logical order.
+template <class Dst, class ForwardIt>
+void assign_slice_range(Dst dst, ForwardIt first, ForwardIt last)
+{
+    if (static_cast<std::size_t>(std::distance(first, last)) != Dst::size())
+        throw std::invalid_argument("multi_array::slice::assign range does not match the slice size");
+    assign_slice_range(dst, first, last, std::integral_constant<bool, Dst::is_contiguous>());
+}
+
+
+} // /namespace details
+
+} // /namespace ext
+
+
+#endif
+
+
+
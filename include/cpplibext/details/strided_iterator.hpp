@@ -0,0 +1,185 @@
+/*
+ * strided_iterator.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_STRIDED_ITERATOR_H
+#define CPPLIBEXT_STRIDED_ITERATOR_H
+
+
+#include <iterator>
+#include <type_traits>
+#include <cstddef>
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+/*
+Random access iterator over elements with a constant distance of 'stride' elements, e.g. the column of a 2-dimensional storage.
+The position is stored as an index relative to the first element, so the end iterator never forms a pointer past the storage.
+*/
+template <typename T>
+class strided_iterator
+{
+
+    public:
+
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = typename std::remove_const<T>::type;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = T*;
+        using reference         = T&;
+
+        strided_iterator() = default;
+
+        strided_iterator(T* base, std::size_t index, std::size_t stride) :
+            base_   { base                                      },
+            index_  { static_cast<difference_type>(index)       },
+            stride_ { static_cast<difference_type>(stride)      }
+        {
+        }
+
+        // Allows conversion from iterator to const_iterator.
+        template <typename U, typename = typename std::enable_if<std::is_convertible<U*, T*>::value>::type>
+        strided_iterator(const strided_iterator<U>& rhs) :
+            base_   { rhs.base_   },
+            index_  { rhs.index_  },
+            stride_ { rhs.stride_ }
+        {
+        }
+
+        reference operator * () const
+        {
+            return base_[index_ * stride_];
+        }
+
+        pointer operator -> () const
+        {
+            return base_ + index_ * stride_;
+        }
+
+        reference operator [] (difference_type n) const
+        {
+            return base_[(index_ + n) * stride_];
+        }
+
+        strided_iterator& operator ++ ()
+        {
+            ++index_;
+            return *this;
+        }
+
+        strided_iterator operator ++ (int)
+        {
+            auto tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        strided_iterator& operator -- ()
+        {
+            --index_;
+            return *this;
+        }
+
+        strided_iterator operator -- (int)
+        {
+            auto tmp = *this;
+            --(*this);
+            return tmp;
+        }
+
+        strided_iterator& operator += (difference_type n)
+        {
+            index_ += n;
+            return *this;
+        }
+
+        strided_iterator& operator -= (difference_type n)
+        {
+            index_ -= n;
+            return *this;
+        }
+
+        friend strided_iterator operator + (strided_iterator it, difference_type n)
+        {
+            return (it += n);
+        }
+
+        friend strided_iterator operator + (difference_type n, strided_iterator it)
+        {
+            return (it += n);
+        }
+
+        friend strided_iterator operator - (strided_iterator it, difference_type n)
+        {
+            return (it -= n);
+        }
+
+        friend difference_type operator - (const strided_iterator& lhs, const strided_iterator& rhs)
+        {
+            return (lhs.index_ - rhs.index_);
+        }
+
+        friend bool operator == (const strided_iterator& lhs, const strided_iterator& rhs)
+        {
+            return (lhs.index_ == rhs.index_);
+        }
+
+        friend bool operator != (const strided_iterator& lhs, const strided_iterator& rhs)
+        {
+            return (lhs.index_ != rhs.index_);
+        }
+
+        friend bool operator < (const strided_iterator& lhs, const strided_iterator& rhs)
+        {
+            return (lhs.index_ < rhs.index_);
+        }
+
+        friend bool operator > (const strided_iterator& lhs, const strided_iterator& rhs)
+        {
+            return (lhs.index_ > rhs.index_);
+        }
+
+        friend bool operator <= (const strided_iterator& lhs, const strided_iterator& rhs)
+        {
+            return (lhs.index_ <= rhs.index_);
+        }
+
+        friend bool operator >= (const strided_iterator& lhs, const strided_iterator& rhs)
+        {
+            return (lhs.index_ >= rhs.index_);
+        }
+
+    private:
+
+        template <typename U>
+        friend class strided_iterator;
+
+        T*              base_   = nullptr;
+        difference_type index_  = 0;
+        difference_type stride_ = 1;
+
+};
+
+
+} // /namespace details
+
+} // /namespace ext
+
+
+#endif
+
+
+
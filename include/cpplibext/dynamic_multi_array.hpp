@@ -0,0 +1,453 @@
+/*
+ * dynamic_multi_array.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_DYNAMIC_MULTI_ARRAY_H
+#define CPPLIBEXT_DYNAMIC_MULTI_ARRAY_H
+
+
+#include <initializer_list>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include <array>
+
+
+namespace ext
+{
+
+
+/**
+\brief Slice proxy of a dynamic_multi_array.
+\tparam T Specifies the data type for the array elements. This may be a const qualified type for constant slices.
+\tparam Rank Specifies the number of dimensions of this slice.
+\remarks Each subscript only adds 'stride * index' to the slice pointer, so a chain like ary[i][j][k]
+compiles down to one multiply-add per dimension. The innermost stride is always 1, so the last subscript is a plain offset.
+\see dynamic_multi_array
+*/
+template <typename T, std::size_t Rank>
+class dynamic_multi_array_slice
+{
+
+    public:
+
+        using value_type        = T;
+        using size_type         = std::size_t;
+        using pointer           = value_type*;
+        using subscript_type    = dynamic_multi_array_slice<T, Rank - 1>;
+
+        dynamic_multi_array_slice(pointer ptr, const size_type* extents, const size_type* strides) :
+            ptr_     { ptr     },
+            extents_ { extents },
+            strides_ { strides }
+        {
+        }
+
+        subscript_type operator [] (const size_type& index) const
+        {
+            return subscript_type(ptr_ + (strides_[0] * index), extents_ + 1, strides_ + 1);
+        }
+
+        subscript_type at(const size_type& index) const
+        {
+            if (index >= extents_[0])
+                throw std::out_of_range("dynamic_multi_array::slice out of range");
+            return (*this)[index];
+        }
+
+        const dynamic_multi_array_slice& operator = (const value_type& value) const
+        {
+            std::fill(ptr_, ptr_ + size(), value);
+            return *this;
+        }
+
+        //! Returns the number of elements in this slice.
+        size_type size() const
+        {
+            return extents_[0] * strides_[0];
+        }
+
+    private:
+
+        pointer             ptr_        = nullptr;
+        const size_type*    extents_    = nullptr;
+        const size_type*    strides_    = nullptr;
+
+};
+
+template <typename T>
+class dynamic_multi_array_slice<T, 1>
+{
+
+    public:
+
+        using value_type        = T;
+        using size_type         = std::size_t;
+        using pointer           = value_type*;
+        using reference         = value_type&;
+        using subscript_type    = reference;
+
+        dynamic_multi_array_slice(pointer ptr, const size_type* extents, const size_type* /*strides*/) :
+            ptr_     { ptr     },
+            extents_ { extents }
+        {
+        }
+
+        reference operator [] (const size_type& index) const
+        {
+            return ptr_[index];
+        }
+
+        reference at(const size_type& index) const
+        {
+            if (index >= extents_[0])
+                throw std::out_of_range("dynamic_multi_array::slice out of range");
+            return ptr_[index];
+        }
+
+        const dynamic_multi_array_slice& operator = (const value_type& value) const
+        {
+            std::fill(ptr_, ptr_ + size(), value);
+            return *this;
+        }
+
+        //! Returns the number of elements in this slice.
+        size_type size() const
+        {
+            return extents_[0];
+        }
+
+    private:
+
+        pointer             ptr_        = nullptr;
+        const size_type*    extents_    = nullptr;
+
+};
+
+
+/**
+\brief Multi dimensional array class with extents that are specified at runtime.
+\tparam T Specifies the data type for the array elements.
+\tparam Rank Specifies the number of dimensions. This must be at least 1.
+\tparam Alloc Specifies the allocator for the underlying std::vector.
+\remarks All elements are stored in a single contiguous allocation in row-major order (like multi_array),
+and the element offsets are computed with the strides that are cached when the extents are set.
+\code
+// Example usage:
+ext::dynamic_multi_array<float, 3> ary { 3, 2, 4 };
+ary[0]       = 1; // Write 1's into all ary[0][i][j] where 0 <= i < 2 and 0 <= j < 4.
+ary[1][1]    = 2; // Write 2's into all ary[1][1][i] where 0 <= i < 4.
+ary[2][0][3] = 4; // Write a single 4 into ary[2][0][3].
+\endcode
+\see multi_array
+*/
+template <typename T, std::size_t Rank, class Alloc = std::allocator<T>>
+class dynamic_multi_array
+{
+
+    public:
+
+        static_assert(Rank > 0, "dynamic_multi_array must have at least 1 dimension");
+
+    private:
+
+        /* --- Extended types --- */
+        using storage_type  = std::vector<T, Alloc>;
+        using this_type     = dynamic_multi_array<T, Rank, Alloc>;
+
+    public:
+
+        using value_type                = typename storage_type::value_type;
+        using allocator_type            = typename storage_type::allocator_type;
+        using size_type                 = typename storage_type::size_type;
+        using difference_type           = typename storage_type::difference_type;
+        using reference                 = typename storage_type::reference;
+        using const_reference           = typename storage_type::const_reference;
+        using pointer                   = typename storage_type::pointer;
+        using const_pointer             = typename storage_type::const_pointer;
+        using iterator                  = typename storage_type::iterator;
+        using const_iterator            = typename storage_type::const_iterator;
+        using reverse_iterator          = typename storage_type::reverse_iterator;
+        using const_reverse_iterator    = typename storage_type::const_reverse_iterator;
+
+        using extents_type              = std::array<size_type, Rank>;
+
+        template <std::size_t SliceRank>
+        using slice                     = dynamic_multi_array_slice<value_type, SliceRank>;
+
+        template <std::size_t SliceRank>
+        using const_slice               = dynamic_multi_array_slice<const value_type, SliceRank>;
+
+        //! Return type of operator[], which is either a slice or a reference for the 1-dimensional array.
+        using subscript_type            = typename slice<Rank>::subscript_type;
+
+        //! Return type of operator[] const, which is either a constant slice or a constant reference for the 1-dimensional array.
+        using const_subscript_type      = typename const_slice<Rank>::subscript_type;
+
+        //! Number of dimensions.
+        static const size_type num_dimensions = Rank;
+
+    public:
+
+        dynamic_multi_array()
+        {
+            extents_.fill(0);
+            strides_.fill(0);
+        }
+
+        explicit dynamic_multi_array(const extents_type& extents)
+        {
+            resize(extents);
+        }
+
+        dynamic_multi_array(const extents_type& extents, const value_type& value)
+        {
+            resize(extents, value);
+        }
+
+        dynamic_multi_array(const std::initializer_list<size_type>& extents)
+        {
+            resize(to_extents(extents));
+        }
+
+        dynamic_multi_array(const this_type&) = default;
+
+        dynamic_multi_array(this_type&& other) :
+            data_    { std::move(other.data_) },
+            extents_ ( other.extents_         ),
+            strides_ ( other.strides_         )
+        {
+            other.extents_.fill(0);
+            other.strides_.fill(0);
+        }
+
+        this_type& operator = (const this_type&) = default;
+
+        this_type& operator = (this_type&& other)
+        {
+            data_       = std::move(other.data_);
+            extents_    = other.extents_;
+            strides_    = other.strides_;
+            other.extents_.fill(0);
+            other.strides_.fill(0);
+            return *this;
+        }
+
+        /**
+        \brief Resizes the array to the new extents.
+        \remarks The previous content is not re-arranged, i.e. it is only preserved if the strides of all but the first dimension did not change.
+        */
+        void resize(const extents_type& extents)
+        {
+            extents_ = extents;
+            data_.resize(update_strides());
+        }
+
+        //! \see resize(const extents_type&)
+        void resize(const extents_type& extents, const value_type& value)
+        {
+            extents_ = extents;
+            data_.resize(update_strides(), value);
+        }
+
+        //! Returns the extents of all dimensions.
+        const extents_type& extents() const
+        {
+            return extents_;
+        }
+
+        //! Returns the strides (in number of elements) of all dimensions. The last stride is always 1.
+        const extents_type& strides() const
+        {
+            return strides_;
+        }
+
+        /**
+        Returns the number of slices for the specifies dimension.
+        \param[in] dimension Specifies the dimension index for the requested slices.
+        \throws std::out_of_range If 'dimension' is greater then or equal to the number of array dimensions (num_dimensions).
+        \see num_dimensions
+        */
+        size_type slices(const size_type& dimension) const
+        {
+            if (dimension >= num_dimensions)
+                throw std::out_of_range("dynamic_multi_array::slices out of range");
+            return extents_[dimension];
+        }
+
+        /**
+        Returns the number of slices for the specifies dimension.
+        \tparam DimensionIndex Specifies the dimension index for the requested slices.
+        \see num_dimensions
+        */
+        template <size_type DimensionIndex>
+        size_type slices() const
+        {
+            static_assert(DimensionIndex < num_dimensions, "dynamic_multi_array::slice out of range");
+            return extents_[DimensionIndex];
+        }
+
+        pointer data()
+        {
+            return data_.data();
+        }
+
+        const_pointer data() const
+        {
+            return data_.data();
+        }
+
+        //! Returns the total number of elements.
+        size_type size() const
+        {
+            return data_.size();
+        }
+
+        bool empty() const
+        {
+            return data_.empty();
+        }
+
+        size_type max_size() const
+        {
+            return data_.max_size();
+        }
+
+        iterator begin()
+        {
+            return data_.begin();
+        }
+
+        const_iterator begin() const
+        {
+            return data_.begin();
+        }
+
+        reverse_iterator rbegin()
+        {
+            return data_.rbegin();
+        }
+
+        const_reverse_iterator rbegin() const
+        {
+            return data_.rbegin();
+        }
+
+        iterator end()
+        {
+            return data_.end();
+        }
+
+        const_iterator end() const
+        {
+            return data_.end();
+        }
+
+        reverse_iterator rend()
+        {
+            return data_.rend();
+        }
+
+        const_reverse_iterator rend() const
+        {
+            return data_.rend();
+        }
+
+        reference front()
+        {
+            return data_.front();
+        }
+
+        const_reference front() const
+        {
+            return data_.front();
+        }
+
+        reference back()
+        {
+            return data_.back();
+        }
+
+        const_reference back() const
+        {
+            return data_.back();
+        }
+
+        void fill(const value_type& value)
+        {
+            std::fill(data_.begin(), data_.end(), value);
+        }
+
+        void swap(this_type& other)
+        {
+            data_.swap(other.data_);
+            std::swap(extents_, other.extents_);
+            std::swap(strides_, other.strides_);
+        }
+
+        subscript_type operator [] (const size_type& index)
+        {
+            return slice<Rank>(data_.data(), extents_.data(), strides_.data())[index];
+        }
+
+        const_subscript_type operator [] (const size_type& index) const
+        {
+            return const_slice<Rank>(data_.data(), extents_.data(), strides_.data())[index];
+        }
+
+        subscript_type at(const size_type& index)
+        {
+            return slice<Rank>(data_.data(), extents_.data(), strides_.data()).at(index);
+        }
+
+        const_subscript_type at(const size_type& index) const
+        {
+            return const_slice<Rank>(data_.data(), extents_.data(), strides_.data()).at(index);
+        }
+
+    private:
+
+        static extents_type to_extents(const std::initializer_list<size_type>& list)
+        {
+            if (list.size() != Rank)
+                throw std::invalid_argument("number of extents does not match the rank of dynamic_multi_array");
+            extents_type extents;
+            std::copy(list.begin(), list.end(), extents.begin());
+            return extents;
+        }
+
+        // Updates the strides by the current extents and returns the total number of elements.
+        size_type update_strides()
+        {
+            size_type n = 1;
+            for (size_type i = Rank; i > 0; --i)
+            {
+                strides_[i - 1] = n;
+                n *= extents_[i - 1];
+            }
+            return n;
+        }
+
+    private:
+
+        //! Array data storage.
+        storage_type    data_;
+
+        extents_type    extents_;
+        extents_type    strides_;
+
+};
+
+
+} // /namespace ext
+
+
+#endif
+
+
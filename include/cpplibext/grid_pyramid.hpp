@@ -0,0 +1,248 @@
+/*
+ * grid_pyramid.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_GRID_PYRAMID_H
+#define CPPLIBEXT_GRID_PYRAMID_H
+
+
+#include "grid_vector.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+
+//! Reducer for grid_pyramid which returns the mean value of the source elements.
+struct mean_reducer
+{
+    template <typename T>
+    T operator () (const T* values, std::size_t count) const
+    {
+        double sum = 0.0;
+        for (std::size_t i = 0; i < count; ++i)
+            sum += static_cast<double>(values[i]);
+        return static_cast<T>(sum / static_cast<double>(count));
+    }
+};
+
+//! Reducer for grid_pyramid which returns the maximum of the source elements.
+struct max_reducer
+{
+    template <typename T>
+    T operator () (const T* values, std::size_t count) const
+    {
+        return *std::max_element(values, values + count);
+    }
+};
+
+//! Reducer for grid_pyramid which returns the sum of the source elements.
+struct sum_reducer
+{
+    template <typename T>
+    T operator () (const T* values, std::size_t count) const
+    {
+        T sum = values[0];
+        for (std::size_t i = 1; i < count; ++i)
+            sum += values[i];
+        return sum;
+    }
+};
+
+
+/**
+\brief Mip pyramid of successive half-resolution levels of a grid_vector.
+\tparam T Specifies the element type of the source grid.
+\tparam Reducer Specifies the function object that combines up to 2x2 elements into one element of the next level
+with the signature "T reducer(const T* values, std::size_t count)". See mean_reducer, max_reducer, and sum_reducer.
+\remarks The source grid is not copied: level 0 has half the resolution of the source grid (rounded up), and each further level halves the resolution again,
+until the last level has a single element. Elements in the last column or row of a level with an odd size have fewer than 4 source elements.
+After the source grid has been modified, only the affected elements are computed again (see update), e.g. with the dirty regions of a tracked_grid_vector.
+\code
+// Example usage:
+ext::tracked_grid_vector<float> map;
+map.resize(4096, 4096, 0.0f);
+ext::grid_pyramid<float, ext::max_reducer> lod;
+lod.build(map);                                 // 12 levels from 2048x2048 down to 1x1
+map.enable_dirty_tracking(ext::dirty_tracking::tiles);
+map(100, 200) = 5.0f;
+lod.update(map, map.dirty_regions());           // Only recomputes one 32x32 tile on each level
+float max_value = lod.level(lod.levels() - 1)(0, 0);
+\endcode
+*/
+template <typename T, class Reducer = mean_reducer, class Alloc = std::allocator<T>>
+class grid_pyramid
+{
+
+    public:
+
+        using value_type    = T;
+        using size_type     = std::size_t;
+        using level_type    = grid_vector<T, Alloc>;
+
+        explicit grid_pyramid(const Reducer& reducer = Reducer()) :
+            reducer_ ( reducer )
+        {
+        }
+
+        /**
+        \brief Builds all levels of the specified source grid.
+        \param[in] max_levels Specifies the maximal number of levels. By default, the levels go down to a single element.
+        */
+        template <class SrcAlloc, class Tracking, class Padding>
+        void build(const grid_vector<T, SrcAlloc, Tracking, Padding>& src, size_type max_levels = ~size_type(0))
+        {
+            levels_.clear();
+            width_  = src.width();
+            height_ = src.height();
+
+            /* Determine the sizes of all levels first, so the levels are never moved */
+            size_type w = width_, h = height_, n = 0;
+            while (n < max_levels && (w > 1 || h > 1))
+            {
+                w = (w + 1) / 2;
+                h = (h + 1) / 2;
+                ++n;
+            }
+            levels_.reserve(n);
+
+            for (size_type i = 0; i < n; ++i)
+            {
+                const size_type src_width  = (i == 0 ? width_  : levels_.back().width());
+                const size_type src_height = (i == 0 ? height_ : levels_.back().height());
+
+                levels_.emplace_back();
+                levels_.back().resize((src_width + 1) / 2, (src_height + 1) / 2);
+
+                if (i == 0)
+                    reduce_region(src, levels_[0], { 0, 0, levels_[0].width(), levels_[0].height() });
+                else
+                    reduce_region(levels_[i - 1], levels_[i], { 0, 0, levels_[i].width(), levels_[i].height() });
+            }
+        }
+
+        /**
+        \brief Updates all levels after the specified regions of the source grid have been modified.
+        \param[in] regions Specifies the modified regions of the source grid, e.g. tracked_grid_vector::dirty_regions.
+        \remarks Each region is clipped to the source grid, and only the elements which cover a modified region are computed again.
+        \throws std::invalid_argument If the source grid does not have the same size as in the last call to build.
+        */
+        template <class SrcAlloc, class Tracking, class Padding>
+        void update(const grid_vector<T, SrcAlloc, Tracking, Padding>& src, std::vector<grid_region> regions)
+        {
+            if (src.width() != width_ || src.height() != height_)
+                throw std::invalid_argument("grid_pyramid::update source grid size does not match the pyramid");
+
+            for (size_type i = 0; i < levels_.size(); ++i)
+            {
+                for (auto& r : regions)
+                {
+                    r = parent_region(r, levels_[i]);
+                    if (i == 0)
+                        reduce_region(src, levels_[0], r);
+                    else
+                        reduce_region(levels_[i - 1], levels_[i], r);
+                }
+            }
+        }
+
+        //! Updates all levels after the specified region of the source grid has been modified. \see update(src, regions)
+        template <class SrcAlloc, class Tracking, class Padding>
+        void update(const grid_vector<T, SrcAlloc, Tracking, Padding>& src, size_type x, size_type y, size_type width, size_type height)
+        {
+            update(src, std::vector<grid_region> { { x, y, width, height } });
+        }
+
+        //! Returns the number of levels.
+        size_type levels() const
+        {
+            return levels_.size();
+        }
+
+        //! Returns the specified level, where level 0 has half the resolution of the source grid.
+        const level_type& level(size_type index) const
+        {
+            return levels_[index];
+        }
+
+        //! Returns the reducer, which combines the elements of one level into the next level.
+        const Reducer& reducer() const
+        {
+            return reducer_;
+        }
+
+    private:
+
+        // Returns the region of the parent level which covers the specified region of the child level, clipped to the parent level.
+        static grid_region parent_region(const grid_region& r, const level_type& parent)
+        {
+            if (r.width == 0 || r.height == 0)
+                return { 0, 0, 0, 0 };
+            const auto x0 = std::min(r.x / 2, parent.width());
+            const auto y0 = std::min(r.y / 2, parent.height());
+            const auto x1 = std::min((r.x + r.width + 1) / 2, parent.width());
+            const auto y1 = std::min((r.y + r.height + 1) / 2, parent.height());
+            return { x0, y0, x1 - x0, y1 - y0 };
+        }
+
+        // Computes the elements of the specified region of 'dst' from their (up to) 2x2 source elements in 'src'.
+        template <class SrcGrid>
+        void reduce_region(const SrcGrid& src, level_type& dst, const grid_region& r)
+        {
+            T values[4];
+            for (size_type y = r.y; y < r.y + r.height; ++y)
+            {
+                const size_type sy = y*2;
+                const T* row0 = src.row(sy);
+                const T* row1 = (sy + 1 < src.height() ? src.row(sy + 1).data() : nullptr);
+                T* dst_row = dst.row(y);
+
+                for (size_type x = r.x; x < r.x + r.width; ++x)
+                {
+                    const size_type sx = x*2;
+                    const bool has_right = (sx + 1 < src.width());
+
+                    size_type n = 0;
+                    values[n++] = row0[sx];
+                    if (has_right)
+                        values[n++] = row0[sx + 1];
+                    if (row1)
+                    {
+                        values[n++] = row1[sx];
+                        if (has_right)
+                            values[n++] = row1[sx + 1];
+                    }
+
+                    dst_row[x] = reducer_(static_cast<const T*>(values), n);
+                }
+            }
+        }
+
+    private:
+
+        std::vector<level_type> levels_;
+        size_type               width_      = 0;
+        size_type               height_     = 0;
+        Reducer                 reducer_;
+
+};
+
+
+} // /namespace ext
+
+
+#endif
+
+
+
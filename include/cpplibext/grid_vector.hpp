@@ -12,14 +12,41 @@
 #define CPPLIBEXT_GRID_VECTOR_H
 
 
+#include "details/pitched_iterator.hpp"
+#include "details/slice_copy.hpp"
+#include "details/dirty_tracker.hpp"
+#include "details/grid_views.hpp"
+
+#include <algorithm>
+#include <type_traits>
 #include <vector>
+#include <stdexcept>
 
 
 namespace ext
 {
 
 
-template <typename T, class Alloc = std::allocator<T>>
+//! Padding policy of grid_vector without padding after the rows (default). The iterators are plain pointers.
+struct unpadded {};
+
+//! Padding policy of grid_vector which allows padding after each row. \see grid_vector::resize_padded
+struct padded {};
+
+
+/**
+\brief Simple wrapper of std::vector for 2-dimensional element access.
+\remarks With the padded policy, each row can be followed by padding elements (see resize_padded), so the distance between two rows (the "pitch")
+is not a power of two. Otherwise column-wise access maps all rows to the same cache sets, e.g. for rows of 1024 floats.
+The iterators of a padded grid skip the padding, i.e. they only visit the width() * height() elements of the grid, but they check for the end of a row on every increment.
+Without padding, the iterators are plain pointers, so standard algorithms compile to the same loops as for std::vector.
+\tparam Tracking Specifies the tracking policy for written elements: untracked (default) or dirty_tracked (see enable_dirty_tracking).
+With the untracked policy, the writes have no overhead. With the dirty_tracked policy, each write through operator() or at checks the tracker even while tracking is disabled,
+which prevents vectorization and makes tight write loops about 2-3 times slower. The row, column, and rows views only mark their elements once per view,
+so they are as fast as the untracked policy and should be used for hot loops over a tracked grid.
+\tparam Padding Specifies the padding policy: unpadded (default) or padded (see padded_grid_vector).
+*/
+template <typename T, class Alloc = std::allocator<T>, class Tracking = untracked, class Padding = unpadded>
 class grid_vector
 {
     
@@ -27,7 +54,8 @@ class grid_vector
 
         /* --- Extended types --- */
         using storage_type  = std::vector<T, Alloc>;
-        using this_type     = grid_vector<T, Alloc>;
+        using this_type     = grid_vector<T, Alloc, Tracking, Padding>;
+        using is_padded     = std::integral_constant<bool, std::is_same<Padding, padded>::value>;
 
     public:
 
@@ -38,41 +66,106 @@ class grid_vector
         using const_pointer             = typename storage_type::const_pointer;
         using reference                 = typename storage_type::reference;
         using const_reference           = typename storage_type::const_reference;
-        using iterator                  = typename storage_type::iterator                 ;
-        using const_iterator            = typename storage_type::const_iterator;
-        using reverse_iterator          = typename storage_type::reverse_iterator;
-        using const_reverse_iterator    = typename storage_type::const_reverse_iterator;
+        using iterator                  = typename std::conditional<is_padded::value, details::pitched_iterator<value_type>, value_type*>::type;
+        using const_iterator            = typename std::conditional<is_padded::value, details::pitched_iterator<const value_type>, const value_type*>::type;
+        using reverse_iterator          = std::reverse_iterator<iterator>;
+        using const_reverse_iterator    = std::reverse_iterator<const_iterator>;
         using difference_type           = typename storage_type::difference_type;
         using size_type                 = typename storage_type::size_type;
 
+        /* --- View types --- */
+        using row_type                  = grid_row<value_type>;
+        using const_row_type            = grid_row<const value_type>;
+        using column_type               = grid_column<value_type>;
+        using const_column_type         = grid_column<const value_type>;
+        using rows_type                 = grid_rows<value_type>;
+        using const_rows_type           = grid_rows<const value_type>;
+
     private:
 
         //! Vector data storage.
         storage_type data_;
 
-        size_type width_ = 0, height_ = 0;
+        size_type width_ = 0, height_ = 0, pitch_ = 0;
+
+        //! Dirty region tracker of the tracking policy.
+        details::grid_tracker<Tracking> tracker_;
 
     public:
 
         grid_vector() = default;
         grid_vector(this_type&& other) :
-            data_   { std::move(other.data_) },
-            width_  { other.width_           },
-            height_ { other.height_          }
+            data_    { std::move(other.data_)    },
+            width_   { other.width_              },
+            height_  { other.height_             },
+            pitch_   { other.pitch_              },
+            tracker_ { std::move(other.tracker_) }
         {
         }
 
+        /**
+        \brief Resizes the grid and keeps the previous elements at the same (x, y) coordinates.
+        \remarks New elements are value-initialized, or initialized with 'val' respectively.
+        \see resize_padded
+        */
         void resize(size_type width, size_type height)
         {
-            width_ = width;
-            height_ = height;
-            data_.resize(width*height);
+            resize_rows(width, height, width, value_type());
         }
         void resize(size_type width, size_type height, const value_type& val)
         {
-            width_ = width;
+            resize_rows(width, height, width, val);
+        }
+
+        /**
+        \brief Resizes the grid with the specified pitch, i.e. the number of elements from one row to the next.
+        \param[in] pitch Specifies the row pitch. This must be greater than or equal to 'width'. See padded_pitch.
+        \throws std::invalid_argument If 'pitch' is less than 'width'.
+        \remarks This requires the padded policy (see padded_grid_vector).
+        The previous elements keep their (x, y) coordinates. If the pitch does not grow and the storage does not exceed its capacity,
+        the rows are shuffled in place. Otherwise the storage is reallocated once and each row is copied (or moved) into the new storage.
+        */
+        void resize_padded(size_type width, size_type height, size_type pitch)
+        {
+            resize_padded(width, height, pitch, value_type());
+        }
+        void resize_padded(size_type width, size_type height, size_type pitch, const value_type& val)
+        {
+            static_assert(is_padded::value, "grid_vector requires the padded policy for padded rows");
+            check_pitch(width, pitch);
+            resize_rows(width, height, pitch, val);
+        }
+
+        /**
+        \brief Changes the width and height of the grid without moving any elements, i.e. the elements keep their order in memory.
+        \throws std::invalid_argument If the new size does not have the same number of elements, or if the rows are padded.
+        \remarks The new grid is not padded. Example: a 4x3 grid can be reshaped into a 6x2 grid, where the first row
+        contains the first row and the first half of the second row of the previous grid.
+        */
+        void reshape(size_type width, size_type height)
+        {
+            if (pitch_ != width_)
+                throw std::invalid_argument("grid_vector::reshape requires a grid without padding");
+            if (width*height != width_*height_)
+                throw std::invalid_argument("grid_vector::reshape must not change the number of elements");
+            width_  = width;
             height_ = height;
-            data_.resize(width*height, val);
+            pitch_  = width;
+
+            tracker_.resize(width_, height_);
+        }
+
+        /**
+        \brief Returns the recommended pitch for the specified width to avoid cache-set aliasing.
+        \remarks If the size of a row is a multiple of 256 bytes, the row is padded by one cache line (64 bytes).
+        Otherwise the width is returned unchanged.
+        */
+        static size_type padded_pitch(size_type width)
+        {
+            const size_type row_size = width * sizeof(value_type);
+            if (row_size > 0 && row_size % 256 == 0)
+                return width + (sizeof(value_type) < 64 ? 64 / sizeof(value_type) : 1);
+            return width;
         }
 
         size_type width() const
@@ -83,25 +176,140 @@ class grid_vector
         {
             return height_;
         }
+        //! Returns the number of elements from one row to the next (equal to the width if the rows are not padded).
+        size_type pitch() const
+        {
+            return pitch_;
+        }
 
         reference operator () (size_t x, size_t y)
         {
-            return data_[y*width()+x];
+            tracker_.mark(x, y);
+            return data_[y*pitch()+x];
         }
         const_reference operator () (size_t x, size_t y) const
         {
-            return data_[y*width()+x];
+            return data_[y*pitch()+x];
         }
 
         reference at(size_t x, size_t y)
         {
-            return data_.at(y*width()+x);
+            check_range(x, y);
+            tracker_.mark(x, y);
+            return data_[y*pitch()+x];
         }
         const_reference at(size_t x, size_t y) const
         {
-            return data_.at(y*width()+x);
+            check_range(x, y);
+            return data_[y*pitch()+x];
         }
 
+        /**
+        \brief Returns a view of the width() contiguous elements of the specified row, which are all marked as dirty.
+        \remarks The view converts implicitly to a pointer to the first element of the row.
+        */
+        row_type row(size_t y)
+        {
+            mark_dirty(0, y, width_, 1);
+            return row_type(data() + y*pitch(), width_);
+        }
+        const_row_type row(size_t y) const
+        {
+            return const_row_type(data() + y*pitch(), width_);
+        }
+
+        //! Returns a view of the height() elements of the specified column, which are pitch() elements apart and all marked as dirty.
+        column_type column(size_t x)
+        {
+            mark_dirty(x, 0, 1, height_);
+            return column_type(data() + x, height_, pitch_);
+        }
+        const_column_type column(size_t x) const
+        {
+            return const_column_type(data() + x, height_, pitch_);
+        }
+
+        /**
+        \brief Returns a range of all rows, which can be split into blocks of rows for multiple threads (see grid_rows::split).
+        \remarks All elements are marked as dirty up front, so the rows can be written concurrently.
+        \see parallel_for_each_row
+        */
+        rows_type rows()
+        {
+            return rows(0, height_);
+        }
+        const_rows_type rows() const
+        {
+            return rows(0, height_);
+        }
+
+        //! Returns a range of the rows [first, last), which are all marked as dirty.
+        rows_type rows(size_type first, size_type last)
+        {
+            mark_dirty(0, first, width_, last - first);
+            return rows_type(data(), width_, pitch_, first, last);
+        }
+        const_rows_type rows(size_type first, size_type last) const
+        {
+            return const_rows_type(data(), width_, pitch_, first, last);
+        }
+
+        /**
+        \brief Enables or disables the tracking of written elements.
+        \param[in] mode Specifies the tracking mode. dirty_tracking::none disables the tracking.
+        \param[in] tile_width Specifies the width of each tile for dirty_tracking::tiles.
+        \param[in] tile_height Specifies the height of each tile for dirty_tracking::tiles.
+        \remarks This requires the dirty_tracked policy (see tracked_grid_vector).
+        Writes are tracked through operator(), at, row, column, and rows. Writes through data() or the iterators must be reported with mark_dirty.
+        Resizing the grid marks all elements as dirty.
+        \code
+        // Example usage:
+        ext::tracked_grid_vector<int> grid;
+        grid.resize(1024, 1024);
+        grid.enable_dirty_tracking(ext::dirty_tracking::tiles, 32, 32);
+        grid(10, 20) = 1;
+        for (const auto& r : grid.dirty_regions())
+            upload(r.x, r.y, r.width, r.height); // Called for the 32x32 tile at (0, 0)
+        grid.clear_dirty();
+        \endcode
+        */
+        void enable_dirty_tracking(dirty_tracking mode, size_type tile_width = 32, size_type tile_height = 32)
+        {
+            static_assert(std::is_same<Tracking, dirty_tracked>::value, "grid_vector requires the dirty_tracked policy for dirty tracking");
+            tracker_.enable(mode, width_, height_, tile_width, tile_height);
+        }
+
+        //! Returns the current dirty tracking mode.
+        dirty_tracking dirty_tracking_mode() const
+        {
+            return tracker_.mode();
+        }
+
+        //! Marks the specified region as dirty, which is clipped to the grid. This has no effect if tracking is disabled.
+        void mark_dirty(size_type x, size_type y, size_type width, size_type height)
+        {
+            tracker_.mark({ x, y, width, height });
+        }
+
+        //! Returns true if any element has been written since the last call to clear_dirty.
+        bool is_dirty() const
+        {
+            return !tracker_.empty();
+        }
+
+        //! Returns the non-overlapping regions that have been written since the last call to clear_dirty, or an empty list if tracking is disabled.
+        std::vector<grid_region> dirty_regions() const
+        {
+            return tracker_.regions();
+        }
+
+        //! Marks all elements as clean.
+        void clear_dirty()
+        {
+            tracker_.clear();
+        }
+
+        //! Returns a pointer to the storage. Each row is followed by pitch() - width() padding elements.
         value_type* data()
         {
             return data_.data();
@@ -113,48 +321,132 @@ class grid_vector
 
         bool empty() const
         {
-            return data_.empty();
+            return (width_ == 0 || height_ == 0);
         }
 
         iterator begin()
         {
-            return data_.begin();
+            return make_iterator<iterator>(data(), 0, is_padded());
         }
         iterator end()
         {
-            return data_.end();
+            return make_iterator<iterator>(data(), width_*height_, is_padded());
         }
 
         const_iterator begin() const
         {
-            return data_.begin();
+            return make_iterator<const_iterator>(data(), 0, is_padded());
         }
         const_iterator end() const
         {
-            return data_.end();
+            return make_iterator<const_iterator>(data(), width_*height_, is_padded());
         }
 
         reverse_iterator rbegin()
         {
-            return data_.rbegin();
+            return reverse_iterator(end());
         }
         reverse_iterator rend()
         {
-            return data_.rend();
+            return reverse_iterator(begin());
         }
 
         const_reverse_iterator rbegin() const
         {
-            return data_.rbegin();
+            return const_reverse_iterator(end());
         }
         const_reverse_iterator rend() const
         {
-            return data_.rend();
+            return const_reverse_iterator(begin());
+        }
+
+    private:
+
+        // Resizes the grid with the specified pitch and keeps the previous elements at the same (x, y) coordinates.
+        void resize_rows(size_type width, size_type height, size_type pitch, const value_type& val)
+        {
+            const size_type copy_width  = std::min(width, width_);
+            const size_type copy_height = std::min(height, height_);
+            const size_type size        = pitch*height;
+
+            if (pitch <= pitch_ && size <= data_.capacity())
+            {
+                /* Shuffle rows in place: each row moves to a lower (or the same) offset, so the rows are processed front to back */
+                if (size > data_.size())
+                    data_.resize(size, val);
+                for (size_type y = 1; y < copy_height; ++y)
+                    details::move_elements(data_.data() + y*pitch_, data_.data() + y*pitch, copy_width);
+                fill_new_elements(width, height, pitch, copy_width, copy_height, val);
+                data_.resize(size);
+            }
+            else
+            {
+                /* Reallocate the storage once and move each row to its new position */
+                storage_type data(size, val, data_.get_allocator());
+                for (size_type y = 0; y < copy_height; ++y)
+                    details::move_elements(data_.data() + y*pitch_, data.data() + y*pitch, copy_width);
+                data_.swap(data);
+            }
+
+            width_  = width;
+            height_ = height;
+            pitch_  = pitch;
+
+            tracker_.resize(width_, height_);
+        }
+
+        static void check_pitch(size_type width, size_type pitch)
+        {
+            if (pitch < width)
+                throw std::invalid_argument("grid_vector pitch must not be less than its width");
+        }
+
+        // Initializes the elements after an in-place resize, which are not covered by the previous grid.
+        void fill_new_elements(size_type width, size_type height, size_type pitch, size_type copy_width, size_type copy_height, const value_type& val)
+        {
+            for (size_type y = 0; y < copy_height; ++y)
+                std::fill(data_.data() + y*pitch + copy_width, data_.data() + y*pitch + width, val);
+            for (size_type y = copy_height; y < height; ++y)
+                std::fill(data_.data() + y*pitch, data_.data() + y*pitch + width, val);
+        }
+
+        // Returns the iterator for the element with the specified (dense) index, which skips the padding of a padded grid.
+        template <typename Iterator, typename U>
+        Iterator make_iterator(U* base, size_type index, std::true_type) const
+        {
+            return Iterator(base, index, width_, pitch_);
+        }
+
+        template <typename Iterator, typename U>
+        Iterator make_iterator(U* base, size_type index, std::false_type) const
+        {
+            return base + index;
+        }
+
+        void check_range(size_t x, size_t y) const
+        {
+            if (x >= width_ || y >= height_)
+                throw std::out_of_range("grid_vector::at out of range");
         }
 
 };
 
 
+/**
+\brief grid_vector with the dirty_tracked policy.
+\see grid_vector::enable_dirty_tracking
+*/
+template <typename T, class Alloc = std::allocator<T>>
+using tracked_grid_vector = grid_vector<T, Alloc, dirty_tracked>;
+
+/**
+\brief grid_vector with the padded policy, whose rows can be padded.
+\see grid_vector::resize_padded
+*/
+template <typename T, class Alloc = std::allocator<T>>
+using padded_grid_vector = grid_vector<T, Alloc, untracked, padded>;
+
+
 } // /namespace ext
 
 
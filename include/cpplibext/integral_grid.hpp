@@ -0,0 +1,283 @@
+/*
+ * integral_grid.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_INTEGRAL_GRID_H
+#define CPPLIBEXT_INTEGRAL_GRID_H
+
+
+#include "grid_vector.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+// Default type for the sums of integral_grid: 64-bit integers for integral types, double for floating-point types.
+template <typename T>
+struct integral_sum_type
+{
+    using type = typename std::conditional<
+        std::is_integral<T>::value,
+        typename std::conditional<std::is_signed<T>::value, std::int64_t, std::uint64_t>::type,
+        typename std::conditional<std::is_floating_point<T>::value, double, T>::type
+    >::type;
+};
+
+
+} // /namespace details
+
+
+/**
+\brief Summed-area table (integral image) of a grid_vector, which answers sum, mean, and count queries over any rectangle in O(1).
+\tparam T Specifies the element type of the source grid.
+\tparam Sum Specifies the type of the sums. By default 64-bit integers for integral types and double for floating-point types.
+\remarks The table has one additional row and column of zeros at the front, so the queries do not need any branches.
+Rectangles are specified by their upper-left corner, width, and height, and they are clipped to the grid.
+\code
+// Example usage:
+ext::grid_vector<std::uint32_t> heatmap;
+heatmap.resize(4096, 4096, 0);
+ext::integral_grid<std::uint32_t> table(heatmap);
+auto hits = table.sum(100, 200, 64, 64);            // Sum of the 64x64 elements at (100, 200)
+heatmap(120, 210) += 5;
+table.update_rows(heatmap, 210, 211);               // Only row 210 is summed up again
+double avg = table.mean(-8, -8, 16, 16);            // Clipped to the 8x8 elements at (0, 0)
+\endcode
+*/
+template <typename T, typename Sum = typename details::integral_sum_type<T>::type>
+class integral_grid
+{
+
+    public:
+
+        using value_type    = T;
+        using sum_type      = Sum;
+        using size_type     = std::size_t;
+
+        //! Signed type of the query coordinates.
+        using coord_type    = std::ptrdiff_t;
+
+        integral_grid() = default;
+
+        //! Builds the table for the specified grid. \see build
+        template <class Alloc, class Tracking, class Padding>
+        explicit integral_grid(const grid_vector<T, Alloc, Tracking, Padding>& grid)
+        {
+            build(grid);
+        }
+
+        //! Builds the table for the specified grid in a single pass.
+        template <class Alloc, class Tracking, class Padding>
+        void build(const grid_vector<T, Alloc, Tracking, Padding>& grid)
+        {
+            reset(grid.width(), grid.height());
+            for (size_type y = 0; y < height_; ++y)
+                build_row(grid, y);
+        }
+
+        /**
+        \brief Builds the table for the specified grid in parallel: first the prefix sums of the rows, then the sums down the columns.
+        \remarks The sums are accumulated in the same order as with the single-pass build, so the results are identical.
+        */
+        template <class Alloc, class Tracking, class Padding>
+        void build(thread_pool& pool, const grid_vector<T, Alloc, Tracking, Padding>& grid)
+        {
+            reset(grid.width(), grid.height());
+
+            const size_type stride = width_ + 1;
+
+            /* Prefix sums of each row */
+            const auto rows = grid.rows();
+            const size_type row_chunks = std::min(height_, pool.concurrency() * 4);
+            pool.run(
+                row_chunks,
+                [&](size_type chunk)
+                {
+                    const auto block = rows.split(chunk, row_chunks);
+                    for (auto it = block.begin(), end = block.end(); it != end; ++it)
+                    {
+                        sum_type* dst = table_.data() + (it.y() + 1)*stride + 1;
+                        sum_type value = sum_type();
+                        for (const auto& x : *it)
+                            *dst++ = (value += static_cast<sum_type>(x));
+                    }
+                }
+            );
+
+            /* Sums down each column, where each chunk processes a block of adjacent columns row by row */
+            const size_type column_chunks = std::min(width_, pool.concurrency() * 4);
+            pool.run(
+                column_chunks,
+                [&](size_type chunk)
+                {
+                    const size_type first = 1 + width_ * chunk / column_chunks;
+                    const size_type last  = 1 + width_ * (chunk + 1) / column_chunks;
+                    for (size_type y = 2; y <= height_; ++y)
+                    {
+                        sum_type* dst = table_.data() + y*stride;
+                        const sum_type* src = dst - stride;
+                        for (size_type x = first; x < last; ++x)
+                            dst[x] += src[x];
+                    }
+                }
+            );
+        }
+
+        /**
+        \brief Updates the table after the rows [first, last) of the grid have been modified.
+        \remarks Only the dirty rows are summed up again. The rows below are corrected by the difference of the last dirty row,
+        which does not read the grid. Floating-point sums may differ slightly from a full rebuild.
+        \throws std::invalid_argument If the grid does not have the same size as the table.
+        \throws std::out_of_range If the row range is invalid.
+        */
+        template <class Alloc, class Tracking, class Padding>
+        void update_rows(const grid_vector<T, Alloc, Tracking, Padding>& grid, size_type first, size_type last)
+        {
+            if (grid.width() != width_ || grid.height() != height_)
+                throw std::invalid_argument("integral_grid::update_rows grid size does not match the table");
+            if (first > last || last > height_)
+                throw std::out_of_range("integral_grid::update_rows row range out of range");
+            if (first == last)
+                return;
+
+            const size_type stride = width_ + 1;
+
+            /* Remember the cumulative sums through the last dirty row */
+            std::vector<sum_type> delta(table_.begin() + last*stride, table_.begin() + (last + 1)*stride);
+
+            for (size_type y = first; y < last; ++y)
+                build_row(grid, y);
+
+            /* Shift all rows below by the difference */
+            if (last < height_)
+            {
+                const sum_type* row = table_.data() + last*stride;
+                for (size_type x = 1; x < stride; ++x)
+                    delta[x] = row[x] - delta[x];
+                for (size_type y = last + 1; y <= height_; ++y)
+                {
+                    sum_type* dst = table_.data() + y*stride;
+                    for (size_type x = 1; x < stride; ++x)
+                        dst[x] += delta[x];
+                }
+            }
+        }
+
+        size_type width() const
+        {
+            return width_;
+        }
+
+        size_type height() const
+        {
+            return height_;
+        }
+
+        //! Returns the sum of all elements in the rectangle, which is clipped to the grid.
+        sum_type sum(coord_type x, coord_type y, coord_type width, coord_type height) const
+        {
+            size_type x0, x1, y0, y1;
+            if (!clip(x, width, width_, x0, x1) || !clip(y, height, height_, y0, y1))
+                return sum_type();
+
+            const size_type stride = width_ + 1;
+            const sum_type* top = table_.data() + y0*stride;
+            const sum_type* bottom = table_.data() + y1*stride;
+
+            return ((bottom[x1] + top[x0]) - (bottom[x0] + top[x1]));
+        }
+
+        //! Returns the sum of all elements in the grid.
+        sum_type sum() const
+        {
+            return (table_.empty() ? sum_type() : table_.back());
+        }
+
+        //! Returns the number of elements in the rectangle, which is clipped to the grid.
+        size_type count(coord_type x, coord_type y, coord_type width, coord_type height) const
+        {
+            size_type x0, x1, y0, y1;
+            if (!clip(x, width, width_, x0, x1) || !clip(y, height, height_, y0, y1))
+                return 0;
+            return (x1 - x0) * (y1 - y0);
+        }
+
+        //! Returns the mean value of the elements in the rectangle, which is clipped to the grid, or 0 if the rectangle is empty.
+        double mean(coord_type x, coord_type y, coord_type width, coord_type height) const
+        {
+            const auto n = count(x, y, width, height);
+            return (n > 0 ? static_cast<double>(sum(x, y, width, height)) / static_cast<double>(n) : 0.0);
+        }
+
+    private:
+
+        void reset(size_type width, size_type height)
+        {
+            width_  = width;
+            height_ = height;
+            table_.assign((width + 1) * (height + 1), sum_type());
+        }
+
+        // Sums up the specified row of the grid onto the previous row of the table.
+        template <class Alloc, class Tracking, class Padding>
+        void build_row(const grid_vector<T, Alloc, Tracking, Padding>& grid, size_type y)
+        {
+            const size_type stride = width_ + 1;
+            const T* src = grid.row(y);
+            const sum_type* prev = table_.data() + y*stride + 1;
+            sum_type* dst = table_.data() + (y + 1)*stride + 1;
+            sum_type value = sum_type();
+            for (size_type x = 0; x < width_; ++x)
+            {
+                value += static_cast<sum_type>(src[x]);
+                dst[x] = value + prev[x];
+            }
+        }
+
+        // Clips the interval [pos, pos + size) to [0, extent) and returns false if it is empty.
+        static bool clip(coord_type pos, coord_type size, size_type extent, size_type& first, size_type& last)
+        {
+            const auto lower = std::max<coord_type>(pos, 0);
+            const auto upper = std::min<coord_type>(pos + size, static_cast<coord_type>(extent));
+            if (lower >= upper)
+                return false;
+            first = static_cast<size_type>(lower);
+            last  = static_cast<size_type>(upper);
+            return true;
+        }
+
+    private:
+
+        std::vector<sum_type>   table_;
+        size_type               width_  = 0;
+        size_type               height_ = 0;
+
+};
+
+
+} // /namespace ext
+
+
+#endif
+
+
+
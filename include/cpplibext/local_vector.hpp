@@ -12,24 +12,37 @@
 #define CPPLIBEXT_LOCAL_VECTOR_H
 
 
+#include "details/slice_copy.hpp"
+
 #include <iterator>
 #include <algorithm>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
 #include <utility>
 #include <new>
+#include <cstring>
 
 
 namespace ext
 {
 
 
+/**
+\brief Vector with a fixed capacity of N elements, which are stored locally (e.g. on the stack) instead of the heap.
+\remarks The elements are stored in uninitialized storage: they are only constructed when they are inserted and they are destroyed when they are removed.
+So creating an empty local_vector does not construct any elements, even for non-trivial types like std::string.
+Trivially copyable types are copied, shifted, and filled with memcpy, memmove, and memset. Other types are moved instead of copied wherever possible.
+\throws std::bad_alloc If an insertion exceeds the capacity.
+*/
 template <typename T, std::size_t N>
 class local_vector
 {
-    
+
         static_assert(N > 0, "size of local_vector must be greater than zero");
-    
+
     public:
-    
+
         using value_type                = T;
         using size_type                 = std::size_t;
         using difference_type           = std::ptrdiff_t;
@@ -41,226 +54,510 @@ class local_vector
         using const_iterator            = const_pointer;
         using reverse_iterator          = std::reverse_iterator<iterator>;
         using const_reverse_iterator    = std::reverse_iterator<const_iterator>;
-    
+
     public:
-    
+
         local_vector() = default;
-    
-        explicit local_vector(size_type count) :
-            size_ { count }
+
+        explicit local_vector(size_type count)
         {
+            resize(count);
         }
-    
-        explicit local_vector(size_type count, const value_type& value) :
-            size_ { count }
+
+        explicit local_vector(size_type count, const value_type& value)
         {
-            std::fill(std::begin(data_), std::begin(data_) + count, value);
+            resize(count, value);
         }
-    
-        local_vector(const local_vector& other) :
-            size_ { other.size() }
+
+        local_vector(const local_vector& other)
         {
-            std::copy(other.begin(), other.end(), begin());
+            append(other.begin(), other.end());
         }
-    
-        local_vector(std::initializer_list<T> init) :
-            size_ { init.size() }
+
+        local_vector(local_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value)
         {
-            std::copy(init.begin(), init.end(), begin());
+            append_moved(other.begin(), other.end(), is_trivial());
+            other.clear();
         }
-    
+
+        local_vector(std::initializer_list<T> init)
+        {
+            append(init.begin(), init.end());
+        }
+
+        template <typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+        local_vector(InputIt first, InputIt last)
+        {
+            append(first, last);
+        }
+
+        ~local_vector()
+        {
+            clear();
+        }
+
+        local_vector& operator = (const local_vector& rhs)
+        {
+            if (this != &rhs)
+            {
+                clear();
+                append(rhs.begin(), rhs.end());
+            }
+            return *this;
+        }
+
+        local_vector& operator = (local_vector&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value)
+        {
+            if (this != &rhs)
+            {
+                clear();
+                append_moved(rhs.begin(), rhs.end(), is_trivial());
+                rhs.clear();
+            }
+            return *this;
+        }
+
+        local_vector& operator = (std::initializer_list<T> init)
+        {
+            assign(init.begin(), init.end());
+            return *this;
+        }
+
+        //! Replaces the elements with 'count' copies of 'value'.
+        void assign(size_type count, const value_type& value)
+        {
+            if (count > N)
+                throw std::bad_alloc();
+            value_type copy(value);
+            clear();
+            resize(count, copy);
+        }
+
+        //! Replaces the elements with copies of the elements [first, last), which must not refer to this vector.
+        template <typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+        void assign(InputIt first, InputIt last)
+        {
+            clear();
+            append(first, last);
+        }
+
+        void assign(std::initializer_list<T> init)
+        {
+            assign(init.begin(), init.end());
+        }
+
         /* ----- Element access ----- */
-    
+
         reference front() noexcept
         {
-            return data_[0];
+            return data()[0];
         }
-    
+
         const_reference front() const noexcept
         {
-            return data_[0];
+            return data()[0];
         }
-    
+
         reference back() noexcept
         {
-            return data_[size_ - 1];
+            return data()[size_ - 1];
         }
-    
+
         const_reference back() const noexcept
         {
-            return data_[size_ - 1];
+            return data()[size_ - 1];
         }
 
         pointer data() noexcept
         {
-            return data_;
+            return reinterpret_cast<pointer>(storage_);
+        }
+
+        const_pointer data() const noexcept
+        {
+            return reinterpret_cast<const_pointer>(storage_);
         }
-    
+
         /* ----- Iterators ----- */
-    
+
         iterator begin() noexcept
         {
-            return data_;
+            return data();
         }
-    
+
         const_iterator begin() const noexcept
         {
-            return data_;
+            return data();
         }
-    
+
         const_iterator cbegin() const noexcept
         {
-            return data_;
+            return data();
         }
-    
+
         iterator end() noexcept
         {
-            return data_ + size_;
+            return data() + size_;
         }
-    
+
         const_iterator end() const noexcept
         {
-            return data_ + size_;
+            return data() + size_;
         }
-    
+
         const_iterator cend() const noexcept
         {
-            return data_ + size_;
+            return data() + size_;
         }
-    
+
         reverse_iterator rbegin() noexcept
         {
             return reverse_iterator { end() };
         }
-    
+
         const_reverse_iterator rbegin() const noexcept
         {
             return const_reverse_iterator { end() };
         }
-    
+
         const_reverse_iterator crbegin() const noexcept
         {
             return const_reverse_iterator { cend() };
         }
-    
+
         reverse_iterator rend() noexcept
         {
             return reverse_iterator { begin() };
         }
-    
+
         const_reverse_iterator rend() const noexcept
         {
             return const_reverse_iterator { begin() };
         }
-    
+
         const_reverse_iterator crend() const noexcept
         {
             return const_reverse_iterator { cbegin() };
         }
 
         /* ----- Capacity ----- */
-    
+
         constexpr bool empty() const noexcept
         {
             return (size_ == 0);
         }
-    
+
         constexpr size_type size() const noexcept
         {
             return size_;
         }
-    
+
         constexpr size_type max_size() const noexcept
         {
             return N;
         }
-    
+
         void reserve(size_type new_cap)
         {
             if (new_cap > N)
                 throw std::bad_alloc();
         }
-    
+
         constexpr size_type capacity() const noexcept
         {
             return N;
         }
-    
+
         /* ----- Modifiers ----- */
-    
+
+        //! Destroys all elements.
         void clear()
         {
+            destroy(begin(), end());
             size_ = 0;
         }
-    
+
         iterator insert(const_iterator pos, const value_type& value)
+        {
+            return emplace(pos, value);
+        }
+
+        iterator insert(const_iterator pos, value_type&& value)
+        {
+            return emplace(pos, std::move(value));
+        }
+
+        /**
+        \brief Inserts copies of the elements [first, last) in front of 'pos' and returns an iterator to the first inserted element.
+        \remarks The range must not refer to this vector. For forward iterators, the capacity is checked before any element is inserted.
+        \throws std::bad_alloc If the elements exceed the capacity.
+        */
+        template <typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+        iterator insert(const_iterator pos, InputIt first, InputIt last)
+        {
+            const auto index = static_cast<size_type>(pos - begin());
+            insert_range(index, first, last, typename std::iterator_traits<InputIt>::iterator_category());
+            return begin() + index;
+        }
+
+        iterator insert(const_iterator pos, std::initializer_list<T> init)
+        {
+            return insert(pos, init.begin(), init.end());
+        }
+
+        /**
+        \brief Constructs a new element in front of 'pos' and returns an iterator to the new element.
+        \remarks The elements after 'pos' are moved one position to the right.
+        */
+        template <typename... Args>
+        iterator emplace(const_iterator pos, Args&&... args)
         {
             assert_free_space();
-            auto diff = pos - begin();
-            
-            /* Move everything after 'pos' to its right */
-            for (size_type i = size(); i > diff; --i)
-                data_[i] = data_[i - 1];
-            
-            /* Insert new element */
-            data_[diff] = value;
-            
-            ++size_;
-            
-            return begin() + diff;
-        }
-    
-        #if 0 //TODO
-        void emplace();
-        void erase();
-        #endif
-    
+            const auto index = pos - begin();
+
+            if (pos == end())
+                emplace_back(std::forward<Args>(args)...);
+            else
+            {
+                /* Construct the element first, since the arguments might refer to elements of this vector */
+                value_type value(std::forward<Args>(args)...);
+                insert_shifted(static_cast<size_type>(index), std::move(value), is_trivial());
+            }
+
+            return begin() + index;
+        }
+
+        //! Removes the element at 'pos' and returns an iterator to the element after it.
+        iterator erase(const_iterator pos)
+        {
+            return erase(pos, pos + 1);
+        }
+
+        //! Removes the elements [first, last) and returns an iterator to the element after them.
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            auto dst = begin() + (first - begin());
+            if (first != last)
+            {
+                auto src = begin() + (last - begin());
+                auto new_end = dst + (end() - src);
+                details::move_elements(src, dst, static_cast<size_type>(end() - src));
+                destroy(new_end, end());
+                size_ = static_cast<size_type>(new_end - begin());
+            }
+            return dst;
+        }
+
+        void push_back(const value_type& value)
+        {
+            emplace_back(value);
+        }
+
         void push_back(value_type&& value)
+        {
+            emplace_back(std::move(value));
+        }
+
+        //! Constructs a new element at the end and returns a reference to it.
+        template <typename... Args>
+        reference emplace_back(Args&&... args)
         {
             assert_free_space();
-            data_[size_++] = std::forward<T>(value);
+            ::new (static_cast<void*>(end())) value_type(std::forward<Args>(args)...);
+            ++size_;
+            return back();
         }
-    
-        #if 0 //TODO
-        void emplace_back();
-        #endif
-    
+
         void pop_back()
         {
             --size_;
+            end()->~value_type();
         }
-    
+
         void resize(size_type count)
         {
             if (count > N)
                 throw std::bad_alloc();
-            for (auto i = size_; i < count; ++i)
-                data_[i] = T();
-            size_ = count;
+            if (count < size_)
+                shrink(count);
+            else
+                grow(count, is_trivial());
         }
-    
+
         void resize(size_type count, const value_type& value)
         {
             if (count > N)
                 throw std::bad_alloc();
-            for (auto i = size_; i < count; ++i)
-                data_[i] = value;
-            size_ = count;
+            if (count < size_)
+                shrink(count);
+            else
+                fill_back(count - size_, value, is_trivial());
         }
-    
+
     private:
-    
+
         void assert_free_space()
         {
             if (size() == max_size())
                 throw std::bad_alloc();
         }
-    
+
+        // Specifies whether the elements can be copied, shifted, and filled as raw memory.
+        using is_trivial = std::integral_constant<bool, std::is_trivially_copyable<value_type>::value>;
+
+        // Constructs copies of the elements [first, last) at the end. If an exception is thrown, all elements are destroyed.
+        template <typename InputIt>
+        void append(InputIt first, InputIt last)
+        {
+            try
+            {
+                append_range(first, last, typename std::iterator_traits<InputIt>::iterator_category());
+            }
+            catch (...)
+            {
+                clear();
+                throw;
+            }
+        }
+
+        template <typename InputIt>
+        void append_range(InputIt first, InputIt last, std::input_iterator_tag)
+        {
+            for (; first != last; ++first)
+                emplace_back(*first);
+        }
+
+        // Checks the capacity up front, so the elements can be constructed without checking the capacity each time (memcpy for pointers to trivial types).
+        template <typename ForwardIt>
+        void append_range(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+        {
+            const auto count = static_cast<size_type>(std::distance(first, last));
+            if (count > N - size_)
+                throw std::bad_alloc();
+            std::uninitialized_copy(first, last, end());
+            size_ += count;
+        }
+
+        void append_moved(iterator first, iterator last, std::true_type)
+        {
+            append_range(first, last, std::random_access_iterator_tag());
+        }
+
+        void append_moved(iterator first, iterator last, std::false_type)
+        {
+            append(std::make_move_iterator(first), std::make_move_iterator(last));
+        }
+
+        // Inserts the value at 'index' < size() by shifting the elements behind it with a single memmove.
+        void insert_shifted(size_type index, value_type&& value, std::true_type)
+        {
+            details::move_elements(begin() + index, begin() + index + 1, size_ - index, std::true_type());
+            ::new (static_cast<void*>(begin() + index)) value_type(std::move(value));
+            ++size_;
+        }
+
+        // Inserts the value at 'index' < size() by moving the last element into the uninitialized storage, and everything after 'index' to its right.
+        void insert_shifted(size_type index, value_type&& value, std::false_type)
+        {
+            ::new (static_cast<void*>(end())) value_type(std::move(back()));
+            ++size_;
+            std::move_backward(begin() + index, end() - 2, end() - 1);
+            begin()[index] = std::move(value);
+        }
+
+        // Inserts the elements of an input range at the end and rotates them into place, which only moves the previous elements.
+        template <typename InputIt>
+        void insert_range(size_type index, InputIt first, InputIt last, std::input_iterator_tag)
+        {
+            const auto old_size = size_;
+            try
+            {
+                append_range(first, last, typename std::iterator_traits<InputIt>::iterator_category());
+            }
+            catch (...)
+            {
+                shrink(old_size);
+                throw;
+            }
+            std::rotate(begin() + index, begin() + old_size, end());
+        }
+
+        // Inserts the elements of a forward range of trivial types with a single memmove of the elements behind 'index'.
+        template <typename ForwardIt>
+        void insert_range(size_type index, ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+        {
+            insert_forward_range(index, first, last, is_trivial());
+        }
+
+        template <typename ForwardIt>
+        void insert_forward_range(size_type index, ForwardIt first, ForwardIt last, std::true_type)
+        {
+            const auto count = static_cast<size_type>(std::distance(first, last));
+            if (count > N - size_)
+                throw std::bad_alloc();
+            details::move_elements(begin() + index, begin() + index + count, size_ - index, std::true_type());
+            std::uninitialized_copy(first, last, begin() + index);
+            size_ += count;
+        }
+
+        template <typename ForwardIt>
+        void insert_forward_range(size_type index, ForwardIt first, ForwardIt last, std::false_type)
+        {
+            insert_range(index, first, last, std::input_iterator_tag());
+        }
+
+        // Destroys the elements [count, size()).
+        void shrink(size_type count)
+        {
+            destroy(begin() + count, end());
+            size_ = count;
+        }
+
+        // Appends value-initialized elements up to 'count' elements. For trivial types, this is a copy of a value-initialized element.
+        void grow(size_type count, std::true_type)
+        {
+            fill_back(count - size_, value_type(), std::true_type());
+        }
+
+        void grow(size_type count, std::false_type)
+        {
+            while (size_ < count)
+                emplace_back();
+        }
+
+        // Appends 'count' copies of 'value' with memset if all bytes of the value are equal (e.g. zero).
+        void fill_back(size_type count, const value_type& value, std::true_type)
+        {
+            const auto bytes = reinterpret_cast<const unsigned char*>(&value);
+            if (std::all_of(bytes + 1, bytes + sizeof(value_type), [bytes](unsigned char b) { return (b == bytes[0]); }))
+                std::memset(static_cast<void*>(end()), bytes[0], count * sizeof(value_type));
+            else
+                std::uninitialized_fill_n(end(), count, value);
+            size_ += count;
+        }
+
+        void fill_back(size_type count, const value_type& value, std::false_type)
+        {
+            for (; count > 0; --count)
+                emplace_back(value);
+        }
+
+        static void destroy(iterator first, iterator last)
+        {
+            if (!std::is_trivially_destructible<value_type>::value)
+            {
+                for (; first != last; ++first)
+                    first->~value_type();
+            }
+        }
+
     private:
-    
-        std::size_t size_       = 0;
-        T           data_[N];
-    
+
+        using storage_type = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+        std::size_t     size_       = 0;
+        storage_type    storage_[N];
+
 };
 
 
@@ -270,3 +567,4 @@ class local_vector
 #endif
 
 
+
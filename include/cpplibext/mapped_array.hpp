@@ -0,0 +1,463 @@
+/*
+ * mapped_array.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_MAPPED_ARRAY_H
+#define CPPLIBEXT_MAPPED_ARRAY_H
+
+
+#include "multi_array.hpp"
+#include "multi_array_view.hpp"
+#include "grid_vector.hpp"
+#include "details/mapped_file.hpp"
+
+#include <fstream>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+/*
+Binary array file format:
+the 128 bytes header below is followed by the elements in row-major order, starting at 'data_offset' (a multiple of 64 bytes).
+All header fields and elements are stored in the byte order of the machine that wrote the file.
+*/
+
+static const std::uint32_t array_file_version       = 1;
+static const std::uint32_t array_file_byte_order    = 0x01020304;
+static const std::uint32_t array_file_max_rank      = 8;
+
+struct array_file_header
+{
+    char            magic[4];                           // "CLXA"
+    std::uint32_t   version;                            // array_file_version
+    std::uint32_t   byte_order;                         // array_file_byte_order in the byte order of the writer
+    std::uint32_t   element_type;                       // array_file_type<T>::value
+    std::uint32_t   element_size;                       // sizeof(T)
+    std::uint32_t   rank;                               // number of dimensions
+    std::uint64_t   data_offset;                        // offset of the first element (in bytes)
+    std::uint64_t   extents[array_file_max_rank];       // extents of all dimensions, outermost first
+    std::uint8_t    reserved[32];
+};
+
+static_assert(sizeof(array_file_header) == 128, "array_file_header must be 128 bytes");
+
+// Element type identifiers of the array file format.
+template <typename T>
+struct array_file_type;
+
+#define CPPLIBEXT_DEF_ARRAY_FILE_TYPE(TYPE, ID)  \
+    template <>                                 \
+    struct array_file_type<TYPE>                \
+    {                                           \
+        static const std::uint32_t value = ID;  \
+    }
+
+CPPLIBEXT_DEF_ARRAY_FILE_TYPE(std::int8_t,      1);
+CPPLIBEXT_DEF_ARRAY_FILE_TYPE(std::uint8_t,     2);
+CPPLIBEXT_DEF_ARRAY_FILE_TYPE(std::int16_t,     3);
+CPPLIBEXT_DEF_ARRAY_FILE_TYPE(std::uint16_t,    4);
+CPPLIBEXT_DEF_ARRAY_FILE_TYPE(std::int32_t,     5);
+CPPLIBEXT_DEF_ARRAY_FILE_TYPE(std::uint32_t,    6);
+CPPLIBEXT_DEF_ARRAY_FILE_TYPE(std::int64_t,     7);
+CPPLIBEXT_DEF_ARRAY_FILE_TYPE(std::uint64_t,    8);
+CPPLIBEXT_DEF_ARRAY_FILE_TYPE(float,            9);
+CPPLIBEXT_DEF_ARRAY_FILE_TYPE(double,           10);
+
+#undef CPPLIBEXT_DEF_ARRAY_FILE_TYPE
+
+// Writes the header and the elements, where the rows of the innermost dimension are 'row_pitch' elements apart in memory.
+template <typename T>
+void save_array_file(const std::string& filename, const T* data, const std::uint64_t* extents, std::uint32_t rank, std::uint64_t row_pitch)
+{
+    array_file_header header;
+    std::memset(&header, 0, sizeof(header));
+
+    std::memcpy(header.magic, "CLXA", 4);
+    header.version      = array_file_version;
+    header.byte_order   = array_file_byte_order;
+    header.element_type = array_file_type<T>::value;
+    header.element_size = sizeof(T);
+    header.rank         = rank;
+    header.data_offset  = sizeof(header);
+
+    std::uint64_t num_elements = 1;
+    for (std::uint32_t i = 0; i < rank; ++i)
+    {
+        header.extents[i] = extents[i];
+        num_elements *= extents[i];
+    }
+
+    std::ofstream file(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("failed to open array file for writing: " + filename);
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    const std::uint64_t row_size = (rank > 0 ? extents[rank - 1] : 1);
+    if (row_pitch == row_size || row_size == 0)
+        file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(num_elements * sizeof(T)));
+    else
+    {
+        /* Skip the padding after each row */
+        for (std::uint64_t offset = 0, n = num_elements / row_size; n > 0; --n, offset += row_pitch)
+            file.write(reinterpret_cast<const char*>(data + offset), static_cast<std::streamsize>(row_size * sizeof(T)));
+    }
+
+    if (!file)
+        throw std::runtime_error("failed to write array file: " + filename);
+}
+
+// Validates the header of a mapped array file and returns it. Throws std::runtime_error if the file does not contain an array of type T with the specified rank.
+template <typename T>
+const array_file_header& validate_array_file(const mapped_file& file, std::uint32_t rank)
+{
+    if (file.size() < sizeof(array_file_header))
+        throw std::runtime_error("array file is too small for its header");
+
+    const auto& header = *reinterpret_cast<const array_file_header*>(file.data());
+
+    if (std::memcmp(header.magic, "CLXA", 4) != 0)
+        throw std::runtime_error("array file has invalid magic number");
+    if (header.byte_order != array_file_byte_order)
+        throw std::runtime_error("array file has different byte order");
+    if (header.version != array_file_version)
+        throw std::runtime_error("array file has unsupported version");
+    if (header.element_type != array_file_type<T>::value || header.element_size != sizeof(T))
+        throw std::runtime_error("array file has different element type");
+    if (header.rank != rank)
+        throw std::runtime_error("array file has different number of dimensions");
+    if (header.data_offset % alignof(T) != 0)
+        throw std::runtime_error("array file has misaligned elements");
+
+    if (header.data_offset > file.size())
+        throw std::runtime_error("array file is too small for its elements");
+
+    /* Check each extent by division, so the untrusted extents can not overflow the number of elements */
+    const std::uint64_t max_elements = (file.size() - header.data_offset) / sizeof(T);
+    std::uint64_t num_elements = 1;
+    for (std::uint32_t i = 0; i < rank; ++i)
+    {
+        if (header.extents[i] != 0 && num_elements > max_elements / header.extents[i])
+            throw std::runtime_error("array file is too small for its elements");
+        num_elements *= header.extents[i];
+    }
+
+    return header;
+}
+
+
+} // /namespace details
+
+
+/**
+\brief Saves the multi_array to a binary array file, which can be memory mapped with mapped_multi_array_view.
+\throws std::runtime_error If the file can not be written.
+\remarks The array must have row_major_layout. The file is written in the byte order of this machine.
+*/
+template <typename T, class Storage, class Layout, std::size_t... Dimensions>
+void save(const std::string& filename, const basic_multi_array<T, Storage, Layout, Dimensions...>& ary)
+{
+    static_assert(basic_multi_array<T, Storage, Layout, Dimensions...>::layout_mapping::is_row_major, "array files require row_major_layout");
+    static_assert(sizeof...(Dimensions) <= details::array_file_max_rank, "too many dimensions for array file");
+    const std::uint64_t extents[] = { Dimensions... };
+    details::save_array_file(filename, ary.data(), extents, sizeof...(Dimensions), extents[sizeof...(Dimensions) - 1]);
+}
+
+/**
+\brief Saves the grid_vector to a binary array file, which can be memory mapped with mapped_grid_view.
+\remarks The grid is stored as 2-dimensional array with the extents { height, width }. The padding of the rows is not stored.
+*/
+template <typename T, class Alloc, class Tracking, class Padding>
+void save(const std::string& filename, const grid_vector<T, Alloc, Tracking, Padding>& grid)
+{
+    const std::uint64_t extents[] = { grid.height(), grid.width() };
+    details::save_array_file(filename, grid.data(), extents, 2, grid.pitch());
+}
+
+
+/**
+\brief Read-only view of a multi_array in a memory mapped array file.
+\remarks The elements are not copied, so opening a file only takes as long as the page faults of the elements that are accessed.
+\code
+// Example usage:
+ext::multi_array<float, 64, 64, 32> volume;
+ext::save("volume.bin", volume);
+
+ext::mapped_multi_array_view<float, 64, 64, 32> mapped("volume.bin");
+float x = mapped(1, 2, 3);
+\endcode
+\see save
+*/
+template <typename T, std::size_t... Dimensions>
+class mapped_multi_array_view
+{
+
+    public:
+
+        static_assert(sizeof...(Dimensions) > 0, "mapped_multi_array_view must have at least 1 dimension");
+
+        using value_type        = T;
+        using size_type         = std::size_t;
+        using difference_type   = std::ptrdiff_t;
+        using const_reference   = const value_type&;
+        using const_pointer     = const value_type*;
+        using const_iterator    = const_pointer;
+
+        //! Type of the array with the same layout.
+        using array_type        = multi_array<T, Dimensions...>;
+
+        //! Type of the strided view onto the elements.
+        using view_type         = multi_array_view<const T, sizeof...(Dimensions)>;
+
+        static const size_type num_dimensions   = sizeof...(Dimensions);
+        static const size_type num_elements     = array_type::num_elements;
+
+        mapped_multi_array_view() = default;
+
+        /**
+        \brief Maps the specified array file into memory.
+        \throws std::runtime_error If the file can not be mapped, or the element type or the extents of the file do not match.
+        */
+        explicit mapped_multi_array_view(const std::string& filename) :
+            file_ { filename }
+        {
+            const auto& header = details::validate_array_file<T>(file_, num_dimensions);
+
+            const std::uint64_t extents[] = { Dimensions... };
+            for (size_type i = 0; i < num_dimensions; ++i)
+            {
+                if (header.extents[i] != extents[i])
+                    throw std::runtime_error("array file has different extents: " + filename);
+            }
+
+            data_ = reinterpret_cast<const_pointer>(static_cast<const char*>(file_.data()) + header.data_offset);
+        }
+
+        mapped_multi_array_view(mapped_multi_array_view&& rhs) :
+            file_ { std::move(rhs.file_) },
+            data_ { rhs.data_            }
+        {
+            rhs.data_ = nullptr;
+        }
+
+        mapped_multi_array_view& operator = (mapped_multi_array_view&& rhs)
+        {
+            if (this != &rhs)
+            {
+                file_       = std::move(rhs.file_);
+                data_       = rhs.data_;
+                rhs.data_   = nullptr;
+            }
+            return *this;
+        }
+
+        const_pointer data() const
+        {
+            return data_;
+        }
+
+        size_type size() const
+        {
+            return (data_ != nullptr ? num_elements : 0);
+        }
+
+        bool empty() const
+        {
+            return (size() == 0);
+        }
+
+        const_iterator begin() const
+        {
+            return data_;
+        }
+
+        const_iterator end() const
+        {
+            return data_ + size();
+        }
+
+        template <size_type DimensionIndex>
+        size_type slices() const
+        {
+            static_assert(DimensionIndex < num_dimensions, "mapped_multi_array_view::slice out of range");
+            return details::select<size_type, DimensionIndex, Dimensions...>::value;
+        }
+
+        //! Returns a strided view onto the elements, e.g. to create sub-boxes or transposes.
+        view_type view() const
+        {
+            return view_type(data_, {{ Dimensions... }});
+        }
+
+        //! Returns the slice at the specified index, which is either a view with one dimension less or a reference for 1-dimensional arrays.
+        typename view_type::subscript_type operator [] (size_type index) const
+        {
+            return view()[index];
+        }
+
+        //! \see basic_multi_array::operator()(Indices...)
+        template <typename... Indices>
+        const_reference operator () (Indices... indices) const
+        {
+            static_assert(sizeof...(Indices) == num_dimensions, "number of indices does not match the number of mapped_multi_array_view dimensions");
+            return data_[array_type::flat_index(indices...)];
+        }
+
+        //! \see basic_multi_array::at(Indices...)
+        template <typename... Indices>
+        const_reference at(Indices... indices) const
+        {
+            static_assert(sizeof...(Indices) == num_dimensions, "number of indices does not match the number of mapped_multi_array_view dimensions");
+            if (data_ == nullptr || !details::flat_index<typename array_type::layout_mapping, 0, Dimensions...>::in_range(indices...))
+                throw std::out_of_range("mapped_multi_array_view::at out of range");
+            return data_[array_type::flat_index(indices...)];
+        }
+
+    private:
+
+        details::mapped_file    file_;
+        const_pointer           data_   = nullptr;
+
+};
+
+
+/**
+\brief Read-only view of a grid_vector in a memory mapped array file.
+\remarks This provides the same read-only accessors as grid_vector.
+\see save
+*/
+template <typename T>
+class mapped_grid_view
+{
+
+    public:
+
+        using value_type        = T;
+        using size_type         = std::size_t;
+        using difference_type   = std::ptrdiff_t;
+        using const_reference   = const value_type&;
+        using const_pointer     = const value_type*;
+        using const_iterator    = const_pointer;
+
+        mapped_grid_view() = default;
+
+        /**
+        \brief Maps the specified array file into memory.
+        \throws std::runtime_error If the file can not be mapped, or it does not contain a 2-dimensional array of type T.
+        */
+        explicit mapped_grid_view(const std::string& filename) :
+            file_ { filename }
+        {
+            const auto& header = details::validate_array_file<T>(file_, 2);
+            height_ = static_cast<size_type>(header.extents[0]);
+            width_  = static_cast<size_type>(header.extents[1]);
+            data_   = reinterpret_cast<const_pointer>(static_cast<const char*>(file_.data()) + header.data_offset);
+        }
+
+        mapped_grid_view(mapped_grid_view&& rhs) :
+            file_   { std::move(rhs.file_) },
+            data_   { rhs.data_            },
+            width_  { rhs.width_           },
+            height_ { rhs.height_          }
+        {
+            rhs.data_   = nullptr;
+            rhs.width_  = 0;
+            rhs.height_ = 0;
+        }
+
+        mapped_grid_view& operator = (mapped_grid_view&& rhs)
+        {
+            if (this != &rhs)
+            {
+                file_       = std::move(rhs.file_);
+                data_       = rhs.data_;
+                width_      = rhs.width_;
+                height_     = rhs.height_;
+                rhs.data_   = nullptr;
+                rhs.width_  = 0;
+                rhs.height_ = 0;
+            }
+            return *this;
+        }
+
+        size_type width() const
+        {
+            return width_;
+        }
+        size_type height() const
+        {
+            return height_;
+        }
+
+        const_reference operator () (size_type x, size_type y) const
+        {
+            return data_[y*width_ + x];
+        }
+
+        const_reference at(size_type x, size_type y) const
+        {
+            if (x >= width_ || y >= height_)
+                throw std::out_of_range("mapped_grid_view::at out of range");
+            return data_[y*width_ + x];
+        }
+
+        const_pointer data() const
+        {
+            return data_;
+        }
+
+        size_type size() const
+        {
+            return width_ * height_;
+        }
+
+        bool empty() const
+        {
+            return (size() == 0);
+        }
+
+        const_iterator begin() const
+        {
+            return data_;
+        }
+        const_iterator end() const
+        {
+            return data_ + size();
+        }
+
+    private:
+
+        details::mapped_file    file_;
+        const_pointer           data_   = nullptr;
+        size_type               width_  = 0;
+        size_type               height_ = 0;
+
+};
+
+
+} // /namespace ext
+
+
+#endif
+
+
+
@@ -0,0 +1,126 @@
+/*
+ * matrix_multiply.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_MATRIX_MULTIPLY_H
+#define CPPLIBEXT_MATRIX_MULTIPLY_H
+
+
+#include "multi_array.hpp"
+#include "grid_vector.hpp"
+#include "details/gemm_kernel.hpp"
+
+#include <stdexcept>
+#include <vector>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+
+/**
+\brief Matrix multiplication C = A * B of 2-dimensional multi_array types, where the first dimension is the row.
+\param[in] a Specifies the M x K matrix A.
+\param[in] b Specifies the K x N matrix B.
+\param[out] c Specifies the M x N matrix C. This must not refer to the same array as A or B.
+\remarks For float matrices, the kernel is chosen at runtime from AVX2+FMA, SSE, and a scalar fallback.
+All matrices must have row_major_layout.
+\code
+// Example usage:
+ext::multi_array<float, 64, 32> a;
+ext::multi_array<float, 32, 16> b;
+ext::multi_array<float, 64, 16> c;
+ext::matmul(a, b, c);
+\endcode
+*/
+template <typename T, class StorageA, class StorageB, class StorageC, class Layout, std::size_t M, std::size_t K, std::size_t N>
+void matmul(
+    const basic_multi_array<T, StorageA, Layout, M, K>& a,
+    const basic_multi_array<T, StorageB, Layout, K, N>& b,
+    basic_multi_array<T, StorageC, Layout, M, N>& c)
+{
+    static_assert(basic_multi_array<T, StorageC, Layout, M, N>::layout_mapping::is_row_major, "matmul requires row_major_layout");
+    details::gemm(details::cpu_simd_level(), M, N, K, a.data(), K, b.data(), N, c.data(), N);
+}
+
+//! Returns the matrix product A * B with the same storage policy as A. \see matmul(a, b, c)
+template <typename T, class StorageA, class StorageB, class Layout, std::size_t M, std::size_t K, std::size_t N>
+basic_multi_array<T, StorageA, Layout, M, N> matmul(
+    const basic_multi_array<T, StorageA, Layout, M, K>& a,
+    const basic_multi_array<T, StorageB, Layout, K, N>& b)
+{
+    basic_multi_array<T, StorageA, Layout, M, N> c;
+    matmul(a, b, c);
+    return c;
+}
+
+/**
+\brief Matrix-vector multiplication y = A * x.
+\param[in] a Specifies the M x N matrix A.
+\param[in] x Specifies the vector x with N elements.
+\param[out] y Specifies the vector y with M elements. This must not refer to the same array as x.
+*/
+template <typename T, class StorageA, class StorageX, class StorageY, class Layout, std::size_t M, std::size_t N>
+void gemv(
+    const basic_multi_array<T, StorageA, Layout, M, N>& a,
+    const basic_multi_array<T, StorageX, Layout, N>& x,
+    basic_multi_array<T, StorageY, Layout, M>& y)
+{
+    static_assert(basic_multi_array<T, StorageA, Layout, M, N>::layout_mapping::is_row_major, "gemv requires row_major_layout");
+    details::gemv(details::cpu_simd_level(), M, N, a.data(), N, x.data(), y.data());
+}
+
+//! Returns the matrix-vector product A * x with the same storage policy as x. \see gemv(a, x, y)
+template <typename T, class StorageA, class StorageX, class Layout, std::size_t M, std::size_t N>
+basic_multi_array<T, StorageX, Layout, M> gemv(
+    const basic_multi_array<T, StorageA, Layout, M, N>& a,
+    const basic_multi_array<T, StorageX, Layout, N>& x)
+{
+    basic_multi_array<T, StorageX, Layout, M> y;
+    gemv(a, x, y);
+    return y;
+}
+
+/**
+\brief Matrix multiplication C = A * B of grid_vector types, where the height is the number of rows and the width is the number of columns.
+\param[out] c Specifies the output matrix. This will be resized to b.width() x a.height().
+\throws std::invalid_argument If the width of A is not equal to the height of B.
+*/
+template <typename T, class Alloc, class TrackingA, class PaddingA, class TrackingB, class PaddingB, class TrackingC, class PaddingC>
+void matmul(const grid_vector<T, Alloc, TrackingA, PaddingA>& a, const grid_vector<T, Alloc, TrackingB, PaddingB>& b, grid_vector<T, Alloc, TrackingC, PaddingC>& c)
+{
+    if (a.width() != b.height())
+        throw std::invalid_argument("matmul width of first matrix does not match height of second matrix");
+    c.resize(b.width(), a.height());
+    details::gemm(details::cpu_simd_level(), a.height(), b.width(), a.width(), a.data(), a.pitch(), b.data(), b.pitch(), c.data(), c.pitch());
+}
+
+/**
+\brief Matrix-vector multiplication y = A * x of a grid_vector.
+\param[out] y Specifies the output vector. This will be resized to a.height().
+\throws std::invalid_argument If the width of A is not equal to the size of x.
+*/
+template <typename T, class Alloc, class Tracking, class Padding, class VecAlloc>
+void gemv(const grid_vector<T, Alloc, Tracking, Padding>& a, const std::vector<T, VecAlloc>& x, std::vector<T, VecAlloc>& y)
+{
+    if (a.width() != x.size())
+        throw std::invalid_argument("gemv width of matrix does not match size of vector");
+    y.resize(a.height());
+    details::gemv(details::cpu_simd_level(), a.height(), a.width(), a.data(), a.pitch(), x.data(), y.data());
+}
+
+
+} // /namespace ext
+
+
+#endif
+
+
+
@@ -14,10 +14,20 @@
 
 #include "details/product.hpp"
 #include "details/select.hpp"
+#include "details/flat_index.hpp"
+#include "details/index_sequence.hpp"
+#include "details/slice_copy.hpp"
+#include "details/constexpr.hpp"
+#include "multi_array_storage.hpp"
+#include "multi_array_layout.hpp"
+#include "array_expression.hpp"
 
 #include <initializer_list>
 #include <limits>
 #include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
 #include <array>
 
 
@@ -26,8 +36,11 @@ namespace ext
 
 
 /**
-\brief Multi dimensional array class.
+\brief Multi dimensional array class with a storage and a layout policy.
 \tparam T Specifies the data type for the array elements.
+\tparam Storage Specifies the storage policy. This can be array_storage (elements are embedded into the object) or heap_storage (elements are allocated on the heap).
+\tparam Layout Specifies the layout policy, i.e. the order of the elements in the storage.
+This can be row_major_layout, column_major_layout, tiled_layout, or morton_layout.
 \tparam Dimensions... Specifies the array dimensions. This must be at least 1 entry.
 \code
 // Example usage:
@@ -35,10 +48,19 @@ ext::multi_array<float, 3, 2, 4> ary;
 ary[0]       = 1; // Write 1's into all ary[0][i][j] where 0 <= i < 2 and 0 <= j < 4.
 ary[1][1]    = 2; // Write 2's into all ary[1][1][i] where 0 <= i < 4.
 ary[2][0][3] = 4; // Write a single 4 into ary[2][0][3].
+
+// Same array type but with its elements on the heap:
+ext::heap_multi_array<float, 3, 2, 4> heap_ary;
+
+// Array with its elements stored in 8x8 tiles for stencil operations:
+ext::basic_multi_array<float, ext::heap_storage<>, ext::tiled_layout<8>, 512, 512> tiled_ary;
 \endcode
+\remarks The iterators always walk through the elements in storage order, which is only the logical order for row_major_layout.
+\see multi_array
+\see heap_multi_array
 */
-template <typename T, std::size_t... Dimensions>
-class multi_array
+template <typename T, class Storage, class Layout, std::size_t... Dimensions>
+class basic_multi_array
 {
 
     public:
@@ -53,6 +75,9 @@ class multi_array
         using pointer           = value_type*;
         using const_pointer     = const value_type*;
 
+        //! Layout mapping of the indices to the storage offsets.
+        using layout_mapping    = typename Layout::template mapping<Dimensions...>;
+
     private:
 
         /*
@@ -115,132 +140,160 @@ class multi_array
         //! Entire storage size (in bytes).
         static const size_type data_size = sizeof(value_type) * num_elements;
 
-        //! Number of elements to the next slice.
+        //! Number of elements of each slice in the first dimension.
         static const size_type stride = next_array_size<Dimensions...>::value;
 
     private:
 
-        using this_array_type   = multi_array<T, Dimensions...>;
+        using this_array_type   = basic_multi_array<T, Storage, Layout, Dimensions...>;
 
-        using storage_type      = std::array<value_type, num_elements>;
+        using storage_type      = typename Storage::template storage<value_type, num_elements>;
 
         //! Array data storage.
         storage_type data_;
 
     public:
 
-        using iterator                  = typename storage_type::iterator;
-        using const_iterator            = typename storage_type::const_iterator;
-        using reverse_iterator          = typename storage_type::reverse_iterator;
-        using const_reverse_iterator    = typename storage_type::const_reverse_iterator;
+        using iterator                  = pointer;
+        using const_iterator            = const_pointer;
+        using reverse_iterator          = std::reverse_iterator<iterator>;
+        using const_reverse_iterator    = std::reverse_iterator<const_iterator>;
 
-        multi_array() = default;
+        basic_multi_array() = default;
 
-        multi_array(const value_type& value)
+        /**
+        \brief Constructs the array with all elements value-initialized (i.e. zeros for arithmetic types).
+        \remarks With array_storage and C++14 or later, this constructor is constexpr. \see make_multi_array
+        */
+        constexpr explicit basic_multi_array(value_init_tag tag) :
+            data_ { tag }
         {
-            fill(value);
         }
 
-        multi_array(const this_array_type& other) :
-            data_ { other.data_ }
+        basic_multi_array(const value_type& value)
         {
+            fill(value);
         }
 
-        multi_array(const std::initializer_list<value_type>& list)
+        basic_multi_array(const this_array_type&) = default;
+        basic_multi_array(this_array_type&&) = default;
+
+        basic_multi_array(const std::initializer_list<value_type>& list)
         {
             std::copy(list.begin(), list.end(), begin());
         }
 
-        pointer data()
+        //! Constructs the array from an element-wise array expression, e.g. "multi_array<float, 4, 4> a = b * c + d".
+        template <class Expr, typename = typename std::enable_if<is_array_expression_node<Expr>::value>::type>
+        basic_multi_array(const Expr& expr)
+        {
+            assign_expression(expr);
+        }
+
+        this_array_type& operator = (const this_array_type&) = default;
+        this_array_type& operator = (this_array_type&&) = default;
+
+        /**
+        \brief Assigns an element-wise array expression, e.g. "a = b * c + d".
+        \remarks The whole expression is evaluated in a single pass over all elements without any temporary arrays.
+        */
+        template <class Expr>
+        typename std::enable_if<is_array_expression_node<Expr>::value, this_array_type&>::type operator = (const Expr& expr)
+        {
+            assign_expression(expr);
+            return *this;
+        }
+
+        CPPLIBEXT_CONSTEXPR14 pointer data()
         {
             return data_.data();
         }
 
-        const_pointer data() const
+        CPPLIBEXT_CONSTEXPR14 const_pointer data() const
         {
             return data_.data();
         }
 
         //! Returns the total number of elements.
-        size_type size() const
+        CPPLIBEXT_CONSTEXPR14 size_type size() const
         {
             return num_elements;
         }
 
-        bool empty() const
+        CPPLIBEXT_CONSTEXPR14 bool empty() const
         {
-            return data_.empty();
+            return (num_elements == 0);
         }
 
-        //! Returns the maximal number of elements (equal to std::numeric_limits<size_type>::max()).
-        size_type max_size() const
+        //! Returns the maximal number of elements (equal to num_elements).
+        CPPLIBEXT_CONSTEXPR14 size_type max_size() const
         {
-            return data_.max_size();
+            return num_elements;
         }
 
-        iterator begin()
+        CPPLIBEXT_CONSTEXPR14 iterator begin()
         {
-            return data_.begin();
+            return data();
         }
 
-        const_iterator begin() const
+        CPPLIBEXT_CONSTEXPR14 const_iterator begin() const
         {
-            return data_.begin();
+            return data();
         }
 
         reverse_iterator rbegin()
         {
-            return data_.rbegin();
+            return reverse_iterator { end() };
         }
 
         const_reverse_iterator rbegin() const
         {
-            return data_.rend();
+            return const_reverse_iterator { end() };
         }
 
-        iterator end()
+        CPPLIBEXT_CONSTEXPR14 iterator end()
         {
-            return data_.end();
+            return data() + num_elements;
         }
 
-        const_iterator end() const
+        CPPLIBEXT_CONSTEXPR14 const_iterator end() const
         {
-            return data_.end();
+            return data() + num_elements;
         }
 
         reverse_iterator rend()
         {
-            return data_.rend();
+            return reverse_iterator { begin() };
         }
 
         const_reverse_iterator rend() const
         {
-            return data_.rend();
+            return const_reverse_iterator { begin() };
         }
 
-        reference front()
+        CPPLIBEXT_CONSTEXPR14 reference front()
         {
-            return data_.front();
+            return data()[0];
         }
 
-        const_reference front() const
+        CPPLIBEXT_CONSTEXPR14 const_reference front() const
         {
-            return data_.front();
+            return data()[0];
         }
 
-        reference back()
+        CPPLIBEXT_CONSTEXPR14 reference back()
         {
-            return data_.back();
+            return data()[num_elements - 1];
         }
 
-        const_reference back() const
+        CPPLIBEXT_CONSTEXPR14 const_reference back() const
         {
-            return data_.back();
+            return data()[num_elements - 1];
         }
 
-        void fill(const value_type& value)
+        CPPLIBEXT_CONSTEXPR14 void fill(const value_type& value)
         {
-            data_.fill(value);
+            details::constexpr_fill(begin(), end(), value);
         }
 
         void swap(this_array_type& other)
@@ -255,11 +308,11 @@ class multi_array
         \see num_dimensions
         \remarks This is the dynamic version of "slices" which is slower than the static version.
         */
-        size_type slices(const size_type& dimension) const
+        CPPLIBEXT_CONSTEXPR14 size_type slices(const size_type& dimension) const
         {
             if (dimension >= num_dimensions)
                 throw std::out_of_range("multi_array::slices out of range");
-            std::array<size_type, num_dimensions> dim_list {{ Dimensions... }};
+            const std::array<size_type, num_dimensions> dim_list {{ Dimensions... }};
             return dim_list[dimension];
         }
 
@@ -270,7 +323,7 @@ class multi_array
         \remarks This is the static version of "slices" which is faster than the dynamic version.
         */
         template <size_type DimensionIndex>
-        size_type slices() const
+        CPPLIBEXT_CONSTEXPR14 size_type slices() const
         {
             static_assert(DimensionIndex < num_dimensions, "multi_array::slice out of range");
             return details::select<size_type, DimensionIndex, Dimensions...>::value;
@@ -282,29 +335,86 @@ class multi_array
 
             public:
 
-                slice<NextDimensions...> operator [] (const size_type& index)
+                slice(const slice&) = default;
+
+                CPPLIBEXT_CONSTEXPR14 slice<NextDimensions...> operator [] (const size_type& index)
                 {
-                    return slice<NextDimensions...>(ptr_ + (multi_array<T, NextDimensions...>::stride * index));
+                    return slice<NextDimensions...>(ptr_ + offset<dimension>(index));
                 }
 
-                slice<NextDimensions...> at(const size_type& index)
+                CPPLIBEXT_CONSTEXPR14 slice<NextDimensions...> at(const size_type& index)
                 {
                     if (index >= first_dimension<NextDimensions...>::value)
                         throw std::out_of_range("multi_array::slice out of range");
-                    return slice<NextDimensions...>(ptr_ + (multi_array<T, NextDimensions...>::stride * index));
+                    return slice<NextDimensions...>(ptr_ + offset<dimension>(index));
+                }
+
+                //! Returns a pointer to the first element of this slice.
+                CPPLIBEXT_CONSTEXPR14 pointer data() const
+                {
+                    return ptr_;
                 }
 
-                slice<CurrentDimension, NextDimensions...>& operator = (const value_type& value)
+                //! Returns the number of elements of this slice.
+                static constexpr size_type size()
                 {
-                    std::fill(ptr_, ptr_ + multi_array<T, CurrentDimension, NextDimensions...>::stride, value);
+                    return details::product<size_type, NextDimensions...>::value;
+                }
+
+                //! Returns the number of sub-slices (or elements) along the first dimension of this slice.
+                static constexpr size_type extent()
+                {
+                    return first_dimension<NextDimensions...>::value;
+                }
+
+                //! Specifies whether the elements of this slice are a contiguous range, which is only the case with row_major_layout.
+                static const bool is_contiguous = layout_mapping::is_row_major;
+
+                //! Copies the elements of another slice with the same extents, e.g. "ary[0] = other[1]". \see copy_slice
+                slice<CurrentDimension, NextDimensions...>& operator = (const slice<CurrentDimension, NextDimensions...>& rhs)
+                {
+                    details::copy_slice_elements(*this, rhs);
+                    return *this;
+                }
+
+                //! \see operator=(const slice&)
+                template <class Slice>
+                typename std::enable_if<details::is_multi_array_slice<Slice>::value, slice<CurrentDimension, NextDimensions...>&>::type operator = (const Slice& rhs)
+                {
+                    details::copy_slice_elements(*this, rhs);
+                    return *this;
+                }
+
+                /**
+                \brief Copies the elements of the range [first, last) into this slice in logical order.
+                \throws std::invalid_argument If the range does not have size() elements.
+                */
+                template <class ForwardIt>
+                void assign(ForwardIt first, ForwardIt last)
+                {
+                    details::assign_slice_range(*this, first, last);
+                }
+
+                CPPLIBEXT_CONSTEXPR14 slice<CurrentDimension, NextDimensions...>& operator = (const value_type& value)
+                {
+                    if (layout_mapping::is_row_major)
+                        details::constexpr_fill(ptr_, ptr_ + details::product<size_type, NextDimensions...>::value, value);
+                    else
+                    {
+                        for (size_type i = 0; i < first_dimension<NextDimensions...>::value; ++i)
+                            (*this)[i] = value;
+                    }
                     return *this;
                 }
 
             private:
 
-                friend class multi_array;
+                friend class basic_multi_array;
 
-                slice(pointer ptr) :
+                // Index of the dimension that is accessed by operator[].
+                static const size_type dimension = num_dimensions - sizeof...(NextDimensions);
+
+                CPPLIBEXT_CONSTEXPR14 slice(pointer ptr) :
                     ptr_( ptr )
                 {
                 }
@@ -319,29 +429,83 @@ class multi_array
 
             public:
 
-                reference operator [] (const size_type& index)
+                slice(const slice&) = default;
+
+                CPPLIBEXT_CONSTEXPR14 reference operator [] (const size_type& index)
                 {
-                    return ptr_[index];
+                    return ptr_[offset<(num_dimensions - 1)>(index)];
                 }
 
-                reference at(const size_type& index)
+                CPPLIBEXT_CONSTEXPR14 reference at(const size_type& index)
                 {
                     if (index >= Dimension2)
                         throw std::out_of_range("multi_array::slice out of range");
-                    return ptr_[index];
+                    return ptr_[offset<(num_dimensions - 1)>(index)];
+                }
+
+                //! Returns a pointer to the first element of this slice.
+                CPPLIBEXT_CONSTEXPR14 pointer data() const
+                {
+                    return ptr_;
                 }
 
-                slice<Dimension1, Dimension2>& operator = (const value_type& value)
+                //! Returns the number of elements of this slice.
+                static constexpr size_type size()
                 {
-                    std::fill(ptr_, ptr_ + multi_array<T, Dimension1, Dimension2>::stride, value);
+                    return Dimension2;
+                }
+
+                //! Returns the number of sub-slices (or elements) along the first dimension of this slice.
+                static constexpr size_type extent()
+                {
+                    return Dimension2;
+                }
+
+                //! Specifies whether the elements of this slice are a contiguous range, which is only the case with row_major_layout.
+                static const bool is_contiguous = layout_mapping::is_row_major;
+
+                //! Copies the elements of another slice with the same extents, e.g. "ary[0] = other[1]". \see copy_slice
+                slice<Dimension1, Dimension2>& operator = (const slice<Dimension1, Dimension2>& rhs)
+                {
+                    details::copy_slice_elements(*this, rhs);
+                    return *this;
+                }
+
+                //! \see operator=(const slice&)
+                template <class Slice>
+                typename std::enable_if<details::is_multi_array_slice<Slice>::value, slice<Dimension1, Dimension2>&>::type operator = (const Slice& rhs)
+                {
+                    details::copy_slice_elements(*this, rhs);
+                    return *this;
+                }
+
+                /**
+                \brief Copies the elements of the range [first, last) into this slice in logical order.
+                \throws std::invalid_argument If the range does not have size() elements.
+                */
+                template <class ForwardIt>
+                void assign(ForwardIt first, ForwardIt last)
+                {
+                    details::assign_slice_range(*this, first, last);
+                }
+
+                CPPLIBEXT_CONSTEXPR14 slice<Dimension1, Dimension2>& operator = (const value_type& value)
+                {
+                    if (layout_mapping::is_row_major)
+                        details::constexpr_fill(ptr_, ptr_ + Dimension2, value);
+                    else
+                    {
+                        for (size_type i = 0; i < Dimension2; ++i)
+                            (*this)[i] = value;
+                    }
                     return *this;
                 }
 
             private:
 
-                friend class multi_array;
+                friend class basic_multi_array;
 
-                slice(pointer ptr) :
+                CPPLIBEXT_CONSTEXPR14 slice(pointer ptr) :
                     ptr_( ptr )
                 {
                 }
@@ -356,23 +520,47 @@ class multi_array
 
             public:
 
-                const_slice<NextDimensions...> operator [] (const size_type& index) const
+                CPPLIBEXT_CONSTEXPR14 const_slice<NextDimensions...> operator [] (const size_type& index) const
                 {
-                    return const_slice<NextDimensions...>(ptr_ + (multi_array<T, NextDimensions...>::stride * index));
+                    return const_slice<NextDimensions...>(ptr_ + offset<dimension>(index));
                 }
 
-                const_slice<NextDimensions...> at(const size_type& index) const
+                CPPLIBEXT_CONSTEXPR14 const_slice<NextDimensions...> at(const size_type& index) const
                 {
                     if (index >= first_dimension<NextDimensions...>::value)
                         throw std::out_of_range("multi_array::const_slice out of range");
-                    return const_slice<NextDimensions...>(ptr_ + (multi_array<T, NextDimensions...>::stride * index));
+                    return const_slice<NextDimensions...>(ptr_ + offset<dimension>(index));
+                }
+
+                //! Returns a pointer to the first element of this slice.
+                CPPLIBEXT_CONSTEXPR14 const_pointer data() const
+                {
+                    return ptr_;
+                }
+
+                //! Returns the number of elements of this slice.
+                static constexpr size_type size()
+                {
+                    return details::product<size_type, NextDimensions...>::value;
                 }
 
+                //! Returns the number of sub-slices (or elements) along the first dimension of this slice.
+                static constexpr size_type extent()
+                {
+                    return first_dimension<NextDimensions...>::value;
+                }
+
+                //! Specifies whether the elements of this slice are a contiguous range, which is only the case with row_major_layout.
+                static const bool is_contiguous = layout_mapping::is_row_major;
+
             private:
 
-                friend class multi_array;
+                friend class basic_multi_array;
 
-                const_slice(const_pointer ptr) :
+                // Index of the dimension that is accessed by operator[].
+                static const size_type dimension = num_dimensions - sizeof...(NextDimensions);
+
+                CPPLIBEXT_CONSTEXPR14 const_slice(const_pointer ptr) :
                     ptr_( ptr )
                 {
                 }
@@ -387,23 +575,44 @@ class multi_array
 
             public:
 
-                const_reference operator [] (const size_type& index) const
+                CPPLIBEXT_CONSTEXPR14 const_reference operator [] (const size_type& index) const
                 {
-                    return ptr_[index];
+                    return ptr_[offset<(num_dimensions - 1)>(index)];
                 }
 
-                const_reference at(const size_type& index) const
+                CPPLIBEXT_CONSTEXPR14 const_reference at(const size_type& index) const
                 {
                     if (index >= Dimension2)
                         throw std::out_of_range("multi_array::const_slice out of range");
-                    return ptr_[index];
+                    return ptr_[offset<(num_dimensions - 1)>(index)];
+                }
+
+                //! Returns a pointer to the first element of this slice.
+                CPPLIBEXT_CONSTEXPR14 const_pointer data() const
+                {
+                    return ptr_;
+                }
+
+                //! Returns the number of elements of this slice.
+                static constexpr size_type size()
+                {
+                    return Dimension2;
                 }
 
+                //! Returns the number of sub-slices (or elements) along the first dimension of this slice.
+                static constexpr size_type extent()
+                {
+                    return Dimension2;
+                }
+
+                //! Specifies whether the elements of this slice are a contiguous range, which is only the case with row_major_layout.
+                static const bool is_contiguous = layout_mapping::is_row_major;
+
             private:
 
-                friend class multi_array;
+                friend class basic_multi_array;
 
-                const_slice(const_pointer ptr) :
+                CPPLIBEXT_CONSTEXPR14 const_slice(const_pointer ptr) :
                     ptr_( ptr )
                 {
                 }
@@ -412,28 +621,124 @@ class multi_array
 
         };
 
-        slice<Dimensions...> operator [] (const size_type& index)
+        CPPLIBEXT_CONSTEXPR14 slice<Dimensions...> operator [] (const size_type& index)
         {
-            return slice<Dimensions...>(data_.data() + (stride*index));
+            return slice<Dimensions...>(data() + offset<0>(index));
         }
 
-        const_slice<Dimensions...> operator [] (const size_type& index) const
+        CPPLIBEXT_CONSTEXPR14 const_slice<Dimensions...> operator [] (const size_type& index) const
         {
-            return const_slice<Dimensions...>(data_.data() + (stride*index));
+            return const_slice<Dimensions...>(data() + offset<0>(index));
         }
 
-        slice<Dimensions...> at(const size_type& index)
+        CPPLIBEXT_CONSTEXPR14 slice<Dimensions...> at(const size_type& index)
         {
             if (index >= first_dimension<Dimensions...>::value)
                 throw std::out_of_range("multi_array::slice out of range");
-            return slice<Dimensions...>(data_.data() + (stride*index));
+            return slice<Dimensions...>(data() + offset<0>(index));
         }
 
-        const_slice<Dimensions...> at(const size_type& index) const
+        CPPLIBEXT_CONSTEXPR14 const_slice<Dimensions...> at(const size_type& index) const
         {
             if (index >= first_dimension<Dimensions...>::value)
                 throw std::out_of_range("multi_array::slice out of range");
-            return const_slice<Dimensions...>(data_.data() + (stride*index));
+            return const_slice<Dimensions...>(data() + offset<0>(index));
+        }
+
+        /**
+        \brief Returns a reference to the element at the specified indices, e.g. ary(i, j, k) instead of ary[i][j][k].
+        \remarks In contrast to operator[], this does not create any slice objects, i.e. the offset is computed in one step.
+        */
+        template <typename... Indices>
+        CPPLIBEXT_CONSTEXPR14 reference operator () (Indices... indices)
+        {
+            static_assert(sizeof...(Indices) == num_dimensions, "number of indices does not match the number of multi_array dimensions");
+            return data()[flat_index(indices...)];
+        }
+
+        //! \see operator()(Indices...)
+        template <typename... Indices>
+        CPPLIBEXT_CONSTEXPR14 const_reference operator () (Indices... indices) const
+        {
+            static_assert(sizeof...(Indices) == num_dimensions, "number of indices does not match the number of multi_array dimensions");
+            return data()[flat_index(indices...)];
+        }
+
+        /**
+        \brief Returns a reference to the element at the specified indices with bounds checking.
+        \throws std::out_of_range If any of the indices is out of range.
+        */
+        template <typename... Indices>
+        CPPLIBEXT_CONSTEXPR14 typename std::enable_if<sizeof...(Indices) == num_dimensions, reference>::type at(Indices... indices)
+        {
+            if (!index_mapping::in_range(indices...))
+                throw std::out_of_range("multi_array::at out of range");
+            return data()[flat_index(indices...)];
+        }
+
+        //! \see at(Indices...)
+        template <typename... Indices>
+        CPPLIBEXT_CONSTEXPR14 typename std::enable_if<sizeof...(Indices) == num_dimensions, const_reference>::type at(Indices... indices) const
+        {
+            if (!index_mapping::in_range(indices...))
+                throw std::out_of_range("multi_array::at out of range");
+            return data()[flat_index(indices...)];
+        }
+
+        /**
+        \brief Returns the offset of the element at the specified indices, i.e. "&ary(i, j, k) == ary.data() + flat_index(i, j, k)".
+        \remarks Use this to hoist the index computation out of inner loops. The offset depends on the layout policy.
+        */
+        template <typename... Indices>
+        static constexpr size_type flat_index(Indices... indices)
+        {
+            return index_mapping::compute(indices...);
+        }
+
+        //! Returns the indices of the element at the specified offset. This is the inverse function of flat_index.
+        CPPLIBEXT_CONSTEXPR14 static std::array<size_type, num_dimensions> unravel_index(size_type index)
+        {
+            return unravel_index_sequence(index, typename details::make_index_sequence<num_dimensions>::type());
+        }
+
+    private:
+
+        using index_mapping = details::flat_index<layout_mapping, 0, Dimensions...>;
+
+        // Returns the storage offset of the specified index in the dimension 'Dim'.
+        template <size_type Dim>
+        static constexpr size_type offset(size_type index)
+        {
+            return layout_mapping::template offset<Dim>(index);
+        }
+
+        template <std::size_t... Indices>
+        CPPLIBEXT_CONSTEXPR14 static std::array<size_type, num_dimensions> unravel_index_sequence(size_type index, details::index_sequence<Indices...>)
+        {
+            return {{ layout_mapping::template index<Indices>(index)... }};
+        }
+
+        template <class Expr>
+        void assign_expression(const Expr& expr)
+        {
+            static_assert(Expr::num_elements == num_elements, "array expression must have the same number of elements as the multi_array");
+            static_assert(std::is_void<typename Expr::layout_type>::value || std::is_same<typename Expr::layout_type, layout_mapping>::value, "array expression must have the same layout as the multi_array");
+
+            /* Copy expression tree to the stack, so its operand pointers can be kept in registers while the loop is vectorized */
+            const Expr e = expr;
+            pointer dst = data();
+
+            /*
+            Each element only depends on the operand elements at the same index,
+            so there is no loop-carried dependency, even if this array is also an operand (e.g. "a = a * b")
+            */
+            #if defined(__GNUC__) && !defined(__clang__)
+            #   pragma GCC ivdep
+            #elif defined(_MSC_VER)
+            #   pragma loop(ivdep)
+            #endif
+            for (size_type i = 0; i < num_elements; ++i)
+                dst[i] = static_cast<value_type>(e.eval(i));
         }
 
 };
@@ -442,10 +747,12 @@ class multi_array
 /**
 Multi dimensional array class.
 \tparam T Specifies the data type for the array elements.
-\remarks This is a template specialization of the multi-dimensional multi_array class.
+\tparam Storage Specifies the storage policy.
+\tparam Layout Specifies the layout policy. All layouts are equivalent for 1 dimension.
+\remarks This is a template specialization of the multi-dimensional basic_multi_array class.
 */
-template <typename T, std::size_t Dimension>
-class multi_array<T, Dimension>
+template <typename T, class Storage, class Layout, std::size_t Dimension>
+class basic_multi_array<T, Storage, Layout, Dimension>
 {
 
     public:
@@ -458,6 +765,9 @@ class multi_array<T, Dimension>
         using pointer           = value_type*;
         using const_pointer     = const value_type*;
 
+        //! Layout mapping of the indices to the storage offsets.
+        using layout_mapping    = typename Layout::template mapping<Dimension>;
+
     public:
 
         //! Number of dimensions.
@@ -474,120 +784,148 @@ class multi_array<T, Dimension>
 
     private:
 
-        using this_array_type   = multi_array<T, Dimension>;
+        using this_array_type   = basic_multi_array<T, Storage, Layout, Dimension>;
 
-        using storage_type      = std::array<value_type, num_elements>;
+        using storage_type      = typename Storage::template storage<value_type, num_elements>;
 
         //! Array data storage.
         storage_type data_;
 
     public:
 
-        using iterator                  = typename storage_type::iterator;
-        using const_iterator            = typename storage_type::const_iterator;
-        using reverse_iterator          = typename storage_type::reverse_iterator;
-        using const_reverse_iterator    = typename storage_type::const_reverse_iterator;
+        using iterator                  = pointer;
+        using const_iterator            = const_pointer;
+        using reverse_iterator          = std::reverse_iterator<iterator>;
+        using const_reverse_iterator    = std::reverse_iterator<const_iterator>;
 
-        multi_array() = default;
+        basic_multi_array() = default;
 
-        multi_array(const value_type& value)
+        /**
+        \brief Constructs the array with all elements value-initialized (i.e. zeros for arithmetic types).
+        \remarks With array_storage and C++14 or later, this constructor is constexpr. \see make_multi_array
+        */
+        constexpr explicit basic_multi_array(value_init_tag tag) :
+            data_ { tag }
         {
-            fill(value);
         }
 
-        multi_array(const this_array_type& other) :
-            data_( other.data_ )
+        basic_multi_array(const value_type& value)
         {
+            fill(value);
         }
 
-        multi_array(const std::initializer_list<value_type>& list)
+        basic_multi_array(const this_array_type&) = default;
+        basic_multi_array(this_array_type&&) = default;
+
+        basic_multi_array(const std::initializer_list<value_type>& list)
         {
             std::copy(list.begin(), list.end(), begin());
         }
 
-        pointer data()
+        //! Constructs the array from an element-wise array expression, e.g. "multi_array<float, 4, 4> a = b * c + d".
+        template <class Expr, typename = typename std::enable_if<is_array_expression_node<Expr>::value>::type>
+        basic_multi_array(const Expr& expr)
+        {
+            assign_expression(expr);
+        }
+
+        this_array_type& operator = (const this_array_type&) = default;
+        this_array_type& operator = (this_array_type&&) = default;
+
+        /**
+        \brief Assigns an element-wise array expression, e.g. "a = b * c + d".
+        \remarks The whole expression is evaluated in a single pass over all elements without any temporary arrays.
+        */
+        template <class Expr>
+        typename std::enable_if<is_array_expression_node<Expr>::value, this_array_type&>::type operator = (const Expr& expr)
+        {
+            assign_expression(expr);
+            return *this;
+        }
+
+        CPPLIBEXT_CONSTEXPR14 pointer data()
         {
             return data_.data();
         }
-        const_pointer data() const
+        CPPLIBEXT_CONSTEXPR14 const_pointer data() const
         {
             return data_.data();
         }
 
         //! Returns the total number of elements.
-        size_type size() const
+        CPPLIBEXT_CONSTEXPR14 size_type size() const
         {
             return num_elements;
         }
 
-        //! Returns the maximal number of elements (equal to std::numeric_limits<size_type>::max()).
-        size_type max_size() const
+        //! Returns the maximal number of elements (equal to num_elements).
+        CPPLIBEXT_CONSTEXPR14 size_type max_size() const
         {
-            return data_.max_size();
+            return num_elements;
         }
 
-        bool empty() const
+        CPPLIBEXT_CONSTEXPR14 bool empty() const
         {
-            return data_.empty();
+            return (num_elements == 0);
         }
 
-        iterator begin()
+        CPPLIBEXT_CONSTEXPR14 iterator begin()
         {
-            return data_.begin();
+            return data();
         }
-        const_iterator begin() const
+        CPPLIBEXT_CONSTEXPR14 const_iterator begin() const
         {
-            return data_.begin();
+            return data();
         }
 
         reverse_iterator rbegin()
         {
-            return data_.rbegin();
+            return reverse_iterator { end() };
         }
         const_reverse_iterator rbegin() const
         {
-            return data_.rbegin();
+            return const_reverse_iterator { end() };
         }
 
-        iterator end()
+        CPPLIBEXT_CONSTEXPR14 iterator end()
         {
-            return data_.end();
+            return data() + num_elements;
         }
-        const_iterator end() const
+        CPPLIBEXT_CONSTEXPR14 const_iterator end() const
         {
-            return data_.end();
+            return data() + num_elements;
         }
 
         reverse_iterator rend()
         {
-            return data_.rend();
+            return reverse_iterator { begin() };
         }
         const_reverse_iterator rend() const
         {
-            return data_.rend();
+            return const_reverse_iterator { begin() };
         }
 
-        reference front()
+        CPPLIBEXT_CONSTEXPR14 reference front()
         {
-            return data_.front();
+            return data()[0];
         }
-        const_reference front() const
+        CPPLIBEXT_CONSTEXPR14 const_reference front() const
         {
-            return data_.front();
+            return data()[0];
         }
 
-        reference back()
+        CPPLIBEXT_CONSTEXPR14 reference back()
         {
-            return data_.back();
+            return data()[num_elements - 1];
         }
-        const_reference back() const
+        CPPLIBEXT_CONSTEXPR14 const_reference back() const
         {
-            return data_.back();
+            return data()[num_elements - 1];
         }
 
-        void fill(const value_type& value)
+        CPPLIBEXT_CONSTEXPR14 void fill(const value_type& value)
         {
-            data_.fill(value);
+            details::constexpr_fill(begin(), end(), value);
         }
 
         void swap(this_array_type& other)
@@ -602,7 +940,7 @@ class multi_array<T, Dimension>
         \see num_dimensions
         \remarks This is the dynamic version of "slices" which is slower than the static version.
         */
-        size_type slices(const size_type& dimension) const
+        CPPLIBEXT_CONSTEXPR14 size_type slices(const size_type& dimension) const
         {
             if (dimension >= num_dimensions)
                 throw std::out_of_range("multi_array::slices out of range");
@@ -616,35 +954,177 @@ class multi_array<T, Dimension>
         \remarks This is the static version of "slices" which is faster than the dynamic version.
         */
         template <size_type DimensionIndex>
-        size_type slices() const
+        CPPLIBEXT_CONSTEXPR14 size_type slices() const
         {
             static_assert(DimensionIndex < num_dimensions, "multi_array::slice out of range");
             return Dimension;
         }
 
-        reference operator [] (const size_type& index)
+        CPPLIBEXT_CONSTEXPR14 reference operator [] (const size_type& index)
+        {
+            return data()[index];
+        }
+
+        CPPLIBEXT_CONSTEXPR14 const_reference operator [] (const size_type& index) const
+        {
+            return data()[index];
+        }
+
+        CPPLIBEXT_CONSTEXPR14 reference at(const size_type& index)
         {
-            return data_[index];
+            if (index >= Dimension)
+                throw std::out_of_range("multi_array::at out of range");
+            return data()[index];
         }
 
-        const_reference operator [] (const size_type& index) const
+        CPPLIBEXT_CONSTEXPR14 const_reference at(const size_type& index) const
         {
-            return data_[index];
+            if (index >= Dimension)
+                throw std::out_of_range("multi_array::at out of range");
+            return data()[index];
         }
 
-        reference at(const size_type& index)
+        CPPLIBEXT_CONSTEXPR14 reference operator () (const size_type& index)
         {
-            return data_.at(index);
+            return data()[index];
         }
 
-        const_reference at(const size_type& index) const
+        CPPLIBEXT_CONSTEXPR14 const_reference operator () (const size_type& index) const
         {
-            return data_.at(index);
+            return data()[index];
+        }
+
+        //! Returns the offset of the element at the specified index, which is the index itself for 1-dimensional arrays.
+        static constexpr size_type flat_index(size_type index)
+        {
+            return index;
+        }
+
+        //! Returns the indices of the element at the specified offset. This is the inverse function of flat_index.
+        CPPLIBEXT_CONSTEXPR14 static std::array<size_type, 1> unravel_index(size_type index)
+        {
+            return {{ index }};
+        }
+
+    private:
+
+        template <class Expr>
+        void assign_expression(const Expr& expr)
+        {
+            static_assert(Expr::num_elements == num_elements, "array expression must have the same number of elements as the multi_array");
+            static_assert(std::is_void<typename Expr::layout_type>::value || std::is_same<typename Expr::layout_type, layout_mapping>::value, "array expression must have the same layout as the multi_array");
+
+            /* Copy expression tree to the stack, so its operand pointers can be kept in registers while the loop is vectorized */
+            const Expr e = expr;
+            pointer dst = data();
+
+            /*
+            Each element only depends on the operand elements at the same index,
+            so there is no loop-carried dependency, even if this array is also an operand (e.g. "a = a * b")
+            */
+            #if defined(__GNUC__) && !defined(__clang__)
+            #   pragma GCC ivdep
+            #elif defined(_MSC_VER)
+            #   pragma loop(ivdep)
+            #endif
+            for (size_type i = 0; i < num_elements; ++i)
+                dst[i] = static_cast<value_type>(e.eval(i));
         }
 
 };
 
 
+/**
+\brief Multi dimensional array class, which embeds its elements into the object (like std::array).
+\see basic_multi_array
+*/
+template <typename T, std::size_t... Dimensions>
+using multi_array = basic_multi_array<T, array_storage, row_major_layout, Dimensions...>;
+
+/**
+\brief Multi dimensional array class, which allocates its elements on the heap with an alignment of 64 bytes.
+\remarks Use this for arrays that are too large for the stack or for objects that contain them.
+\see basic_multi_array
+\see heap_storage
+*/
+template <typename T, std::size_t... Dimensions>
+using heap_multi_array = basic_multi_array<T, heap_storage<>, row_major_layout, Dimensions...>;
+
+
+//! Traits to use multi_array as operand of element-wise array expressions.
+template <typename T, class Storage, class Layout, std::size_t... Dimensions>
+struct array_expression_traits<basic_multi_array<T, Storage, Layout, Dimensions...>>
+{
+    static const bool is_expression = true;
+
+    using array_type    = basic_multi_array<T, Storage, Layout, Dimensions...>;
+    using operand_type  = details::array_operand<T, array_type::num_elements, typename array_type::layout_mapping>;
+
+    static operand_type make_operand(const array_type& ary)
+    {
+        return operand_type(ary.data());
+    }
+};
+
+
+// This namespace is only used internally
+namespace details
+{
+
+
+// Calls 'func(indices[0], indices[1], ..., indices[N-1])'.
+template <class Func, std::size_t N, std::size_t... Indices>
+CPPLIBEXT_CONSTEXPR14 auto invoke_with_indices(Func& func, const std::array<std::size_t, N>& indices, index_sequence<Indices...>) -> decltype(func(indices[Indices]...))
+{
+    return func(indices[Indices]...);
+}
+
+
+} // /namespace details
+
+/**
+\brief Returns a multi_array where each element is the result of 'func(i1, i2, ..., iN)' for its indices.
+\remarks With C++14 or later, this can be evaluated at compile time, so lookup tables can be placed in read-only data.
+'func' must then be a constexpr function object (lambdas are implicitly constexpr since C++17).
+\code
+// Example usage (C++17):
+constexpr auto table = ext::make_multi_array<int, 16, 16>([](std::size_t i, std::size_t j) { return static_cast<int>(i * j); });
+static_assert(table(3, 4) == 12, "table is computed at compile time");
+\endcode
+*/
+template <typename T, std::size_t... Dimensions, class Func>
+CPPLIBEXT_CONSTEXPR14 multi_array<T, Dimensions...> make_multi_array(Func func)
+{
+    multi_array<T, Dimensions...> ary { value_init_tag() };
+    for (std::size_t i = 0; i < multi_array<T, Dimensions...>::num_elements; ++i)
+        ary.data()[i] = static_cast<T>(details::invoke_with_indices(func, multi_array<T, Dimensions...>::unravel_index(i), typename details::make_index_sequence<sizeof...(Dimensions)>::type()));
+    return ary;
+}
+
+/**
+\brief Copies the elements of the slice 'src' into the slice 'dst' with the same extents, e.g. "copy_slice(frames[i], ring[j])".
+\remarks If both slices are contiguous (row_major_layout) and have the same trivially copyable value type, this is a single memmove.
+Otherwise the elements are copy-assigned element-wise. The slices may also refer to different arrays with different storage policies.
+*/
+template <class SrcSlice, class DstSlice>
+void copy_slice(const SrcSlice& src, DstSlice dst)
+{
+    static_assert(details::is_multi_array_slice<SrcSlice>::value && details::is_multi_array_slice<DstSlice>::value, "copy_slice requires multi_array slices");
+    details::copy_slice_elements(dst, src);
+}
+
+/**
+\brief Moves the elements of the slice 'src' into the slice 'dst' with the same extents.
+\remarks Same as copy_slice, but types that are not trivially copyable are move-assigned element-wise.
+*/
+template <class SrcSlice, class DstSlice>
+void move_slice(SrcSlice src, DstSlice dst)
+{
+    static_assert(details::is_multi_array_slice<SrcSlice>::value && details::is_multi_array_slice<DstSlice>::value, "move_slice requires multi_array slices");
+    details::move_slice_elements(dst, src);
+}
+
+
 } // /namespace ext
 
 
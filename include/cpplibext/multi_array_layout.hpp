@@ -0,0 +1,319 @@
+/*
+ * multi_array_layout.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_MULTI_ARRAY_LAYOUT_H
+#define CPPLIBEXT_MULTI_ARRAY_LAYOUT_H
+
+
+#include "details/product.hpp"
+#include "details/select.hpp"
+
+#include <cstdlib>
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+// Returns the number of bits that are required to represent all values in [0, n), i.e. ceil(log2(n)).
+constexpr std::size_t bit_width_of(std::size_t n)
+{
+    return (n <= 1 ? 0 : 1 + bit_width_of((n + 1) / 2));
+}
+
+constexpr std::size_t static_pow(std::size_t base, std::size_t exp)
+{
+    return (exp == 0 ? 1 : base * static_pow(base, exp - 1));
+}
+
+constexpr bool is_power_of_two(std::size_t n)
+{
+    return (n > 0 && (n & (n - 1)) == 0);
+}
+
+/* --- Morton order bit positions --- */
+
+// Number of dimensions that have more than 'level' bits.
+template <std::size_t... DN>
+struct morton_active;
+
+template <>
+struct morton_active<>
+{
+    static constexpr std::size_t count(std::size_t)
+    {
+        return 0;
+    }
+};
+
+template <std::size_t D1, std::size_t... DN>
+struct morton_active<D1, DN...>
+{
+    static constexpr std::size_t count(std::size_t level)
+    {
+        return ((bit_width_of(D1) > level ? 1 : 0) + morton_active<DN...>::count(level));
+    }
+};
+
+// Number of dimensions after the specified index that have more than 'level' bits.
+template <std::size_t Index, std::size_t... DN>
+struct morton_active_after;
+
+template <std::size_t Index, std::size_t D1, std::size_t... DN>
+struct morton_active_after<Index, D1, DN...> : morton_active_after<(Index - 1), DN...>
+{
+};
+
+template <std::size_t D1, std::size_t... DN>
+struct morton_active_after<0, D1, DN...> : morton_active<DN...>
+{
+};
+
+/*
+Bit positions of the dimension 'Index' in the Morton order (Z-order).
+The bits of all dimensions are interleaved round-robin, starting with the least significant bit of the last dimension,
+and dimensions with fewer bits drop out of the interleaving once all their bits are assigned.
+*/
+template <std::size_t Index, std::size_t... DN>
+struct morton_position
+{
+    // Number of bit positions that are occupied by all lower levels.
+    static constexpr std::size_t bits_below(std::size_t level)
+    {
+        return (level == 0 ? 0 : bits_below(level - 1) + morton_active<DN...>::count(level - 1));
+    }
+
+    static constexpr std::size_t position(std::size_t level)
+    {
+        return (bits_below(level) + morton_active_after<Index, DN...>::count(level));
+    }
+};
+
+/*
+Scatters the bits of an index of the dimension 'Index' to their Morton order positions (like the PDEP instruction),
+and gathers them back (like the PEXT instruction). All bit positions are compile-time constants,
+so the compiler can fully unroll the bit operations for each element access.
+*/
+template <std::size_t Index, std::size_t Level, std::size_t NumBits, std::size_t... DN>
+struct morton_bits
+{
+    static const std::size_t position = morton_position<Index, DN...>::position(Level);
+
+    static constexpr std::size_t deposit(std::size_t x)
+    {
+        return ((((x >> Level) & 1) << position) | morton_bits<Index, (Level + 1), NumBits, DN...>::deposit(x));
+    }
+
+    static constexpr std::size_t extract(std::size_t x)
+    {
+        return ((((x >> position) & 1) << Level) | morton_bits<Index, (Level + 1), NumBits, DN...>::extract(x));
+    }
+};
+
+template <std::size_t Index, std::size_t NumBits, std::size_t... DN>
+struct morton_bits<Index, NumBits, NumBits, DN...>
+{
+    static constexpr std::size_t deposit(std::size_t)
+    {
+        return 0;
+    }
+
+    static constexpr std::size_t extract(std::size_t)
+    {
+        return 0;
+    }
+};
+
+
+} // /namespace details
+
+
+/*
+Layout policies for basic_multi_array.
+Each layout provides the nested template "mapping<Dimensions...>", which maps the index of each dimension
+to an offset in the storage. All layouts are separable, i.e. the storage offset of the element at (i1, i2, ..., iN)
+is offset<0>(i1) + offset<1>(i2) + ... + offset<N-1>(iN), so slices can still be represented by a single pointer.
+*/
+
+
+/**
+\brief Row-major layout (like C arrays). This is the default layout of multi_array.
+\remarks The last dimension is densely packed, so each slice is a contiguous range of elements.
+*/
+struct row_major_layout
+{
+
+    template <std::size_t... Dimensions>
+    struct mapping
+    {
+
+        //! Specifies whether each slice is a contiguous range of elements in row-major order.
+        static const bool is_row_major  = true;
+
+        //! Specifies whether the offset of each dimension is the index multiplied by a constant stride.
+        static const bool is_strided    = true;
+
+        template <std::size_t Dim>
+        static constexpr std::size_t stride()
+        {
+            return details::product_after<std::size_t, Dim, Dimensions...>::value;
+        }
+
+        template <std::size_t Dim>
+        static constexpr std::size_t offset(std::size_t index)
+        {
+            return index * stride<Dim>();
+        }
+
+        template <std::size_t Dim>
+        static constexpr std::size_t index(std::size_t offset)
+        {
+            return (offset / stride<Dim>()) % details::select<std::size_t, Dim, Dimensions...>::value;
+        }
+
+    };
+
+};
+
+/**
+\brief Column-major layout (like Fortran arrays).
+\remarks The first dimension is densely packed.
+*/
+struct column_major_layout
+{
+
+    template <std::size_t... Dimensions>
+    struct mapping
+    {
+
+        static const bool is_row_major  = false;
+        static const bool is_strided    = true;
+
+        template <std::size_t Dim>
+        static constexpr std::size_t stride()
+        {
+            return details::product_before<std::size_t, Dim, Dimensions...>::value;
+        }
+
+        template <std::size_t Dim>
+        static constexpr std::size_t offset(std::size_t index)
+        {
+            return index * stride<Dim>();
+        }
+
+        template <std::size_t Dim>
+        static constexpr std::size_t index(std::size_t offset)
+        {
+            return (offset / stride<Dim>()) % details::select<std::size_t, Dim, Dimensions...>::value;
+        }
+
+    };
+
+};
+
+/**
+\brief Tiled layout, which stores the array in blocks of TileSize^N elements.
+\tparam TileSize Specifies the edge length of each tile. This should be a power of two, so the divisions are cheap.
+\remarks The tiles are stored in row-major order and the elements inside each tile are stored in row-major order as well.
+Neighbors along all dimensions are therefore likely in the same cache lines, which is suitable for stencil operations.
+All dimensions must be multiples of TileSize.
+*/
+template <std::size_t TileSize>
+struct tiled_layout
+{
+
+    static_assert(TileSize > 0, "tile size of tiled_layout must be greater than zero");
+
+    template <std::size_t... Dimensions>
+    struct mapping
+    {
+
+        static_assert(details::product<std::size_t, (Dimensions % TileSize == 0 ? 1 : 0)...>::value == 1, "dimensions of tiled_layout must be multiples of the tile size");
+
+        static const bool is_row_major  = false;
+        static const bool is_strided    = false;
+
+        //! Number of elements per tile.
+        static const std::size_t tile_elements = details::static_pow(TileSize, sizeof...(Dimensions));
+
+        template <std::size_t Dim>
+        static constexpr std::size_t offset(std::size_t index)
+        {
+            return
+            (
+                (index / TileSize) * (tile_elements * details::product_after<std::size_t, Dim, (Dimensions / TileSize)...>::value) +
+                (index % TileSize) * details::static_pow(TileSize, sizeof...(Dimensions) - 1 - Dim)
+            );
+        }
+
+        template <std::size_t Dim>
+        static constexpr std::size_t index(std::size_t offset)
+        {
+            return
+            (
+                ((offset / tile_elements / details::product_after<std::size_t, Dim, (Dimensions / TileSize)...>::value) % (details::select<std::size_t, Dim, Dimensions...>::value / TileSize)) * TileSize +
+                ((offset % tile_elements) / details::static_pow(TileSize, sizeof...(Dimensions) - 1 - Dim)) % TileSize
+            );
+        }
+
+    };
+
+};
+
+/**
+\brief Morton order layout (Z-order curve), which interleaves the bits of all indices.
+\remarks Elements that are close to each other in any dimension are likely close to each other in memory as well,
+on all scales (cache lines, pages) at once. All dimensions must be powers of two.
+Each element access interleaves the bits of all indices (a few instructions per bit),
+so for tight stencil loops tiled_layout is usually faster, while morton_layout suits traversals in storage order
+and access patterns without a fixed block size.
+*/
+struct morton_layout
+{
+
+    template <std::size_t... Dimensions>
+    struct mapping
+    {
+
+        static_assert(details::product<std::size_t, (details::is_power_of_two(Dimensions) ? 1 : 0)...>::value == 1, "dimensions of morton_layout must be powers of two");
+
+        static const bool is_row_major  = false;
+        static const bool is_strided    = false;
+
+        template <std::size_t Dim>
+        using morton_bits = details::morton_bits<Dim, 0, details::bit_width_of(details::select<std::size_t, Dim, Dimensions...>::value), Dimensions...>;
+
+        template <std::size_t Dim>
+        static constexpr std::size_t offset(std::size_t index)
+        {
+            return morton_bits<Dim>::deposit(index);
+        }
+
+        template <std::size_t Dim>
+        static constexpr std::size_t index(std::size_t offset)
+        {
+            return morton_bits<Dim>::extract(offset);
+        }
+
+    };
+
+};
+
+
+} // /namespace ext
+
+
+#endif
+
+
@@ -0,0 +1,332 @@
+/*
+ * multi_array_reduce.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_MULTI_ARRAY_REDUCE_H
+#define CPPLIBEXT_MULTI_ARRAY_REDUCE_H
+
+
+#include "multi_array.hpp"
+#include "details/product.hpp"
+#include "details/select.hpp"
+#include "details/index_sequence.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <array>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+/*
+meta template to determine the multi_array type with the dimension 'Axis' removed:
+reduced_multi_array<T, S, L, 1, 3, 4, 2>::type == basic_multi_array<T, S, L, 3, 2>;
+*/
+
+template <typename T, class Storage, class Layout, std::size_t Axis, class Indices, std::size_t... Dimensions>
+struct reduced_multi_array_secondary;
+
+template <typename T, class Storage, class Layout, std::size_t Axis, std::size_t... Indices, std::size_t... Dimensions>
+struct reduced_multi_array_secondary<T, Storage, Layout, Axis, index_sequence<Indices...>, Dimensions...>
+{
+    using type = basic_multi_array<T, Storage, Layout, select<std::size_t, ((Indices < Axis) ? Indices : Indices + 1), Dimensions...>::value...>;
+};
+
+template <typename T, class Storage, class Layout, std::size_t Axis, std::size_t... Dimensions>
+struct reduced_multi_array
+{
+    static_assert(sizeof...(Dimensions) > 1, "reduction axis can only be removed from multi_array with at least 2 dimensions");
+    static_assert(Axis < sizeof...(Dimensions), "reduction axis out of range");
+
+    using type = typename reduced_multi_array_secondary<
+        T, Storage, Layout, Axis, typename make_index_sequence<sizeof...(Dimensions) - 1>::type, Dimensions...
+    >::type;
+};
+
+// Row-major array shape as [outer][extent][inner] around the dimension 'Axis'.
+template <std::size_t Axis, std::size_t... Dimensions>
+struct reduce_shape
+{
+    static const std::size_t outer  = product_before<std::size_t, Axis, Dimensions...>::value;
+    static const std::size_t extent = select<std::size_t, Axis, Dimensions...>::value;
+    static const std::size_t inner  = product_after<std::size_t, Axis, Dimensions...>::value;
+};
+
+// Size of each block for outer-axis reductions (in bytes), so the accumulators of one block stay in the L1 cache.
+static const std::size_t reduce_block_size = 16384;
+
+// Number of independent accumulators for inner-axis reductions, so the loop can be vectorized.
+static const std::size_t reduce_lanes = 8;
+
+// Reduces a contiguous range of 'n' > 0 elements.
+template <typename T, class BinaryOp>
+T reduce_contiguous(const T* src, std::size_t n, BinaryOp op)
+{
+    if (n < reduce_lanes * 2)
+    {
+        T value = src[0];
+        for (std::size_t i = 1; i < n; ++i)
+            value = op(value, src[i]);
+        return value;
+    }
+
+    T lanes[reduce_lanes];
+    for (std::size_t j = 0; j < reduce_lanes; ++j)
+        lanes[j] = src[j];
+
+    const std::size_t vector_end = n - n % reduce_lanes;
+    for (std::size_t i = reduce_lanes; i < vector_end; i += reduce_lanes)
+    {
+        for (std::size_t j = 0; j < reduce_lanes; ++j)
+            lanes[j] = op(lanes[j], src[i + j]);
+    }
+
+    T value = lanes[0];
+    for (std::size_t j = 1; j < reduce_lanes; ++j)
+        value = op(value, lanes[j]);
+
+    for (std::size_t i = vector_end; i < n; ++i)
+        value = op(value, src[i]);
+
+    return value;
+}
+
+// Reduces the row-major array [outer][extent][inner] into [outer][inner].
+template <typename T, class BinaryOp>
+void reduce_row_major(const T* src, T* dst, std::size_t outer, std::size_t extent, std::size_t inner, BinaryOp op)
+{
+    if (inner == 1)
+    {
+        for (std::size_t o = 0; o < outer; ++o)
+            dst[o] = reduce_contiguous(src + o * extent, extent, op);
+    }
+    else
+    {
+        const std::size_t block = std::max(std::size_t(1), reduce_block_size / sizeof(T));
+
+        for (std::size_t o = 0; o < outer; ++o, src += extent * inner, dst += inner)
+        {
+            for (std::size_t first = 0; first < inner; first += block)
+            {
+                const std::size_t last = std::min(first + block, inner);
+
+                std::copy(src + first, src + last, dst + first);
+
+                for (std::size_t k = 1; k < extent; ++k)
+                {
+                    const T* row = src + k * inner;
+                    for (std::size_t i = first; i < last; ++i)
+                        dst[i] = op(dst[i], row[i]);
+                }
+            }
+        }
+    }
+}
+
+// Writes the index of the first maximum along the axis of the row-major array [outer][extent][inner] into [outer][inner].
+template <typename T, class Compare>
+void arg_reduce_row_major(const T* src, std::size_t* dst, std::size_t outer, std::size_t extent, std::size_t inner, Compare comp)
+{
+    if (inner == 1)
+    {
+        for (std::size_t o = 0; o < outer; ++o, src += extent)
+        {
+            std::size_t best = 0;
+            for (std::size_t k = 1; k < extent; ++k)
+            {
+                if (comp(src[best], src[k]))
+                    best = k;
+            }
+            dst[o] = best;
+        }
+    }
+    else
+    {
+        const std::size_t block = std::max(std::size_t(1), reduce_block_size / sizeof(T));
+
+        std::vector<T> values(std::min(block, inner));
+
+        for (std::size_t o = 0; o < outer; ++o, src += extent * inner, dst += inner)
+        {
+            for (std::size_t first = 0; first < inner; first += block)
+            {
+                const std::size_t last = std::min(first + block, inner);
+
+                std::copy(src + first, src + last, values.begin());
+                std::fill(dst + first, dst + last, std::size_t(0));
+
+                for (std::size_t k = 1; k < extent; ++k)
+                {
+                    const T* row = src + k * inner;
+                    for (std::size_t i = first; i < last; ++i)
+                    {
+                        if (comp(values[i - first], row[i]))
+                        {
+                            values[i - first] = row[i];
+                            dst[i] = k;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Returns the offset in the reduced array of the element at the specified indices of the source array.
+template <class Reduced, std::size_t Axis, std::size_t N, std::size_t... Indices>
+std::size_t reduced_flat_index(const std::array<std::size_t, N>& indices, index_sequence<Indices...>)
+{
+    return Reduced::flat_index(indices[(Indices < Axis) ? Indices : Indices + 1]...);
+}
+
+/*
+Reduces an array with any layout: the first pass copies all elements with index 0 along the axis, and the second pass combines the others.
+Since the offsets of all layouts increase with each index, the elements along the axis are combined in ascending order.
+*/
+template <std::size_t Axis, class Reduced, class Array, class Func>
+void reduce_any_layout(const Array& ary, Func func)
+{
+    using index_sequence_type = typename make_index_sequence<(Array::num_dimensions - 1)>::type;
+
+    const auto src = ary.data();
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (std::size_t offset = 0; offset < Array::num_elements; ++offset)
+        {
+            const auto indices = Array::unravel_index(offset);
+            if ((indices[Axis] == 0) == (pass == 0))
+                func(reduced_flat_index<Reduced, Axis>(indices, index_sequence_type()), src[offset], indices[Axis]);
+        }
+    }
+}
+
+
+} // /namespace details
+
+
+/**
+\brief Reduces a multi_array along the dimension 'Axis' with a binary operation.
+\tparam Axis Specifies the index of the dimension that is removed.
+\param[in] ary Specifies the source array. This must have at least 2 dimensions.
+\param[in] op Specifies the binary operation, e.g. std::plus<T>. This must be associative and commutative,
+because inner-axis reductions (along the last dimension) use several independent accumulators.
+\return New array with the same storage and layout policy, but with the dimension 'Axis' removed.
+\remarks Reductions along any other axis are cache-blocked, i.e. a block of the result is combined with all slices along the axis before the next block.
+\code
+// Example usage:
+ext::heap_multi_array<int, 16, 32, 64> histogram;
+auto column_sums = ext::reduce<1>(histogram, std::plus<int>());   // heap_multi_array<int, 16, 64>
+auto row_max     = ext::reduce_max<2>(histogram);                // heap_multi_array<int, 16, 32>
+\endcode
+*/
+template <std::size_t Axis, typename T, class Storage, class Layout, std::size_t... Dimensions, class BinaryOp>
+typename details::reduced_multi_array<T, Storage, Layout, Axis, Dimensions...>::type reduce(
+    const basic_multi_array<T, Storage, Layout, Dimensions...>& ary, BinaryOp op)
+{
+    using array_type    = basic_multi_array<T, Storage, Layout, Dimensions...>;
+    using result_type   = typename details::reduced_multi_array<T, Storage, Layout, Axis, Dimensions...>::type;
+    using shape         = details::reduce_shape<Axis, Dimensions...>;
+
+    result_type result;
+
+    if (array_type::layout_mapping::is_row_major)
+        details::reduce_row_major(ary.data(), result.data(), shape::outer, shape::extent, shape::inner, op);
+    else
+    {
+        auto dst = result.data();
+        details::reduce_any_layout<Axis, result_type>(
+            ary,
+            [&](std::size_t offset, const T& value, std::size_t index)
+            {
+                dst[offset] = (index == 0 ? value : op(dst[offset], value));
+            }
+        );
+    }
+
+    return result;
+}
+
+//! Returns the sums along the dimension 'Axis'. \see reduce
+template <std::size_t Axis, typename T, class Storage, class Layout, std::size_t... Dimensions>
+typename details::reduced_multi_array<T, Storage, Layout, Axis, Dimensions...>::type reduce_sum(
+    const basic_multi_array<T, Storage, Layout, Dimensions...>& ary)
+{
+    return reduce<Axis>(ary, std::plus<T>());
+}
+
+//! Returns the minima along the dimension 'Axis'. \see reduce
+template <std::size_t Axis, typename T, class Storage, class Layout, std::size_t... Dimensions>
+typename details::reduced_multi_array<T, Storage, Layout, Axis, Dimensions...>::type reduce_min(
+    const basic_multi_array<T, Storage, Layout, Dimensions...>& ary)
+{
+    return reduce<Axis>(ary, [](T a, T b) { return (b < a ? b : a); });
+}
+
+//! Returns the maxima along the dimension 'Axis'. \see reduce
+template <std::size_t Axis, typename T, class Storage, class Layout, std::size_t... Dimensions>
+typename details::reduced_multi_array<T, Storage, Layout, Axis, Dimensions...>::type reduce_max(
+    const basic_multi_array<T, Storage, Layout, Dimensions...>& ary)
+{
+    return reduce<Axis>(ary, [](T a, T b) { return (a < b ? b : a); });
+}
+
+/**
+\brief Returns the indices of the maxima along the dimension 'Axis'.
+\return New array of indices with the same storage and layout policy, but with the dimension 'Axis' removed.
+If several elements are equal to the maximum, the first index is returned.
+*/
+template <std::size_t Axis, typename T, class Storage, class Layout, std::size_t... Dimensions>
+typename details::reduced_multi_array<std::size_t, Storage, Layout, Axis, Dimensions...>::type reduce_argmax(
+    const basic_multi_array<T, Storage, Layout, Dimensions...>& ary)
+{
+    using array_type    = basic_multi_array<T, Storage, Layout, Dimensions...>;
+    using result_type   = typename details::reduced_multi_array<std::size_t, Storage, Layout, Axis, Dimensions...>::type;
+    using shape         = details::reduce_shape<Axis, Dimensions...>;
+
+    result_type result;
+
+    if (array_type::layout_mapping::is_row_major)
+        details::arg_reduce_row_major(ary.data(), result.data(), shape::outer, shape::extent, shape::inner, std::less<T>());
+    else
+    {
+        std::vector<T> values(result_type::num_elements);
+        auto dst = result.data();
+        details::reduce_any_layout<Axis, result_type>(
+            ary,
+            [&](std::size_t offset, const T& value, std::size_t index)
+            {
+                if (index == 0 || values[offset] < value)
+                {
+                    values[offset]  = value;
+                    dst[offset]     = index;
+                }
+            }
+        );
+    }
+
+    return result;
+}
+
+
+} // /namespace ext
+
+
+#endif
+
+
+
@@ -0,0 +1,254 @@
+/*
+ * multi_array_storage.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_MULTI_ARRAY_STORAGE_H
+#define CPPLIBEXT_MULTI_ARRAY_STORAGE_H
+
+
+#include "details/aligned_alloc.hpp"
+#include "details/constexpr.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <array>
+
+
+namespace ext
+{
+
+
+/**
+\brief Tag type to construct a multi_array with value-initialized elements (i.e. zeros for arithmetic types).
+\see basic_multi_array
+*/
+struct value_init_tag {};
+
+
+/**
+\brief Storage policy that embeds all elements into the multi_array object itself (like std::array).
+\remarks This is the default storage policy of multi_array.
+\see basic_multi_array
+*/
+struct array_storage
+{
+
+    template <typename T, std::size_t N>
+    class storage
+    {
+
+        public:
+
+            storage() = default;
+
+            constexpr explicit storage(value_init_tag) :
+                data_ {}
+            {
+            }
+
+            CPPLIBEXT_CONSTEXPR14 T* data()
+            {
+                return data_;
+            }
+
+            CPPLIBEXT_CONSTEXPR14 const T* data() const
+            {
+                return data_;
+            }
+
+            void swap(storage& other)
+            {
+                std::swap_ranges(data_, data_ + N, other.data_);
+            }
+
+        private:
+
+            // Plain array instead of std::array, because the non-const accessors of std::array are only constexpr since C++17.
+            T data_[N > 0 ? N : 1];
+
+    };
+
+};
+
+
+/**
+\brief Storage policy that allocates all elements in a single aligned heap allocation.
+\tparam Alignment Specifies the alignment (in bytes) of the first element. This must be a power of two. By default 64, i.e. the size of a cache line.
+\tparam HugePages Specifies whether transparent huge pages are requested for the allocation.
+If enabled and the storage is at least as large as one huge page (2 MiB), the allocation is aligned and padded to huge pages
+and the kernel is advised to back it with huge pages, which reduces TLB misses for large arrays. This is only a hint and ignored on platforms other than Linux.
+\remarks Moving an array with this storage only moves the pointer. The moved-from array has no storage (i.e. data() returns null) until another array is assigned to it.
+\code
+// 512*512*64 floats (64 MiB) on the heap with huge pages:
+ext::basic_multi_array<float, ext::heap_storage<64, true>, ext::row_major_layout, 512, 512, 64> tensor;
+\endcode
+\see basic_multi_array
+*/
+template <std::size_t Alignment = 64, bool HugePages = false>
+struct heap_storage
+{
+
+    static_assert(Alignment > 0 && (Alignment & (Alignment - 1)) == 0, "heap_storage alignment must be a power of two");
+
+    template <typename T, std::size_t N>
+    class storage
+    {
+
+        public:
+
+            storage()
+            {
+                allocate();
+                construct_elements(false);
+            }
+
+            explicit storage(value_init_tag)
+            {
+                allocate();
+                construct_elements(true);
+            }
+
+            storage(const storage& other)
+            {
+                if (other.ptr_)
+                {
+                    allocate();
+                    try
+                    {
+                        std::uninitialized_copy(other.ptr_, other.ptr_ + N, ptr_);
+                    }
+                    catch (...)
+                    {
+                        deallocate();
+                        throw;
+                    }
+                }
+            }
+
+            storage(storage&& other) :
+                ptr_ { other.ptr_ }
+            {
+                other.ptr_ = nullptr;
+            }
+
+            ~storage()
+            {
+                release();
+            }
+
+            storage& operator = (const storage& other)
+            {
+                if (ptr_ && other.ptr_)
+                    std::copy(other.ptr_, other.ptr_ + N, ptr_);
+                else if (this != &other)
+                {
+                    storage tmp(other);
+                    swap(tmp);
+                }
+                return *this;
+            }
+
+            storage& operator = (storage&& other)
+            {
+                swap(other);
+                return *this;
+            }
+
+            T* data()
+            {
+                return ptr_;
+            }
+
+            const T* data() const
+            {
+                return ptr_;
+            }
+
+            void swap(storage& other)
+            {
+                std::swap(ptr_, other.ptr_);
+            }
+
+        private:
+
+            static const std::size_t alignment  = (Alignment > alignof(T) ? Alignment : alignof(T));
+            static const std::size_t data_size  = sizeof(T) * N;
+            static const bool        huge_pages = (HugePages && data_size >= details::huge_page_size);
+
+            // Allocation size and alignment, padded to full huge pages if they are requested.
+            static const std::size_t alloc_size         = (huge_pages ? (data_size + details::huge_page_size - 1) / details::huge_page_size * details::huge_page_size : data_size);
+            static const std::size_t alloc_alignment    = (huge_pages && details::huge_page_size > alignment ? details::huge_page_size : alignment);
+
+            void allocate()
+            {
+                if (alloc_size > 0)
+                {
+                    ptr_ = static_cast<T*>(details::alloc_aligned(alloc_size, (alloc_alignment < sizeof(void*) ? sizeof(void*) : alloc_alignment)));
+                    if (huge_pages)
+                        details::advise_huge_pages(ptr_, alloc_size);
+                }
+            }
+
+            void deallocate()
+            {
+                details::free_aligned(ptr_);
+                ptr_ = nullptr;
+            }
+
+            // Default or value initializes all elements, i.e. with default initialization trivial types are left uninitialized just like in std::array.
+            void construct_elements(bool value_init)
+            {
+                std::size_t i = 0;
+                try
+                {
+                    if (value_init)
+                    {
+                        for (; i < N; ++i)
+                            ::new (static_cast<void*>(ptr_ + i)) T();
+                    }
+                    else
+                    {
+                        for (; i < N; ++i)
+                            ::new (static_cast<void*>(ptr_ + i)) T;
+                    }
+                }
+                catch (...)
+                {
+                    while (i > 0)
+                        ptr_[--i].~T();
+                    deallocate();
+                    throw;
+                }
+            }
+
+            void release()
+            {
+                if (ptr_)
+                {
+                    for (std::size_t i = 0; i < N; ++i)
+                        ptr_[i].~T();
+                    deallocate();
+                }
+            }
+
+        private:
+
+            T* ptr_ = nullptr;
+
+    };
+
+};
+
+
+} // /namespace ext
+
+
+#endif
+
+
@@ -0,0 +1,514 @@
+/*
+ * multi_array_view.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_MULTI_ARRAY_VIEW_H
+#define CPPLIBEXT_MULTI_ARRAY_VIEW_H
+
+
+#include "multi_array.hpp"
+#include "dynamic_multi_array.hpp"
+#include "details/index_sequence.hpp"
+
+#include <initializer_list>
+#include <type_traits>
+#include <algorithm>
+#include <stdexcept>
+#include <iterator>
+#include <cstdlib>
+#include <array>
+
+
+namespace ext
+{
+
+
+/**
+\brief Non-owning view onto multi dimensional data with an individual stride (in elements) for each dimension.
+\tparam T Specifies the data type for the array elements. This may be a const qualified type for read-only views.
+\tparam Rank Specifies the number of dimensions. This must be at least 1.
+\remarks Sub-boxes, transposes, reversed axes, and every-Nth-element views are all expressed by pointer offsets and strides,
+so none of them copies any elements. Strides can be negative (e.g. for reversed axes).
+\code
+ext::multi_array<float, 100, 200, 300> ary;
+auto view = ext::make_multi_array_view(ary);
+
+view.subarray({ 10, 20, 30 }, { 20, 40, 60 }) = 1.0f;  // Fill the sub-box [10, 20) x [20, 40) x [30, 60)
+auto yz = view.transpose(1, 2);                         // yz(x, z, y) == ary(x, y, z)
+auto odd = view.step(2, 2);                             // odd(x, y, z) == ary(x, y, z*2)
+auto rev = view.reverse(0);                             // rev(x, y, z) == ary(99 - x, y, z)
+\endcode
+\see make_multi_array_view
+*/
+template <typename T, std::size_t Rank>
+class multi_array_view
+{
+
+    public:
+
+        static_assert(Rank > 0, "multi_array_view must have at least 1 dimension");
+
+        using value_type        = T;
+        using size_type         = std::size_t;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = value_type&;
+        using pointer           = value_type*;
+
+        using extents_type      = std::array<size_type, Rank>;
+        using strides_type      = std::array<difference_type, Rank>;
+
+        //! Return type of operator[], which is either a view with one dimension less or a reference for 1-dimensional views.
+        using subscript_type    = typename std::conditional<(Rank > 1), multi_array_view<T, (Rank > 1 ? Rank - 1 : 1)>, reference>::type;
+
+        //! Number of dimensions.
+        static const size_type num_dimensions = Rank;
+
+        //! Forward iterator that visits all elements in logical (i.e. row-major index) order.
+        class iterator
+        {
+
+            public:
+
+                using iterator_category = std::forward_iterator_tag;
+                using value_type        = typename std::remove_const<T>::type;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = T*;
+                using reference         = T&;
+
+                iterator() = default;
+
+                reference operator * () const
+                {
+                    return *ptr_;
+                }
+
+                pointer operator -> () const
+                {
+                    return ptr_;
+                }
+
+                iterator& operator ++ ()
+                {
+                    /* Move to next element and carry the index over into the outer dimensions */
+                    for (size_type i = Rank; i > 0; --i)
+                    {
+                        ptr_ += strides_[i - 1];
+                        if (++indices_[i - 1] < extents_[i - 1] || i == 1)
+                            break;
+                        ptr_ -= strides_[i - 1] * static_cast<difference_type>(extents_[i - 1]);
+                        indices_[i - 1] = 0;
+                    }
+                    ++pos_;
+                    return *this;
+                }
+
+                iterator operator ++ (int)
+                {
+                    auto tmp = *this;
+                    operator ++ ();
+                    return tmp;
+                }
+
+                bool operator == (const iterator& rhs) const
+                {
+                    return (pos_ == rhs.pos_);
+                }
+
+                bool operator != (const iterator& rhs) const
+                {
+                    return (pos_ != rhs.pos_);
+                }
+
+            private:
+
+                friend class multi_array_view;
+
+                // Copies the extents and strides, so the iterator remains valid after a temporary view is destroyed.
+                iterator(const multi_array_view& view, size_type pos) :
+                    ptr_     { view.ptr_     },
+                    pos_     { pos           },
+                    extents_ ( view.extents_ ),
+                    strides_ ( view.strides_ )
+                {
+                    indices_.fill(0);
+                }
+
+                pointer         ptr_        = nullptr;
+                size_type       pos_        = 0;
+                extents_type    indices_;
+                extents_type    extents_;
+                strides_type    strides_;
+
+        };
+
+    public:
+
+        multi_array_view() :
+            ptr_ { nullptr }
+        {
+            extents_.fill(0);
+            strides_.fill(0);
+        }
+
+        multi_array_view(pointer ptr, const extents_type& extents, const strides_type& strides) :
+            ptr_     { ptr     },
+            extents_ ( extents ),
+            strides_ ( strides )
+        {
+        }
+
+        //! Constructs a view onto densely packed elements in row-major order.
+        multi_array_view(pointer ptr, const extents_type& extents) :
+            ptr_     { ptr     },
+            extents_ ( extents )
+        {
+            difference_type n = 1;
+            for (size_type i = Rank; i > 0; --i)
+            {
+                strides_[i - 1] = n;
+                n *= static_cast<difference_type>(extents_[i - 1]);
+            }
+        }
+
+        //! Implicit conversion from a mutable view to a read-only view.
+        template <typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type>
+        multi_array_view(const multi_array_view<U, Rank>& other) :
+            ptr_     { other.data()    },
+            extents_ ( other.extents() ),
+            strides_ ( other.strides() )
+        {
+        }
+
+        /* ----- Element access ----- */
+
+        //! Returns a pointer to the first element (i.e. the element at indices 0, 0, ..., 0).
+        pointer data() const
+        {
+            return ptr_;
+        }
+
+        //! Returns a reference to the element at the specified indices.
+        template <typename... Indices>
+        reference operator () (Indices... indices) const
+        {
+            static_assert(sizeof...(Indices) == Rank, "number of indices does not match the number of multi_array_view dimensions");
+            const size_type index_list[] = { static_cast<size_type>(indices)... };
+            return ptr_[offset(index_list)];
+        }
+
+        /**
+        \brief Returns a reference to the element at the specified indices with bounds checking.
+        \throws std::out_of_range If any of the indices is out of range.
+        */
+        template <typename... Indices>
+        reference at(Indices... indices) const
+        {
+            static_assert(sizeof...(Indices) == Rank, "number of indices does not match the number of multi_array_view dimensions");
+            const size_type index_list[] = { static_cast<size_type>(indices)... };
+            for (size_type i = 0; i < Rank; ++i)
+            {
+                if (index_list[i] >= extents_[i])
+                    throw std::out_of_range("multi_array_view::at out of range");
+            }
+            return ptr_[offset(index_list)];
+        }
+
+        //! Returns the view of the slice at the specified index of the first dimension, or the element itself for 1-dimensional views.
+        subscript_type operator [] (const size_type& index) const
+        {
+            return subscript(index, std::integral_constant<bool, (Rank > 1)>());
+        }
+
+        /* ----- Views ----- */
+
+        /**
+        \brief Returns the view of the sub-box [first, last).
+        \throws std::out_of_range If the sub-box is not inside this view.
+        */
+        multi_array_view subarray(const extents_type& first, const extents_type& last) const
+        {
+            multi_array_view result = *this;
+            for (size_type i = 0; i < Rank; ++i)
+            {
+                if (first[i] > last[i] || last[i] > extents_[i])
+                    throw std::out_of_range("multi_array_view::subarray out of range");
+                result.ptr_ += strides_[i] * static_cast<difference_type>(first[i]);
+                result.extents_[i] = last[i] - first[i];
+            }
+            return result;
+        }
+
+        //! Returns the view with the two specified dimensions being swapped.
+        multi_array_view transpose(size_type dimension1, size_type dimension2) const
+        {
+            assert_dimension(dimension1);
+            assert_dimension(dimension2);
+            multi_array_view result = *this;
+            std::swap(result.extents_[dimension1], result.extents_[dimension2]);
+            std::swap(result.strides_[dimension1], result.strides_[dimension2]);
+            return result;
+        }
+
+        //! Returns the view with all dimensions being reversed, i.e. result(i, j, k) == view(k, j, i).
+        multi_array_view transpose() const
+        {
+            multi_array_view result = *this;
+            std::reverse(result.extents_.begin(), result.extents_.end());
+            std::reverse(result.strides_.begin(), result.strides_.end());
+            return result;
+        }
+
+        //! Returns the view with the order of elements along the specified dimension being reversed.
+        multi_array_view reverse(size_type dimension) const
+        {
+            assert_dimension(dimension);
+            multi_array_view result = *this;
+            if (extents_[dimension] > 0)
+                result.ptr_ += strides_[dimension] * static_cast<difference_type>(extents_[dimension] - 1);
+            result.strides_[dimension] = -strides_[dimension];
+            return result;
+        }
+
+        //! Returns the view of every n-th element along the specified dimension.
+        multi_array_view step(size_type dimension, size_type n) const
+        {
+            assert_dimension(dimension);
+            if (n == 0)
+                throw std::invalid_argument("multi_array_view::step must not be zero");
+            multi_array_view result = *this;
+            result.extents_[dimension] = (extents_[dimension] + n - 1) / n;
+            result.strides_[dimension] = strides_[dimension] * static_cast<difference_type>(n);
+            return result;
+        }
+
+        /* ----- Capacity ----- */
+
+        const extents_type& extents() const
+        {
+            return extents_;
+        }
+
+        const strides_type& strides() const
+        {
+            return strides_;
+        }
+
+        //! Returns the number of elements in this view.
+        size_type size() const
+        {
+            size_type n = 1;
+            for (auto e : extents_)
+                n *= e;
+            return n;
+        }
+
+        bool empty() const
+        {
+            return (size() == 0);
+        }
+
+        //! Returns true if the elements of this view are densely packed in row-major order.
+        bool is_contiguous() const
+        {
+            difference_type n = 1;
+            for (size_type i = Rank; i > 0; --i)
+            {
+                if (extents_[i - 1] != 1 && strides_[i - 1] != n)
+                    return false;
+                n *= static_cast<difference_type>(extents_[i - 1]);
+            }
+            return true;
+        }
+
+        /* ----- Iterators ----- */
+
+        iterator begin() const
+        {
+            return iterator(*this, 0);
+        }
+
+        iterator end() const
+        {
+            return iterator(*this, size());
+        }
+
+        /**
+        \brief Calls the specified function for each element in memory order.
+        \remarks The dimensions are visited in the order of decreasing absolute strides, so the innermost loop has the smallest stride.
+        This is much faster than iterating in logical order on transposed views. The order of the visited elements is therefore unspecified.
+        */
+        template <typename UnaryFunction>
+        void for_each(UnaryFunction func) const
+        {
+            if (empty())
+                return;
+
+            /* Sort dimensions by decreasing absolute strides and move reversed dimensions to their lowest address */
+            std::array<size_type, Rank> order;
+            for (size_type i = 0; i < Rank; ++i)
+                order[i] = i;
+
+            std::sort(
+                order.begin(), order.end(),
+                [this](size_type a, size_type b)
+                {
+                    return (std::abs(strides_[a]) > std::abs(strides_[b]));
+                }
+            );
+
+            multi_array_view sorted;
+            sorted.ptr_ = ptr_;
+            for (size_type i = 0; i < Rank; ++i)
+            {
+                auto dim = order[i];
+                sorted.extents_[i] = extents_[dim];
+                sorted.strides_[i] = strides_[dim];
+                if (strides_[dim] < 0)
+                {
+                    sorted.ptr_ += strides_[dim] * static_cast<difference_type>(extents_[dim] - 1);
+                    sorted.strides_[i] = -strides_[dim];
+                }
+            }
+
+            sorted.for_each_ordered(sorted.ptr_, 0, func);
+        }
+
+        //! Fills all elements of this view with the specified value.
+        void fill(const typename std::remove_const<T>::type& value) const
+        {
+            for_each(
+                [&value](reference elem)
+                {
+                    elem = value;
+                }
+            );
+        }
+
+        //! \see fill
+        const multi_array_view& operator = (const typename std::remove_const<T>::type& value) const
+        {
+            fill(value);
+            return *this;
+        }
+
+    private:
+
+        template <typename U, std::size_t R>
+        friend class multi_array_view;
+
+        void assert_dimension(size_type dimension) const
+        {
+            if (dimension >= Rank)
+                throw std::out_of_range("multi_array_view dimension out of range");
+        }
+
+        difference_type offset(const size_type (&indices)[Rank]) const
+        {
+            difference_type result = 0;
+            for (size_type i = 0; i < Rank; ++i)
+                result += strides_[i] * static_cast<difference_type>(indices[i]);
+            return result;
+        }
+
+        subscript_type subscript(size_type index, std::true_type) const
+        {
+            subscript_type result;
+            result.ptr_ = ptr_ + strides_[0] * static_cast<difference_type>(index);
+            std::copy(extents_.begin() + 1, extents_.end(), result.extents_.begin());
+            std::copy(strides_.begin() + 1, strides_.end(), result.strides_.begin());
+            return result;
+        }
+
+        subscript_type subscript(size_type index, std::false_type) const
+        {
+            return ptr_[strides_[0] * static_cast<difference_type>(index)];
+        }
+
+        template <typename UnaryFunction>
+        void for_each_ordered(pointer ptr, size_type dimension, UnaryFunction& func) const
+        {
+            const auto n = extents_[dimension];
+            const auto s = strides_[dimension];
+            if (dimension + 1 == Rank)
+            {
+                /* Innermost loop with the smallest stride */
+                for (size_type i = 0; i < n; ++i, ptr += s)
+                    func(*ptr);
+            }
+            else
+            {
+                for (size_type i = 0; i < n; ++i, ptr += s)
+                    for_each_ordered(ptr, dimension + 1, func);
+            }
+        }
+
+    private:
+
+        pointer         ptr_;
+        extents_type    extents_;
+        strides_type    strides_;
+
+};
+
+
+/* ----- Factory functions ----- */
+
+// This namespace is only used internally
+namespace details
+{
+
+// Returns the strides of all dimensions of a strided layout mapping.
+template <class Mapping, std::size_t... Indices>
+std::array<std::ptrdiff_t, sizeof...(Indices)> layout_strides(index_sequence<Indices...>)
+{
+    return {{ static_cast<std::ptrdiff_t>(Mapping::template stride<Indices>())... }};
+}
+
+} // /namespace details
+
+//! \remarks Only multi_array types with a strided layout (row_major_layout or column_major_layout) can be viewed.
+template <typename T, class Storage, class Layout, std::size_t... Dimensions>
+multi_array_view<T, sizeof...(Dimensions)> make_multi_array_view(basic_multi_array<T, Storage, Layout, Dimensions...>& ary)
+{
+    using mapping = typename basic_multi_array<T, Storage, Layout, Dimensions...>::layout_mapping;
+    static_assert(mapping::is_strided, "multi_array_view requires a strided multi_array layout");
+    return multi_array_view<T, sizeof...(Dimensions)>(
+        ary.data(), {{ Dimensions... }}, details::layout_strides<mapping>(typename details::make_index_sequence<sizeof...(Dimensions)>::type())
+    );
+}
+
+template <typename T, class Storage, class Layout, std::size_t... Dimensions>
+multi_array_view<const T, sizeof...(Dimensions)> make_multi_array_view(const basic_multi_array<T, Storage, Layout, Dimensions...>& ary)
+{
+    using mapping = typename basic_multi_array<T, Storage, Layout, Dimensions...>::layout_mapping;
+    static_assert(mapping::is_strided, "multi_array_view requires a strided multi_array layout");
+    return multi_array_view<const T, sizeof...(Dimensions)>(
+        ary.data(), {{ Dimensions... }}, details::layout_strides<mapping>(typename details::make_index_sequence<sizeof...(Dimensions)>::type())
+    );
+}
+
+template <typename T, std::size_t Rank, class Alloc>
+multi_array_view<T, Rank> make_multi_array_view(dynamic_multi_array<T, Rank, Alloc>& ary)
+{
+    return multi_array_view<T, Rank>(ary.data(), ary.extents());
+}
+
+template <typename T, std::size_t Rank, class Alloc>
+multi_array_view<const T, Rank> make_multi_array_view(const dynamic_multi_array<T, Rank, Alloc>& ary)
+{
+    return multi_array_view<const T, Rank>(ary.data(), ary.extents());
+}
+
+
+} // /namespace ext
+
+
+#endif
+
+
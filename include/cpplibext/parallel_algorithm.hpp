@@ -0,0 +1,380 @@
+/*
+ * parallel_algorithm.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_PARALLEL_ALGORITHM_H
+#define CPPLIBEXT_PARALLEL_ALGORITHM_H
+
+
+#include "thread_pool.hpp"
+#include "multi_array.hpp"
+#include "grid_vector.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+// This namespace is only used internally
+namespace details
+{
+
+
+/*
+Maximal number of chunks the elements are split into.
+This does not depend on the number of threads, so the order of parallel_reduce is the same on every machine.
+*/
+static const std::size_t parallel_max_chunks = 64;
+
+/*
+Partial result of one chunk in its own cache line, so the workers neither write to the same word
+(e.g. the packed bits of std::vector<bool>) nor share a cache line with their neighbors.
+*/
+template <typename T>
+struct alignas(64) parallel_partial
+{
+    T value;
+};
+
+/*
+Range of elements with the number of slices along its outermost dimension.
+The elements are stored in rows of 'row_size' elements with a distance of 'row_pitch' elements.
+For contiguous ranges, 'row_size' and 'row_pitch' are both equal to 'size'.
+*/
+template <typename T>
+struct parallel_range
+{
+    T*          data;
+    std::size_t size;
+    std::size_t outer_extent;
+    std::size_t row_size;
+    std::size_t row_pitch;
+};
+
+template <typename T, class Storage, class Layout, std::size_t... Dimensions>
+parallel_range<T> make_parallel_range(basic_multi_array<T, Storage, Layout, Dimensions...>& ary)
+{
+    return { ary.data(), ary.size(), ary.template slices<0>(), ary.size(), ary.size() };
+}
+
+template <typename T, class Storage, class Layout, std::size_t... Dimensions>
+parallel_range<const T> make_parallel_range(const basic_multi_array<T, Storage, Layout, Dimensions...>& ary)
+{
+    return { ary.data(), ary.size(), ary.template slices<0>(), ary.size(), ary.size() };
+}
+
+// The rows of grid_vector are its outermost dimension (i.e. the y-axis), and they may be padded.
+template <typename T, class Alloc, class Tracking, class Padding>
+parallel_range<T> make_parallel_range(grid_vector<T, Alloc, Tracking, Padding>& grid)
+{
+    return { grid.data(), grid.width() * grid.height(), grid.height(), grid.width(), grid.pitch() };
+}
+
+template <typename T, class Alloc, class Tracking, class Padding>
+parallel_range<const T> make_parallel_range(const grid_vector<T, Alloc, Tracking, Padding>& grid)
+{
+    return { grid.data(), grid.width() * grid.height(), grid.height(), grid.width(), grid.pitch() };
+}
+
+// Slices of multi_array, i.e. the return values of "ary[i]" or "ary[i][j]".
+template <class Slice>
+auto make_parallel_range(const Slice& slice) -> parallel_range<typename std::remove_pointer<decltype(slice.data(), Slice::extent(), slice.data())>::type>
+{
+    static_assert(Slice::is_contiguous, "parallel algorithms on multi_array slices require row_major_layout");
+    return { slice.data(), Slice::size(), Slice::extent(), Slice::size(), Slice::size() };
+}
+
+// Reports the writes through the storage pointer to the dirty tracking of grid_vector.
+template <class Container>
+void mark_written(const Container&)
+{
+}
+
+template <typename T, class Alloc, class Tracking, class Padding>
+void mark_written(grid_vector<T, Alloc, Tracking, Padding>& grid)
+{
+    grid.mark_dirty(0, 0, grid.width(), grid.height());
+}
+
+// Returns the number of chunks, which only depends on the outermost dimension.
+template <typename T>
+std::size_t parallel_num_chunks(const parallel_range<T>& range)
+{
+    return (range.size == 0 || range.outer_extent == 0 ? 0 : std::min(range.outer_extent, parallel_max_chunks));
+}
+
+/*
+Calls 'func(index, offset, count)' for each contiguous run of the elements [first, last) of the range,
+where 'index' is the index of the first element of the run and 'offset' is its offset in the storage.
+*/
+template <typename T, class Func>
+void parallel_segments(const parallel_range<T>& range, std::size_t first, std::size_t last, Func func)
+{
+    if (range.row_size == range.row_pitch)
+    {
+        if (first < last)
+            func(first, first, last - first);
+    }
+    else
+    {
+        while (first < last)
+        {
+            const std::size_t column = first % range.row_size;
+            const std::size_t count  = std::min(range.row_size - column, last - first);
+            func(first, (first / range.row_size) * range.row_pitch + column, count);
+            first += count;
+        }
+    }
+}
+
+// Splits the range along its outermost dimension and calls 'func(chunk, first, last)' for each chunk on the thread pool.
+template <typename T, class Func>
+void parallel_chunks(thread_pool& pool, const parallel_range<T>& range, Func func)
+{
+    const std::size_t num_chunks = parallel_num_chunks(range);
+    if (num_chunks == 0)
+        return;
+
+    const std::size_t slice_size = range.size / range.outer_extent;
+
+    pool.run(
+        num_chunks,
+        [&](std::size_t chunk)
+        {
+            const std::size_t first = (range.outer_extent * chunk / num_chunks) * slice_size;
+            const std::size_t last  = (range.outer_extent * (chunk + 1) / num_chunks) * slice_size;
+            func(chunk, first, last);
+        }
+    );
+}
+
+
+} // /namespace details
+
+
+/**
+\brief Calls 'func' for each element of a multi_array, a grid_vector, or a multi_array slice in parallel.
+\param[in] pool Specifies the thread pool that executes the work.
+\param[in,out] container Specifies the container. The elements are split along the outermost dimension.
+\param[in] func Specifies the function that is called with a reference to each element.
+\remarks The order in which the elements are visited is unspecified. Slices of multi_array require row_major_layout.
+If the dirty tracking of a grid_vector is enabled, the entire grid is marked as dirty afterwards.
+\code
+// Example usage:
+ext::heap_multi_array<float, 1024, 1024, 64> volume;
+ext::parallel_for_each(volume, [](float& x) { x = 1.0f; });
+ext::parallel_for_each(volume[3], [](float& x) { x *= 2.0f; });
+\endcode
+*/
+template <class Container, class Func>
+void parallel_for_each(thread_pool& pool, Container&& container, Func func)
+{
+    auto range = details::make_parallel_range(container);
+    details::parallel_chunks(
+        pool, range,
+        [&](std::size_t, std::size_t first, std::size_t last)
+        {
+            details::parallel_segments(
+                range, first, last,
+                [&](std::size_t, std::size_t offset, std::size_t count)
+                {
+                    for (auto it = range.data + offset, end = it + count; it != end; ++it)
+                        func(*it);
+                }
+            );
+        }
+    );
+    details::mark_written(container);
+}
+
+//! \see parallel_for_each(thread_pool&, Container&&, Func)
+template <class Container, class Func>
+void parallel_for_each(Container&& container, Func func)
+{
+    parallel_for_each(default_thread_pool(), std::forward<Container>(container), func);
+}
+
+//! Assigns 'value' to all elements in parallel. \see parallel_for_each
+template <class Container, typename T>
+void parallel_fill(thread_pool& pool, Container&& container, const T& value)
+{
+    auto range = details::make_parallel_range(container);
+    details::parallel_chunks(
+        pool, range,
+        [&](std::size_t, std::size_t first, std::size_t last)
+        {
+            details::parallel_segments(
+                range, first, last,
+                [&](std::size_t, std::size_t offset, std::size_t count)
+                {
+                    std::fill(range.data + offset, range.data + offset + count, value);
+                }
+            );
+        }
+    );
+    details::mark_written(container);
+}
+
+//! \see parallel_fill(thread_pool&, Container&&, const T&)
+template <class Container, typename T>
+void parallel_fill(Container&& container, const T& value)
+{
+    parallel_fill(default_thread_pool(), std::forward<Container>(container), value);
+}
+
+/**
+\brief Writes 'func(x)' for each element x of the source into the element at the same offset of the destination in parallel.
+\throws std::invalid_argument If the source and destination do not have the same number of elements.
+\remarks The elements are matched by their index in the storage order (skipping the padding of grid_vector rows), so both containers should have the same layout.
+*/
+template <class SrcContainer, class DstContainer, class Func>
+void parallel_transform(thread_pool& pool, SrcContainer&& src, DstContainer&& dst, Func func)
+{
+    auto src_range = details::make_parallel_range(src);
+    auto dst_range = details::make_parallel_range(dst);
+
+    if (src_range.size != dst_range.size)
+        throw std::invalid_argument("parallel_transform source and destination have different number of elements");
+
+    details::parallel_chunks(
+        pool, dst_range,
+        [&](std::size_t, std::size_t first, std::size_t last)
+        {
+            details::parallel_segments(
+                dst_range, first, last,
+                [&](std::size_t dst_index, std::size_t dst_offset, std::size_t dst_count)
+                {
+                    details::parallel_segments(
+                        src_range, dst_index, dst_index + dst_count,
+                        [&](std::size_t src_index, std::size_t src_offset, std::size_t count)
+                        {
+                            auto dst = dst_range.data + dst_offset + (src_index - dst_index);
+                            auto src = src_range.data + src_offset;
+                            for (std::size_t i = 0; i < count; ++i)
+                                dst[i] = func(src[i]);
+                        }
+                    );
+                }
+            );
+        }
+    );
+    details::mark_written(dst);
+}
+
+//! \see parallel_transform(thread_pool&, SrcContainer&&, DstContainer&&, Func)
+template <class SrcContainer, class DstContainer, class Func>
+void parallel_transform(SrcContainer&& src, DstContainer&& dst, Func func)
+{
+    parallel_transform(default_thread_pool(), std::forward<SrcContainer>(src), std::forward<DstContainer>(dst), func);
+}
+
+/**
+\brief Calls 'func(row, y)' for each row of a grid_vector in parallel, where 'row' is a grid_row view of the width() elements of row 'y'.
+\remarks The rows are split into blocks of consecutive rows (see grid_rows::split), so each call can use the neighbouring rows of the grid as well.
+For a mutable grid with dirty tracking, all rows are marked as dirty.
+\code
+// Example usage:
+ext::parallel_for_each_row(
+    image,
+    [](ext::grid_row<float> row, std::size_t y)
+    {
+        for (auto& x : row)
+            x *= 0.5f;
+    }
+);
+\endcode
+*/
+template <class Grid, class Func>
+void parallel_for_each_row(thread_pool& pool, Grid&& grid, Func func)
+{
+    const auto rows = grid.rows();
+    const std::size_t num_chunks = std::min(rows.size(), details::parallel_max_chunks);
+    pool.run(
+        num_chunks,
+        [&](std::size_t chunk)
+        {
+            const auto block = rows.split(chunk, num_chunks);
+            for (auto it = block.begin(), end = block.end(); it != end; ++it)
+                func(*it, it.y());
+        }
+    );
+}
+
+//! \see parallel_for_each_row(thread_pool&, Grid&&, Func)
+template <class Grid, class Func>
+void parallel_for_each_row(Grid&& grid, Func func)
+{
+    parallel_for_each_row(default_thread_pool(), std::forward<Grid>(grid), func);
+}
+
+/**
+\brief Reduces all elements with the binary operation 'op' in parallel, like std::accumulate.
+\param[in] init Specifies the initial value. The result has the same type.
+\param[in] op Specifies the binary operation. This must be associative, but it does not need to be commutative.
+\remarks The elements are reduced in chunks along the outermost dimension, and the partial results are combined in ascending order.
+The chunks do not depend on the number of threads, so floating-point results are the same for every thread pool.
+\code
+// Example usage:
+float sum = ext::parallel_reduce(volume, 0.0f, std::plus<float>());
+\endcode
+*/
+template <class Container, typename T, class BinaryOp>
+T parallel_reduce(thread_pool& pool, Container&& container, T init, BinaryOp op)
+{
+    auto range = details::make_parallel_range(container);
+
+    std::vector<details::parallel_partial<T>> partials(details::parallel_num_chunks(range), details::parallel_partial<T>{ init });
+
+    details::parallel_chunks(
+        pool, range,
+        [&](std::size_t chunk, std::size_t first, std::size_t last)
+        {
+            T value = init;
+            details::parallel_segments(
+                range, first, last,
+                [&](std::size_t index, std::size_t offset, std::size_t count)
+                {
+                    auto it = range.data + offset, end = it + count;
+                    if (index == first)
+                        value = *it++;
+                    for (; it != end; ++it)
+                        value = op(value, *it);
+                }
+            );
+            partials[chunk].value = value;
+        }
+    );
+
+    for (const auto& partial : partials)
+        init = op(init, partial.value);
+
+    return init;
+}
+
+//! \see parallel_reduce(thread_pool&, Container&&, T, BinaryOp)
+template <class Container, typename T, class BinaryOp>
+T parallel_reduce(Container&& container, T init, BinaryOp op)
+{
+    return parallel_reduce(default_thread_pool(), std::forward<Container>(container), init, op);
+}
+
+
+} // /namespace ext
+
+
+#endif
+
+
+
@@ -0,0 +1,726 @@
+/*
+ * small_vector.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_SMALL_VECTOR_H
+#define CPPLIBEXT_SMALL_VECTOR_H
+
+
+#include "details/constexpr.hpp"
+
+#include <iterator>
+#include <algorithm>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <new>
+#include <cstring>
+
+
+namespace ext
+{
+
+
+/**
+\brief Trait for types whose objects can be moved to another address with std::memcpy, without calling the move constructor and destructor.
+\remarks By default, this is true for trivially copyable types. It can be specialized for other types,
+e.g. for types which only hold a pointer to heap memory and do not refer to their own address.
+*/
+template <typename T>
+struct is_trivially_relocatable : std::integral_constant<bool, std::is_trivially_copyable<T>::value> {};
+
+
+// This namespace is only used internally
+namespace details
+{
+
+
+// Same as std::allocator_traits<Alloc>::is_always_equal of C++17, which defaults to std::is_empty<Alloc> (e.g. for std::allocator).
+#if CPPLIBEXT_CPLUSPLUS >= 201703L
+template <class Alloc>
+using allocator_is_always_equal = typename std::allocator_traits<Alloc>::is_always_equal;
+#else
+template <class Alloc>
+using allocator_is_always_equal = std::is_empty<Alloc>;
+#endif
+
+
+} // /namespace details
+
+
+/**
+\brief Vector with an inline capacity of N elements, which only allocates heap memory when more than N elements are stored.
+\remarks The interface is compatible to local_vector, but the capacity grows geometrically on the heap beyond N elements.
+Moving a vector with inline elements uses std::memcpy for trivially relocatable types (see is_trivially_relocatable),
+while moving a vector with heap memory only moves the pointer.
+\code
+// Example usage:
+ext::small_vector<int, 8> list;
+for (int i = 0; i < 8; ++i)
+    list.push_back(i);  // No allocation
+list.push_back(8);      // Moves all elements to the heap with a capacity of 16
+\endcode
+*/
+template <typename T, std::size_t N, class Alloc = std::allocator<T>>
+class small_vector
+{
+
+        static_assert(N > 0, "inline capacity of small_vector must be greater than zero");
+
+        using alloc_traits = std::allocator_traits<Alloc>;
+
+        // Specifies whether a move assignment can take the heap memory of the other vector, i.e. it never allocates.
+        using is_move_stealing = std::integral_constant<
+            bool,
+            alloc_traits::propagate_on_container_move_assignment::value || details::allocator_is_always_equal<Alloc>::value
+        >;
+
+    public:
+
+        using value_type                = T;
+        using allocator_type            = Alloc;
+        using size_type                 = std::size_t;
+        using difference_type           = std::ptrdiff_t;
+        using reference                 = value_type&;
+        using const_reference           = const value_type&;
+        using pointer                   = value_type*;
+        using const_pointer             = const value_type*;
+        using iterator                  = pointer;
+        using const_iterator            = const_pointer;
+        using reverse_iterator          = std::reverse_iterator<iterator>;
+        using const_reverse_iterator    = std::reverse_iterator<const_iterator>;
+
+    public:
+
+        small_vector() = default;
+
+        explicit small_vector(const allocator_type& alloc) :
+            alloc_ { alloc }
+        {
+        }
+
+        explicit small_vector(size_type count, const allocator_type& alloc = allocator_type()) :
+            alloc_ { alloc }
+        {
+            resize(count);
+        }
+
+        explicit small_vector(size_type count, const value_type& value, const allocator_type& alloc = allocator_type()) :
+            alloc_ { alloc }
+        {
+            resize(count, value);
+        }
+
+        small_vector(const small_vector& other) :
+            alloc_ { alloc_traits::select_on_container_copy_construction(other.alloc_) }
+        {
+            append(other.begin(), other.end());
+        }
+
+        small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible<T>::value) :
+            alloc_ { std::move(other.alloc_) }
+        {
+            steal(other);
+        }
+
+        small_vector(std::initializer_list<T> init, const allocator_type& alloc = allocator_type()) :
+            alloc_ { alloc }
+        {
+            append(init.begin(), init.end());
+        }
+
+        template <typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+        small_vector(InputIt first, InputIt last, const allocator_type& alloc = allocator_type()) :
+            alloc_ { alloc }
+        {
+            append(first, last);
+        }
+
+        ~small_vector()
+        {
+            clear();
+            release();
+        }
+
+        small_vector& operator = (const small_vector& rhs)
+        {
+            if (this != &rhs)
+            {
+                clear();
+                copy_assign_alloc(rhs, typename alloc_traits::propagate_on_container_copy_assignment());
+                append(rhs.begin(), rhs.end());
+            }
+            return *this;
+        }
+
+        /**
+        \brief Takes the elements of the other vector. The heap memory of the other vector is taken over
+        if the allocator propagates on move assignment or if the allocators compare equal, otherwise the elements are moved one by one.
+        */
+        small_vector& operator = (small_vector&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value && is_move_stealing::value)
+        {
+            if (this != &rhs)
+            {
+                clear();
+                move_assign(rhs, is_move_stealing());
+            }
+            return *this;
+        }
+
+        small_vector& operator = (std::initializer_list<T> init)
+        {
+            assign(init.begin(), init.end());
+            return *this;
+        }
+
+        //! Replaces the elements with 'count' copies of 'value'.
+        void assign(size_type count, const value_type& value)
+        {
+            value_type copy(value);
+            clear();
+            resize(count, copy);
+        }
+
+        //! Replaces the elements with copies of the elements [first, last), which must not refer to this vector.
+        template <typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+        void assign(InputIt first, InputIt last)
+        {
+            clear();
+            append(first, last);
+        }
+
+        void assign(std::initializer_list<T> init)
+        {
+            assign(init.begin(), init.end());
+        }
+
+        allocator_type get_allocator() const
+        {
+            return alloc_;
+        }
+
+        /* ----- Element access ----- */
+
+        reference front() noexcept
+        {
+            return data_[0];
+        }
+
+        const_reference front() const noexcept
+        {
+            return data_[0];
+        }
+
+        reference back() noexcept
+        {
+            return data_[size_ - 1];
+        }
+
+        const_reference back() const noexcept
+        {
+            return data_[size_ - 1];
+        }
+
+        pointer data() noexcept
+        {
+            return data_;
+        }
+
+        const_pointer data() const noexcept
+        {
+            return data_;
+        }
+
+        /* ----- Iterators ----- */
+
+        iterator begin() noexcept
+        {
+            return data_;
+        }
+
+        const_iterator begin() const noexcept
+        {
+            return data_;
+        }
+
+        const_iterator cbegin() const noexcept
+        {
+            return data_;
+        }
+
+        iterator end() noexcept
+        {
+            return data_ + size_;
+        }
+
+        const_iterator end() const noexcept
+        {
+            return data_ + size_;
+        }
+
+        const_iterator cend() const noexcept
+        {
+            return data_ + size_;
+        }
+
+        reverse_iterator rbegin() noexcept
+        {
+            return reverse_iterator { end() };
+        }
+
+        const_reverse_iterator rbegin() const noexcept
+        {
+            return const_reverse_iterator { end() };
+        }
+
+        const_reverse_iterator crbegin() const noexcept
+        {
+            return const_reverse_iterator { cend() };
+        }
+
+        reverse_iterator rend() noexcept
+        {
+            return reverse_iterator { begin() };
+        }
+
+        const_reverse_iterator rend() const noexcept
+        {
+            return const_reverse_iterator { begin() };
+        }
+
+        const_reverse_iterator crend() const noexcept
+        {
+            return const_reverse_iterator { cbegin() };
+        }
+
+        /* ----- Capacity ----- */
+
+        bool empty() const noexcept
+        {
+            return (size_ == 0);
+        }
+
+        size_type size() const noexcept
+        {
+            return size_;
+        }
+
+        size_type max_size() const noexcept
+        {
+            return alloc_traits::max_size(alloc_);
+        }
+
+        //! Moves the elements to the heap with a capacity of at least 'new_cap' elements, if this exceeds the current capacity.
+        void reserve(size_type new_cap)
+        {
+            if (new_cap > capacity_)
+                reallocate(new_cap);
+        }
+
+        size_type capacity() const noexcept
+        {
+            return capacity_;
+        }
+
+        //! Returns true if the elements are stored inline, i.e. no heap memory is allocated.
+        bool is_inline() const noexcept
+        {
+            return (data_ == inline_data());
+        }
+
+        //! Moves the elements back into the inline storage if they fit, or into a heap buffer of exactly size() elements otherwise.
+        void shrink_to_fit()
+        {
+            if (!is_inline() && size_ < capacity_)
+                reallocate(size_);
+        }
+
+        /* ----- Modifiers ----- */
+
+        //! Destroys all elements. The capacity remains unchanged.
+        void clear()
+        {
+            destroy(begin(), end());
+            size_ = 0;
+        }
+
+        iterator insert(const_iterator pos, const value_type& value)
+        {
+            return emplace(pos, value);
+        }
+
+        iterator insert(const_iterator pos, value_type&& value)
+        {
+            return emplace(pos, std::move(value));
+        }
+
+        /**
+        \brief Inserts copies of the elements [first, last) in front of 'pos' and returns an iterator to the first inserted element.
+        \remarks The range must not refer to this vector. For forward iterators, the capacity grows at most once.
+        */
+        template <typename InputIt, typename = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+        iterator insert(const_iterator pos, InputIt first, InputIt last)
+        {
+            const auto index = pos - begin();
+            const auto old_size = size_;
+            try
+            {
+                append_range(first, last, typename std::iterator_traits<InputIt>::iterator_category());
+            }
+            catch (...)
+            {
+                destroy(begin() + old_size, end());
+                size_ = old_size;
+                throw;
+            }
+            std::rotate(begin() + index, begin() + old_size, end());
+            return begin() + index;
+        }
+
+        iterator insert(const_iterator pos, std::initializer_list<T> init)
+        {
+            return insert(pos, init.begin(), init.end());
+        }
+
+        /**
+        \brief Constructs a new element in front of 'pos' and returns an iterator to the new element.
+        \remarks The elements after 'pos' are moved one position to the right.
+        */
+        template <typename... Args>
+        iterator emplace(const_iterator pos, Args&&... args)
+        {
+            const auto index = pos - begin();
+
+            if (pos == end())
+                emplace_back(std::forward<Args>(args)...);
+            else
+            {
+                /* Construct the element first, since the arguments might refer to elements of this vector */
+                value_type value(std::forward<Args>(args)...);
+
+                /* Move the last element to the new end, and everything after 'pos' to its right */
+                emplace_back(std::move(back()));
+                std::move_backward(begin() + index, end() - 2, end() - 1);
+
+                begin()[index] = std::move(value);
+            }
+
+            return begin() + index;
+        }
+
+        //! Removes the element at 'pos' and returns an iterator to the element after it.
+        iterator erase(const_iterator pos)
+        {
+            return erase(pos, pos + 1);
+        }
+
+        //! Removes the elements [first, last) and returns an iterator to the element after them.
+        iterator erase(const_iterator first, const_iterator last)
+        {
+            auto dst = begin() + (first - begin());
+            if (first != last)
+            {
+                auto new_end = std::move(begin() + (last - begin()), end(), dst);
+                destroy(new_end, end());
+                size_ = static_cast<size_type>(new_end - begin());
+            }
+            return dst;
+        }
+
+        void push_back(const value_type& value)
+        {
+            emplace_back(value);
+        }
+
+        void push_back(value_type&& value)
+        {
+            emplace_back(std::move(value));
+        }
+
+        //! Constructs a new element at the end and returns a reference to it. If the capacity is exceeded, the capacity is doubled.
+        template <typename... Args>
+        reference emplace_back(Args&&... args)
+        {
+            if (size_ == capacity_)
+                return emplace_back_grow(std::forward<Args>(args)...);
+            alloc_traits::construct(alloc_, end(), std::forward<Args>(args)...);
+            ++size_;
+            return back();
+        }
+
+        void pop_back()
+        {
+            --size_;
+            alloc_traits::destroy(alloc_, end());
+        }
+
+        void resize(size_type count)
+        {
+            if (count > capacity_)
+                reallocate(grown_capacity(count));
+            while (size_ > count)
+                pop_back();
+            while (size_ < count)
+                emplace_back();
+        }
+
+        void resize(size_type count, const value_type& value)
+        {
+            if (count > capacity_)
+            {
+                /* Copy the value first, since it might refer to an element of this vector */
+                value_type copy(value);
+                reallocate(grown_capacity(count));
+                resize(count, copy);
+                return;
+            }
+            while (size_ > count)
+                pop_back();
+            while (size_ < count)
+                emplace_back(value);
+        }
+
+    private:
+
+        pointer inline_data() noexcept
+        {
+            return reinterpret_cast<pointer>(storage_);
+        }
+
+        const_pointer inline_data() const noexcept
+        {
+            return reinterpret_cast<const_pointer>(storage_);
+        }
+
+        // Returns the capacity for at least 'required' elements with geometric growth.
+        size_type grown_capacity(size_type required) const
+        {
+            return std::max(capacity_ * 2, required);
+        }
+
+        // Moves the 'count' elements from 'src' into the uninitialized storage 'dst' and destroys the source elements.
+        void relocate(pointer src, size_type count, pointer dst)
+        {
+            if (is_trivially_relocatable<value_type>::value)
+            {
+                if (count > 0)
+                    std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), count * sizeof(value_type));
+            }
+            else
+            {
+                size_type i = 0;
+                try
+                {
+                    for (; i < count; ++i)
+                        alloc_traits::construct(alloc_, dst + i, std::move_if_noexcept(src[i]));
+                }
+                catch (...)
+                {
+                    destroy(dst, dst + i);
+                    throw;
+                }
+                destroy(src, src + count);
+            }
+        }
+
+        // Moves the elements into the inline storage if 'new_cap' does not exceed N, or into a new heap buffer otherwise.
+        void reallocate(size_type new_cap)
+        {
+            if (new_cap <= N)
+            {
+                if (!is_inline())
+                {
+                    relocate(data_, size_, inline_data());
+                    alloc_traits::deallocate(alloc_, data_, capacity_);
+                    data_       = inline_data();
+                    capacity_   = N;
+                }
+                return;
+            }
+
+            auto new_data = alloc_traits::allocate(alloc_, new_cap);
+            try
+            {
+                relocate(data_, size_, new_data);
+            }
+            catch (...)
+            {
+                alloc_traits::deallocate(alloc_, new_data, new_cap);
+                throw;
+            }
+            release();
+            data_       = new_data;
+            capacity_   = new_cap;
+        }
+
+        // Grows the capacity and constructs the new element before the previous elements are moved, since the arguments might refer to them.
+        template <typename... Args>
+        reference emplace_back_grow(Args&&... args)
+        {
+            const auto new_cap = grown_capacity(size_ + 1);
+            auto new_data = alloc_traits::allocate(alloc_, new_cap);
+            try
+            {
+                alloc_traits::construct(alloc_, new_data + size_, std::forward<Args>(args)...);
+                try
+                {
+                    relocate(data_, size_, new_data);
+                }
+                catch (...)
+                {
+                    alloc_traits::destroy(alloc_, new_data + size_);
+                    throw;
+                }
+            }
+            catch (...)
+            {
+                alloc_traits::deallocate(alloc_, new_data, new_cap);
+                throw;
+            }
+            release();
+            data_       = new_data;
+            capacity_   = new_cap;
+            ++size_;
+            return back();
+        }
+
+        // Deallocates the heap memory (if any) without destroying the elements.
+        void release()
+        {
+            if (!is_inline())
+            {
+                alloc_traits::deallocate(alloc_, data_, capacity_);
+                data_       = inline_data();
+                capacity_   = N;
+            }
+        }
+
+        // Replaces the allocator with the allocator of the other vector. The heap memory must be released with the previous allocator first.
+        void copy_assign_alloc(const small_vector& other, std::true_type)
+        {
+            if (alloc_ != other.alloc_)
+                release();
+            alloc_ = other.alloc_;
+        }
+
+        void copy_assign_alloc(const small_vector&, std::false_type)
+        {
+        }
+
+        void move_assign_alloc(small_vector& other, std::true_type)
+        {
+            alloc_ = std::move(other.alloc_);
+        }
+
+        void move_assign_alloc(small_vector&, std::false_type)
+        {
+        }
+
+        // Takes the heap memory of the other vector, which never allocates.
+        void move_assign(small_vector& other, std::true_type)
+        {
+            release();
+            move_assign_alloc(other, typename alloc_traits::propagate_on_container_move_assignment());
+            steal(other);
+        }
+
+        // Takes the heap memory only if the allocators compare equal, otherwise the elements are moved into memory of this allocator.
+        void move_assign(small_vector& other, std::false_type)
+        {
+            if (alloc_ == other.alloc_)
+                move_assign(other, std::true_type());
+            else
+            {
+                append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+                other.clear();
+            }
+        }
+
+        // Takes the elements of the other vector, while this vector must be empty. The other vector is left empty with inline storage.
+        void steal(small_vector& other)
+        {
+            if (other.is_inline())
+            {
+                relocate(other.data_, other.size_, inline_data());
+                size_ = other.size_;
+            }
+            else
+            {
+                data_           = other.data_;
+                size_           = other.size_;
+                capacity_       = other.capacity_;
+                other.data_     = other.inline_data();
+                other.capacity_ = N;
+            }
+            other.size_ = 0;
+        }
+
+        // Constructs copies of the elements [first, last) at the end. If an exception is thrown, all elements are destroyed.
+        template <typename InputIt>
+        void append(InputIt first, InputIt last)
+        {
+            try
+            {
+                append_range(first, last, typename std::iterator_traits<InputIt>::iterator_category());
+            }
+            catch (...)
+            {
+                clear();
+                throw;
+            }
+        }
+
+        template <typename InputIt>
+        void append_range(InputIt first, InputIt last, std::input_iterator_tag)
+        {
+            for (; first != last; ++first)
+                emplace_back(*first);
+        }
+
+        // Grows the capacity up front, so the elements are relocated at most once.
+        template <typename ForwardIt>
+        void append_range(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+        {
+            const auto required = size_ + static_cast<size_type>(std::distance(first, last));
+            if (required > capacity_)
+                reallocate(grown_capacity(required));
+            for (; first != last; ++first)
+                emplace_back(*first);
+        }
+
+        void destroy(iterator first, iterator last)
+        {
+            if (!std::is_trivially_destructible<value_type>::value)
+            {
+                for (; first != last; ++first)
+                    alloc_traits::destroy(alloc_, first);
+            }
+        }
+
+    private:
+
+        using storage_type = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+        allocator_type  alloc_;
+        pointer         data_       = inline_data();
+        size_type       size_       = 0;
+        size_type       capacity_   = N;
+        storage_type    storage_[N];
+
+};
+
+
+} // /namespace ext
+
+
+#endif
+
+
+
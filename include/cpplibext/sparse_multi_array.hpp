@@ -0,0 +1,538 @@
+/*
+ * sparse_multi_array.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_SPARSE_MULTI_ARRAY_H
+#define CPPLIBEXT_SPARSE_MULTI_ARRAY_H
+
+
+#include "multi_array_layout.hpp"
+#include "details/product.hpp"
+#include "details/flat_index.hpp"
+#include "details/index_sequence.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <memory>
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+
+/**
+\brief Block-sparse multi dimensional array, which only allocates dense bricks of BrickSize^N elements on the first write into them.
+\tparam T Specifies the data type for the array elements.
+\tparam BrickSize Specifies the edge length of each brick. This should be a power of two, so the divisions are cheap.
+\tparam Dimensions... Specifies the array dimensions. These do not need to be multiples of BrickSize.
+\remarks The bricks are found with a two-level table: a dense directory with one 32-bit entry per brick, and the list of allocated bricks.
+Reading an element of an unallocated brick returns the background value without allocating anything.
+The iterators only visit the elements of the allocated bricks (in the order of allocation).
+\code
+// Example usage:
+ext::sparse_multi_array<float, 1024, 1024, 1024> volume(0.0f); // Only the directory of 128^3 entries is allocated
+volume[10][20][30] = 1.0f;                                     // Allocates a brick of 8^3 elements
+float x = volume[500][500][500];                               // Returns the background 0.0f
+for (float& v : volume)                                        // Visits the 512 elements of the allocated brick
+    v *= 2.0f;
+\endcode
+\see sparse_multi_array
+*/
+template <typename T, std::size_t BrickSize, std::size_t... Dimensions>
+class basic_sparse_multi_array
+{
+
+    public:
+
+        static_assert(sizeof...(Dimensions) > 0, "sparse_multi_array must have at least 1 dimension");
+        static_assert(BrickSize > 0, "brick size of sparse_multi_array must be greater than zero");
+
+        using value_type        = T;
+        using size_type         = std::size_t;
+        using difference_type   = std::ptrdiff_t;
+        using const_reference   = const value_type&;
+
+        //! Indices of an element in all dimensions.
+        using index_type        = std::array<size_type, sizeof...(Dimensions)>;
+
+        //! Number of dimensions.
+        static const size_type num_dimensions   = sizeof...(Dimensions);
+
+        //! Number of all (logical) elements in the array.
+        static const size_type num_elements     = details::product<size_type, Dimensions...>::value;
+
+        //! Edge length of each brick.
+        static const size_type brick_size       = BrickSize;
+
+        //! Number of elements per brick.
+        static const size_type brick_elements   = details::static_pow(BrickSize, sizeof...(Dimensions));
+
+        //! Number of bricks to cover the entire array.
+        static const size_type num_bricks       = details::product<size_type, ((Dimensions + BrickSize - 1) / BrickSize)...>::value;
+
+    private:
+
+        using this_array_type   = basic_sparse_multi_array<T, BrickSize, Dimensions...>;
+        using index_sequence    = typename details::make_index_sequence<num_dimensions>::type;
+
+        // Row-major mappings of the bricks in the array and of the elements in each brick.
+        using brick_mapping     = typename row_major_layout::template mapping<((Dimensions + BrickSize - 1) / BrickSize)...>;
+        using element_mapping   = typename row_major_layout::template mapping<(Dimensions * 0 + BrickSize)...>;
+
+        // Specifies whether any brick is only partially inside the array.
+        static const bool has_partial_bricks = (details::product<size_type, (Dimensions % BrickSize == 0 ? 1 : 0)...>::value == 0);
+
+        struct brick
+        {
+            size_type                               index; // Index of this brick in the directory
+            std::array<value_type, brick_elements>  data;
+        };
+
+        // Directory entry for unallocated bricks (otherwise the entry is the index in 'bricks_').
+        enum : std::uint32_t { no_brick = 0xFFFFFFFFu };
+
+    public:
+
+        /**
+        \brief Proxy reference to an element, which only allocates the brick when a value is assigned.
+        \remarks Reading through this proxy does not allocate anything.
+        */
+        class reference
+        {
+
+            public:
+
+                operator const_reference () const
+                {
+                    return owner_->get(indices_);
+                }
+
+                reference& operator = (const value_type& value)
+                {
+                    owner_->element(indices_) = value;
+                    return *this;
+                }
+
+                reference& operator = (const reference& rhs)
+                {
+                    return (*this = static_cast<const_reference>(rhs));
+                }
+
+            private:
+
+                friend class basic_sparse_multi_array;
+
+                reference(this_array_type* owner, const index_type& indices) :
+                    owner_   { owner   },
+                    indices_ ( indices )
+                {
+                }
+
+                this_array_type*    owner_;
+                index_type          indices_;
+
+        };
+
+        //! Slice for the operator[] syntax, e.g. "ary[x][y][z] = value".
+        template <size_type Dimension>
+        class slice
+        {
+
+            public:
+
+                using subscript_type = typename std::conditional<(Dimension + 1 < num_dimensions), slice<(Dimension + 1)>, reference>::type;
+
+                subscript_type operator [] (size_type index) const
+                {
+                    auto indices = indices_;
+                    indices[Dimension] = index;
+                    return subscript(indices, std::integral_constant<bool, (Dimension + 1 < num_dimensions)>());
+                }
+
+            private:
+
+                friend class basic_sparse_multi_array;
+
+                slice(this_array_type* owner, const index_type& indices) :
+                    owner_   { owner   },
+                    indices_ ( indices )
+                {
+                }
+
+                slice<(Dimension + 1)> subscript(const index_type& indices, std::true_type) const
+                {
+                    return slice<(Dimension + 1)>(owner_, indices);
+                }
+
+                reference subscript(const index_type& indices, std::false_type) const
+                {
+                    return reference(owner_, indices);
+                }
+
+                this_array_type*    owner_;
+                index_type          indices_;
+
+        };
+
+        //! Read-only slice for the operator[] syntax.
+        template <size_type Dimension>
+        class const_slice
+        {
+
+            public:
+
+                using subscript_type = typename std::conditional<(Dimension + 1 < num_dimensions), const_slice<(Dimension + 1)>, const_reference>::type;
+
+                subscript_type operator [] (size_type index) const
+                {
+                    auto indices = indices_;
+                    indices[Dimension] = index;
+                    return subscript(indices, std::integral_constant<bool, (Dimension + 1 < num_dimensions)>());
+                }
+
+            private:
+
+                friend class basic_sparse_multi_array;
+
+                const_slice(const this_array_type* owner, const index_type& indices) :
+                    owner_   { owner   },
+                    indices_ ( indices )
+                {
+                }
+
+                const_slice<(Dimension + 1)> subscript(const index_type& indices, std::true_type) const
+                {
+                    return const_slice<(Dimension + 1)>(owner_, indices);
+                }
+
+                const_reference subscript(const index_type& indices, std::false_type) const
+                {
+                    return owner_->get(indices);
+                }
+
+                const this_array_type*  owner_;
+                index_type              indices_;
+
+        };
+
+        //! Forward iterator over the elements of all allocated bricks.
+        template <class Owner, typename Ref>
+        class basic_iterator
+        {
+
+            public:
+
+                using iterator_category = std::forward_iterator_tag;
+                using value_type        = typename this_array_type::value_type;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = typename std::remove_reference<Ref>::type*;
+                using reference         = Ref;
+
+                basic_iterator() = default;
+
+                reference operator * () const
+                {
+                    return owner_->bricks_[brick_]->data[element_];
+                }
+
+                pointer operator -> () const
+                {
+                    return &(owner_->bricks_[brick_]->data[element_]);
+                }
+
+                basic_iterator& operator ++ ()
+                {
+                    advance();
+                    skip_outside();
+                    return *this;
+                }
+
+                basic_iterator operator ++ (int)
+                {
+                    auto tmp = *this;
+                    operator ++ ();
+                    return tmp;
+                }
+
+                bool operator == (const basic_iterator& rhs) const
+                {
+                    return (brick_ == rhs.brick_ && element_ == rhs.element_);
+                }
+
+                bool operator != (const basic_iterator& rhs) const
+                {
+                    return !(*this == rhs);
+                }
+
+                //! Returns the indices of the current element in the array.
+                index_type indices() const
+                {
+                    return owner_->unravel(owner_->bricks_[brick_]->index, element_, index_sequence());
+                }
+
+            private:
+
+                friend class basic_sparse_multi_array;
+
+                basic_iterator(Owner* owner, size_type brick) :
+                    owner_ { owner },
+                    brick_ { brick }
+                {
+                    skip_outside();
+                }
+
+                void advance()
+                {
+                    if (++element_ == brick_elements)
+                    {
+                        element_ = 0;
+                        ++brick_;
+                    }
+                }
+
+                // Skips the elements of partial bricks that are outside of the array.
+                void skip_outside()
+                {
+                    if (has_partial_bricks)
+                    {
+                        while (brick_ < owner_->bricks_.size() && !owner_->in_range(indices(), index_sequence()))
+                            advance();
+                    }
+                }
+
+                Owner*      owner_      = nullptr;
+                size_type   brick_      = 0;
+                size_type   element_    = 0;
+
+        };
+
+        using iterator          = basic_iterator<this_array_type, value_type&>;
+        using const_iterator    = basic_iterator<const this_array_type, const value_type&>;
+
+    public:
+
+        /**
+        \brief Constructs the sparse array without any allocated bricks.
+        \param[in] background Specifies the value of all elements in unallocated bricks.
+        */
+        explicit basic_sparse_multi_array(const value_type& background = value_type()) :
+            directory_  ( num_bricks, no_brick ),
+            background_ ( background           )
+        {
+        }
+
+        basic_sparse_multi_array(const this_array_type& rhs) :
+            directory_  ( rhs.directory_  ),
+            background_ ( rhs.background_ )
+        {
+            bricks_.reserve(rhs.bricks_.size());
+            for (const auto& b : rhs.bricks_)
+                bricks_.emplace_back(new brick(*b));
+        }
+
+        basic_sparse_multi_array(this_array_type&&) = default;
+
+        this_array_type& operator = (const this_array_type& rhs)
+        {
+            if (this != &rhs)
+            {
+                this_array_type tmp(rhs);
+                swap(tmp);
+            }
+            return *this;
+        }
+
+        this_array_type& operator = (this_array_type&&) = default;
+
+        void swap(this_array_type& other)
+        {
+            directory_.swap(other.directory_);
+            bricks_.swap(other.bricks_);
+            std::swap(background_, other.background_);
+        }
+
+        //! Returns the value of all elements in unallocated bricks.
+        const_reference background() const
+        {
+            return background_;
+        }
+
+        //! Returns the number of allocated bricks.
+        size_type allocated_bricks() const
+        {
+            return bricks_.size();
+        }
+
+        //! Returns true if no brick is allocated, i.e. all elements have the background value.
+        bool empty() const
+        {
+            return bricks_.empty();
+        }
+
+        //! Releases all bricks, so all elements have the background value again.
+        void clear()
+        {
+            bricks_.clear();
+            std::fill(directory_.begin(), directory_.end(), no_brick);
+        }
+
+        //! Returns true if the brick of the element at the specified indices is allocated.
+        template <typename... Indices>
+        bool is_allocated(Indices... indices) const
+        {
+            return (directory_[brick_offset(make_index(indices...), index_sequence())] != no_brick);
+        }
+
+        iterator begin()
+        {
+            return iterator(this, 0);
+        }
+
+        const_iterator begin() const
+        {
+            return const_iterator(this, 0);
+        }
+
+        iterator end()
+        {
+            return iterator(this, bricks_.size());
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator(this, bricks_.size());
+        }
+
+        //! Returns the slice for the specified index along the first dimension, or a proxy reference to the element for 1-dimensional arrays.
+        typename slice<0>::subscript_type operator [] (size_type index)
+        {
+            return slice<0>(this, index_type())[index];
+        }
+
+        typename const_slice<0>::subscript_type operator [] (size_type index) const
+        {
+            return const_slice<0>(this, index_type())[index];
+        }
+
+        //! Returns a proxy reference to the element at the specified indices, e.g. ary(i, j, k) instead of ary[i][j][k].
+        template <typename... Indices>
+        reference operator () (Indices... indices)
+        {
+            static_assert(sizeof...(Indices) == num_dimensions, "number of indices does not match the number of sparse_multi_array dimensions");
+            return reference(this, make_index(indices...));
+        }
+
+        //! Returns the element at the specified indices, or the background value if its brick is not allocated.
+        template <typename... Indices>
+        const_reference operator () (Indices... indices) const
+        {
+            static_assert(sizeof...(Indices) == num_dimensions, "number of indices does not match the number of sparse_multi_array dimensions");
+            return get(make_index(indices...));
+        }
+
+        /**
+        \brief Returns the element at the specified indices with bounds checking.
+        \throws std::out_of_range If any of the indices is out of range.
+        */
+        template <typename... Indices>
+        const_reference at(Indices... indices) const
+        {
+            static_assert(sizeof...(Indices) == num_dimensions, "number of indices does not match the number of sparse_multi_array dimensions");
+            const auto index = make_index(indices...);
+            if (!in_range(index, index_sequence()))
+                throw std::out_of_range("sparse_multi_array::at out of range");
+            return get(index);
+        }
+
+    private:
+
+        template <typename... Indices>
+        static index_type make_index(Indices... indices)
+        {
+            return {{ static_cast<size_type>(indices)... }};
+        }
+
+        template <std::size_t... Is>
+        static size_type brick_offset(const index_type& indices, details::index_sequence<Is...>)
+        {
+            return details::flat_index<brick_mapping, 0, ((Dimensions + BrickSize - 1) / BrickSize)...>::compute((indices[Is] / BrickSize)...);
+        }
+
+        template <std::size_t... Is>
+        static size_type element_offset(const index_type& indices, details::index_sequence<Is...>)
+        {
+            return details::flat_index<element_mapping, 0, (Dimensions * 0 + BrickSize)...>::compute((indices[Is] % BrickSize)...);
+        }
+
+        template <std::size_t... Is>
+        static index_type unravel(size_type brick_offset, size_type element_offset, details::index_sequence<Is...>)
+        {
+            return {{ (brick_mapping::template index<Is>(brick_offset) * BrickSize + element_mapping::template index<Is>(element_offset))... }};
+        }
+
+        template <std::size_t... Is>
+        static bool in_range(const index_type& indices, details::index_sequence<Is...>)
+        {
+            return details::flat_index<brick_mapping, 0, Dimensions...>::in_range(indices[Is]...);
+        }
+
+        const_reference get(const index_type& indices) const
+        {
+            const auto entry = directory_[brick_offset(indices, index_sequence())];
+            if (entry == no_brick)
+                return background_;
+            return bricks_[entry]->data[element_offset(indices, index_sequence())];
+        }
+
+        // Returns the element at the specified indices and allocates its brick if necessary.
+        value_type& element(const index_type& indices)
+        {
+            const auto offset = brick_offset(indices, index_sequence());
+            auto& entry = directory_[offset];
+            if (entry == no_brick)
+            {
+                std::unique_ptr<brick> b { new brick() };
+                b->index = offset;
+                b->data.fill(background_);
+                bricks_.push_back(std::move(b));
+                entry = static_cast<std::uint32_t>(bricks_.size() - 1);
+            }
+            return bricks_[entry]->data[element_offset(indices, index_sequence())];
+        }
+
+    private:
+
+        std::vector<std::uint32_t>              directory_;
+        std::vector<std::unique_ptr<brick>>     bricks_;
+        value_type                              background_;
+
+};
+
+
+/**
+\brief Block-sparse multi dimensional array with bricks of 8^N elements.
+\see basic_sparse_multi_array
+*/
+template <typename T, std::size_t... Dimensions>
+using sparse_multi_array = basic_sparse_multi_array<T, 8, Dimensions...>;
+
+
+} // /namespace ext
+
+
+#endif
+
+
+
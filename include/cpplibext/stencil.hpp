@@ -0,0 +1,318 @@
+/*
+ * stencil.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_STENCIL_H
+#define CPPLIBEXT_STENCIL_H
+
+
+#include "multi_array.hpp"
+#include "grid_vector.hpp"
+#include "multi_array_layout.hpp"
+#include "border_policy.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+
+// This namespace is only used internally
+namespace details
+{
+
+
+inline std::ptrdiff_t stencil_offset(const std::ptrdiff_t*)
+{
+    return 0;
+}
+
+template <typename O1, typename... ON>
+std::ptrdiff_t stencil_offset(const std::ptrdiff_t* strides, O1 o1, ON... on)
+{
+    return (static_cast<std::ptrdiff_t>(o1) * strides[0] + stencil_offset(strides + 1, on...));
+}
+
+
+} // /namespace details
+
+
+/**
+\brief Neighborhood of an element, which is passed to the function of stencil_transform.
+\remarks The neighbors are accessed by their offsets to the center element, e.g. "n(-1, 0)" for the left neighbor in a grid_vector.
+All offsets must be in the range [-Radius, Radius] of the stencil.
+*/
+template <typename T, std::size_t N>
+class neighborhood
+{
+
+    public:
+
+        using value_type = T;
+
+        neighborhood(const T* center, const std::array<std::ptrdiff_t, N>& strides) :
+            center_  { center  },
+            strides_ ( strides )
+        {
+        }
+
+        //! Returns the neighbor at the specified offsets (one per dimension) to the center.
+        template <typename... Offsets>
+        const T& operator () (Offsets... offsets) const
+        {
+            static_assert(sizeof...(Offsets) == N, "number of offsets does not match the number of neighborhood dimensions");
+            return center_[details::stencil_offset(strides_.data(), offsets...)];
+        }
+
+        //! Returns the center element.
+        const T& center() const
+        {
+            return *center_;
+        }
+
+    private:
+
+        const T*                            center_;
+        std::array<std::ptrdiff_t, N>       strides_;
+
+};
+
+
+namespace details
+{
+
+
+/*
+Applies a stencil function to all elements of a row-major array.
+The extents are ordered from the outermost to the innermost dimension, and the rows of the innermost dimension are 'row_pitch' elements apart.
+Elements whose neighborhood lies completely inside the array are processed in a tight loop without any checks, all other elements gather their neighborhood with the border policy first.
+If 'ReverseAxes' is true, the neighborhood offsets are ordered from the innermost to the outermost dimension (e.g. (x, y) for grid_vector).
+*/
+template <typename T, typename U, std::size_t N, std::size_t Radius, bool ReverseAxes, class Border, class Function>
+class stencil_processor
+{
+
+    public:
+
+        static const std::size_t window_size    = 2*Radius + 1;
+        static const std::size_t window_volume  = static_pow(window_size, N);
+        static const std::size_t window_rows    = window_volume / window_size;
+
+        stencil_processor(const T* src, U* dst, const std::array<std::size_t, N>& extents, std::size_t row_pitch, const Border& border, Function& func) :
+            src_     { src     },
+            dst_     { dst     },
+            extents_ ( extents ),
+            border_  ( border  ),
+            func_    ( func    )
+        {
+            std::ptrdiff_t stride = 1, window_stride = 1;
+            for (std::size_t i = N; i-- > 0;)
+            {
+                strides_[i] = stride;
+                stride *= static_cast<std::ptrdiff_t>(i + 1 == N ? row_pitch : extents_[i]);
+                set_axis(src_strides_, i, strides_[i]);
+                set_axis(window_strides_, i, window_stride);
+                window_stride *= static_cast<std::ptrdiff_t>(window_size);
+            }
+        }
+
+        void run()
+        {
+            std::array<std::ptrdiff_t, N> coords;
+            process(0, 0, true, coords);
+        }
+
+    private:
+
+        static void set_axis(std::array<std::ptrdiff_t, N>& strides, std::size_t axis, std::ptrdiff_t stride)
+        {
+            strides[ReverseAxes ? N - 1 - axis : axis] = stride;
+        }
+
+        void process(std::size_t dim, std::size_t offset, bool interior, std::array<std::ptrdiff_t, N>& coords)
+        {
+            const auto extent   = extents_[dim];
+            const auto first    = std::min(Radius, extent);
+            const auto last     = (extent > 2*Radius ? extent - Radius : first);
+
+            if (dim + 1 == N)
+            {
+                if (!interior || first > 0 || last < extent)
+                    prepare_boundary_rows(coords);
+
+                /* Boundary elements at the front */
+                for (std::size_t i = 0; i < first; ++i)
+                    process_boundary(offset, i);
+
+                if (interior)
+                {
+                    /* Interior elements without any checks */
+                    const T* src = src_ + offset;
+                    U* dst = dst_ + offset;
+                    for (std::size_t i = first; i < last; ++i)
+                        dst[i] = func_(neighborhood<T, N>(src + i, src_strides_));
+                }
+                else
+                {
+                    for (std::size_t i = first; i < last; ++i)
+                        process_boundary(offset, i);
+                }
+
+                /* Boundary elements at the back */
+                for (std::size_t i = last; i < extent; ++i)
+                    process_boundary(offset, i);
+            }
+            else
+            {
+                const auto stride = static_cast<std::size_t>(strides_[dim]);
+                for (std::size_t i = 0; i < extent; ++i)
+                {
+                    coords[dim] = static_cast<std::ptrdiff_t>(i);
+                    process(dim + 1, offset + i*stride, (interior && i >= first && i < last), coords);
+                }
+            }
+        }
+
+        // Returns the source offset of the neighbor at 'coord + delta' along the specified axis, or -1 if it is outside of the array.
+        std::ptrdiff_t resolve_offset(std::size_t axis, std::ptrdiff_t coord, std::size_t j) const
+        {
+            const auto delta = static_cast<std::ptrdiff_t>(j) - static_cast<std::ptrdiff_t>(Radius);
+            const auto index = border_.resolve(coord + delta, static_cast<std::ptrdiff_t>(extents_[axis]));
+            return (index < 0 ? -1 : index * strides_[axis]);
+        }
+
+        // Resolves the offsets of all window rows (i.e. all axes but the innermost one) for the current row of the array.
+        void prepare_boundary_rows(const std::array<std::ptrdiff_t, N>& coords)
+        {
+            std::array<std::size_t, N> pos;
+            pos.fill(0);
+
+            for (std::size_t r = 0; r < window_rows; ++r)
+            {
+                std::ptrdiff_t row_offset = 0;
+                for (std::size_t d = 0; d + 1 < N && row_offset >= 0; ++d)
+                {
+                    const auto axis_offset = resolve_offset(d, coords[d], pos[d]);
+                    row_offset = (axis_offset < 0 ? -1 : row_offset + axis_offset);
+                }
+                row_offsets_[r] = row_offset;
+
+                for (std::size_t d = N - 1; d-- > 0 && ++pos[d] == window_size;)
+                    pos[d] = 0;
+            }
+        }
+
+        // Gathers the neighborhood with the border policy into a local window.
+        void process_boundary(std::size_t offset, std::size_t i)
+        {
+            std::array<std::ptrdiff_t, window_size> column_offsets;
+            for (std::size_t j = 0; j < window_size; ++j)
+                column_offsets[j] = resolve_offset(N - 1, static_cast<std::ptrdiff_t>(i), j);
+
+            std::array<T, window_volume> window;
+            for (std::size_t r = 0; r < window_rows; ++r)
+            {
+                for (std::size_t j = 0; j < window_size; ++j)
+                {
+                    window[r*window_size + j] = (row_offsets_[r] < 0 || column_offsets[j] < 0
+                        ? border_value<T>(border_)
+                        : src_[row_offsets_[r] + column_offsets[j]]);
+                }
+            }
+
+            dst_[offset + i] = func_(neighborhood<T, N>(window.data() + window_volume/2, window_strides_));
+        }
+
+    private:
+
+        const T*                                src_;
+        U*                                      dst_;
+        std::array<std::size_t, N>              extents_;
+        std::array<std::ptrdiff_t, N>           strides_;           // Strides in memory order
+        std::array<std::ptrdiff_t, N>           src_strides_;       // Strides in neighborhood order
+        std::array<std::ptrdiff_t, N>           window_strides_;    // Strides of the local window in neighborhood order
+        std::array<std::ptrdiff_t, window_rows> row_offsets_;       // Source offsets of the window rows for the current array row
+        Border                                  border_;
+        Function&                               func_;
+
+};
+
+// Resizes the destination grid to the size and pitch of the source grid. Grids without padding always have pitch == width.
+template <typename T, class Alloc, class Tracking>
+void resize_like(grid_vector<T, Alloc, Tracking, padded>& dst, std::size_t width, std::size_t height, std::size_t pitch)
+{
+    dst.resize_padded(width, height, pitch);
+}
+
+template <typename T, class Alloc, class Tracking>
+void resize_like(grid_vector<T, Alloc, Tracking, unpadded>& dst, std::size_t width, std::size_t height, std::size_t /*pitch*/)
+{
+    dst.resize(width, height);
+}
+
+
+} // /namespace details
+
+
+/**
+\brief Applies a stencil function with the neighborhood of (2*Radius+1)^N elements to each element of a multi_array.
+\tparam Radius Specifies the radius of the neighborhood, e.g. 1 for 3x3 or 3x3x3 stencils.
+\param[in] src Specifies the source array. This must not refer to the same array as 'dst'.
+\param[out] dst Specifies the destination array.
+\param[in] border Specifies the border policy for neighbors outside of the array: clamp_border, wrap_border, or constant_border.
+\param[in] func Specifies the stencil function with the signature "U func(const neighborhood<T, N>& n)".
+\remarks The interior elements are processed without any boundary checks, so this loop can be vectorized by the compiler.
+Only the elements within Radius to the border gather their neighborhood with the border policy.
+Both arrays must have row_major_layout.
+\code
+// Example usage:
+ext::multi_array<float, 64, 64, 64> src, dst;
+ext::stencil_transform<1>(src, dst, ext::clamp_border(), [](const ext::neighborhood<float, 3>& n)
+{
+    return (n(-1, 0, 0) + n(1, 0, 0) + n(0, -1, 0) + n(0, 1, 0) + n(0, 0, -1) + n(0, 0, 1)) / 6.0f;
+});
+\endcode
+*/
+template <std::size_t Radius, typename T, typename U, class StorageSrc, class StorageDst, class Layout, std::size_t... Dimensions, class Border, class Function>
+void stencil_transform(
+    const basic_multi_array<T, StorageSrc, Layout, Dimensions...>& src,
+    basic_multi_array<U, StorageDst, Layout, Dimensions...>& dst,
+    const Border& border,
+    Function func)
+{
+    static_assert(basic_multi_array<T, StorageSrc, Layout, Dimensions...>::layout_mapping::is_row_major, "stencil_transform requires row_major_layout");
+    const std::array<std::size_t, sizeof...(Dimensions)> extents {{ Dimensions... }};
+    details::stencil_processor<T, U, sizeof...(Dimensions), Radius, false, Border, Function>(src.data(), dst.data(), extents, extents.back(), border, func).run();
+}
+
+/**
+\brief Applies a stencil function to each element of a grid_vector.
+\param[out] dst Specifies the destination grid. This will be resized to the size and pitch of 'src', so both grids must have the same padding policy.
+\remarks The neighbors are accessed with (x, y) offsets, e.g. "n(-1, 0)" for the left neighbor.
+\see stencil_transform(src, dst, border, func)
+*/
+template <std::size_t Radius, typename T, typename U, class AllocSrc, class TrackingSrc, class AllocDst, class TrackingDst, class Padding, class Border, class Function>
+void stencil_transform(const grid_vector<T, AllocSrc, TrackingSrc, Padding>& src, grid_vector<U, AllocDst, TrackingDst, Padding>& dst, const Border& border, Function func)
+{
+    details::resize_like(dst, src.width(), src.height(), src.pitch());
+    const std::array<std::size_t, 2> extents {{ src.height(), src.width() }};
+    details::stencil_processor<T, U, 2, Radius, true, Border, Function>(src.data(), dst.data(), extents, src.pitch(), border, func).run();
+}
+
+
+} // /namespace ext
+
+
+#endif
+
+
+
@@ -0,0 +1,226 @@
+/*
+ * thread_pool.hpp file
+ *
+ * Copyright (C) 2014-2018 Lukas Hermanns
+ * All rights reserved.
+ *
+ * This software may be modified and distributed under the terms
+ * of the BSD license.  See the LICENSE file for details.
+ */
+
+#ifndef CPPLIBEXT_THREAD_POOL_H
+#define CPPLIBEXT_THREAD_POOL_H
+
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <vector>
+#include <cstdlib>
+
+
+namespace ext
+{
+
+
+/**
+\brief Fork-join thread pool, which runs a number of tasks in parallel and waits until all of them are done.
+\remarks The calling thread takes part in the work, so a pool with a concurrency of N only creates N-1 worker threads.
+Tasks that are started from inside a task run sequentially on the current thread, so nested parallel algorithms do not dead-lock.
+\code
+// Example usage:
+ext::thread_pool pool(4);
+std::vector<float> results(100);
+pool.run(results.size(), [&](std::size_t i) { results[i] = heavy_computation(i); });
+\endcode
+*/
+class thread_pool
+{
+
+    public:
+
+        using size_type = std::size_t;
+
+        /**
+        \brief Creates the thread pool.
+        \param[in] concurrency Specifies the number of threads that work on the tasks, including the calling thread.
+        By default std::thread::hardware_concurrency. If this is 0 or 1, all tasks run sequentially on the calling thread.
+        */
+        explicit thread_pool(size_type concurrency = std::thread::hardware_concurrency())
+        {
+            for (size_type i = 1; i < concurrency; ++i)
+                workers_.emplace_back([this]() { worker_main(); });
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator = (const thread_pool&) = delete;
+
+        ~thread_pool()
+        {
+            {
+                std::lock_guard<std::mutex> lock { mutex_ };
+                quit_ = true;
+            }
+            start_cv_.notify_all();
+            for (auto& t : workers_)
+                t.join();
+        }
+
+        //! Returns the number of threads that work on the tasks, including the calling thread.
+        size_type concurrency() const
+        {
+            return workers_.size() + 1;
+        }
+
+        /**
+        \brief Calls 'func(i)' for all i in [0, num_tasks) and returns when all tasks are done.
+        \remarks The order in which the tasks are executed is unspecified.
+        If any task throws an exception, the remaining tasks are still executed and the first exception is rethrown afterwards.
+        Only one call to 'run' is executed at a time; concurrent calls from other threads wait for each other.
+        */
+        template <class Func>
+        void run(size_type num_tasks, Func func)
+        {
+            if (num_tasks == 0)
+                return;
+
+            if (num_tasks == 1 || workers_.empty() || is_inside_task())
+            {
+                for (size_type i = 0; i < num_tasks; ++i)
+                    func(i);
+                return;
+            }
+
+            std::lock_guard<std::mutex> run_lock { run_mutex_ };
+
+            /* Publish the job to all worker threads (after late workers of the previous job have left it) */
+            {
+                std::unique_lock<std::mutex> lock { mutex_ };
+                done_cv_.wait(lock, [this]() { return (active_workers_ == 0); });
+                task_       = std::ref(func);
+                num_tasks_  = num_tasks;
+                next_task_  = 0;
+                pending_    = num_tasks;
+                exception_  = nullptr;
+                ++generation_;
+            }
+            start_cv_.notify_all();
+
+            /* Work on the tasks on this thread as well, then wait for the workers */
+            is_inside_task() = true;
+            execute_tasks();
+            is_inside_task() = false;
+
+            std::unique_lock<std::mutex> lock { mutex_ };
+            done_cv_.wait(lock, [this]() { return (pending_ == 0 && active_workers_ == 0); });
+
+            task_ = nullptr;
+
+            if (exception_)
+                std::rethrow_exception(exception_);
+        }
+
+    private:
+
+        // Returns true if the current thread is executing tasks of any thread pool.
+        static bool& is_inside_task()
+        {
+            static thread_local bool inside = false;
+            return inside;
+        }
+
+        void worker_main()
+        {
+            is_inside_task() = true;
+
+            unsigned long long generation = 0;
+
+            while (true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock { mutex_ };
+                    start_cv_.wait(lock, [&]() { return (quit_ || generation_ != generation); });
+                    if (quit_)
+                        return;
+                    generation = generation_;
+                    ++active_workers_;
+                }
+
+                execute_tasks();
+
+                {
+                    std::lock_guard<std::mutex> lock { mutex_ };
+                    --active_workers_;
+                }
+                done_cv_.notify_all();
+            }
+        }
+
+        void execute_tasks()
+        {
+            while (true)
+            {
+                auto i = next_task_.fetch_add(1);
+                if (i >= num_tasks_)
+                    break;
+
+                try
+                {
+                    task_(i);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock { mutex_ };
+                    if (!exception_)
+                        exception_ = std::current_exception();
+                }
+
+                if (pending_.fetch_sub(1) == 1)
+                {
+                    std::lock_guard<std::mutex> lock { mutex_ };
+                    done_cv_.notify_all();
+                }
+            }
+        }
+
+    private:
+
+        std::vector<std::thread>                workers_;
+
+        std::mutex                              run_mutex_;
+        std::mutex                              mutex_;
+        std::condition_variable                 start_cv_;
+        std::condition_variable                 done_cv_;
+
+        std::function<void(size_type)>          task_;
+        size_type                               num_tasks_          = 0;
+        std::atomic<size_type>                  next_task_          { 0 };
+        std::atomic<size_type>                  pending_            { 0 };
+        size_type                               active_workers_     = 0;
+        std::exception_ptr                      exception_;
+        unsigned long long                      generation_         = 0;
+        bool                                    quit_               = false;
+
+};
+
+/**
+\brief Returns the thread pool that is used by the parallel algorithms by default.
+\remarks The pool is created on the first call with a concurrency of std::thread::hardware_concurrency.
+*/
+inline thread_pool& default_thread_pool()
+{
+    static thread_pool pool;
+    return pool;
+}
+
+
+} // /namespace ext
+
+
+#endif
+
+
+
@@ -8,17 +8,38 @@
  * of the BSD license.  See the LICENSE file for details.
  */
 
+#include <iomanip>
 #include <iostream>
 #include <cstdlib>
+#include <cstdio>
+#include <cmath>
 #include <vector>
 #include <chrono>
 #include <memory>
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <numeric>
+#include <functional>
 
 #include <cpplibext/multi_array.hpp>
+#include <cpplibext/dynamic_multi_array.hpp>
+#include <cpplibext/multi_array_view.hpp>
+#include <cpplibext/parallel_algorithm.hpp>
+#include <cpplibext/multi_array_reduce.hpp>
+#include <cpplibext/matrix_multiply.hpp>
+#include <cpplibext/mapped_array.hpp>
+#include <cpplibext/sparse_multi_array.hpp>
+#include <cpplibext/stencil.hpp>
+#include <cpplibext/convolution.hpp>
 #include <cpplibext/range_iterator.hpp>
 #include <cpplibext/make_shared_array.hpp>
 #include <cpplibext/make_unique.hpp>
 #include <cpplibext/grid_vector.hpp>
+#include <cpplibext/chunked_grid.hpp>
+#include <cpplibext/integral_grid.hpp>
+#include <cpplibext/grid_pyramid.hpp>
 #include <cpplibext/command_line.hpp>
 #include <cpplibext/bit_mask.hpp>
 #include <cpplibext/join_string.hpp>
@@ -29,6 +50,7 @@
 #include <cpplibext/growing_stack.hpp>
 #include <cpplibext/member_function.hpp>
 #include <cpplibext/local_vector.hpp>
+#include <cpplibext/small_vector.hpp>
 
 
 using namespace ext;
@@ -196,6 +218,1081 @@ static void multi_array_test()
     #endif
 }
 
+/* --- multi_array index test -- */
+
+static void multi_array_index_test()
+{
+    TEST_HEADLINE;
+
+    typedef multi_array<int, 3, 4, 2> my_array_t;
+
+    static_assert(my_array_t::flat_index(2, 1, 1) == 19, "multi_array::flat_index failed");
+
+    my_array_t my_array;
+
+    for (size_t x = 0; x < 3; ++x)
+    {
+        for (size_t y = 0; y < 4; ++y)
+        {
+            for (size_t z = 0; z < 2; ++z)
+                my_array(x, y, z) = static_cast<int>(my_array_t::flat_index(x, y, z));
+        }
+    }
+
+    std::cout << "my_array(2, 1, 1) = " << my_array(2, 1, 1) << std::endl;
+    std::cout << "my_array[2][1][1] = " << my_array[2][1][1] << std::endl;
+    std::cout << "my_array.at(1, 3, 0) = " << my_array.at(1, 3, 0) << std::endl;
+
+    auto indices = my_array_t::unravel_index(19);
+    std::cout << "unravel_index(19) = { " << indices[0] << ", " << indices[1] << ", " << indices[2] << " }" << std::endl;
+
+    try
+    {
+        my_array.at(1, 4, 0) = 0;
+    }
+    catch (const std::out_of_range& e)
+    {
+        std::cout << "my_array.at(1, 4, 0) failed: " << e.what() << std::endl;
+    }
+
+    multi_array<int, 5> single_dim_array { 1, 2, 3, 4, 5 };
+    std::cout << "single_dim_array(3) = " << single_dim_array(3) << std::endl;
+}
+
+/* --- array_expression test -- */
+
+static void array_expression_test()
+{
+    TEST_HEADLINE;
+
+    typedef multi_array<float, 2, 3> my_array_t;
+
+    my_array_t a, b { 1, 2, 3, 4, 5, 6 }, c { 6, 5, 4, 3, 2, 1 }, d(0.5f);
+
+    auto PrintArray = [](const my_array_t& ary, const char* name)
+    {
+        std::cout << name << " = { ";
+        for (auto x : ary)
+            std::cout << x << ", ";
+        std::cout << "}" << std::endl;
+    };
+
+    a = b * c + d;
+    PrintArray(a, "b * c + d");
+
+    a = fma(b, c, d) - 2.0f;
+    PrintArray(a, "fma(b, c, d) - 2");
+
+    a = min(b, c) / max(b, c);
+    PrintArray(a, "min(b, c) / max(b, c)");
+
+    a = -(a * 2.0f);
+    PrintArray(a, "-(a * 2)");
+
+    my_array_t e = (b + c) * 0.5f;
+    PrintArray(e, "(b + c) * 0.5");
+
+    multi_array<bool, 2, 3> mask = (b < c);
+    std::cout << "b < c = { ";
+    for (auto x : mask)
+        std::cout << std::boolalpha << x << ", ";
+    std::cout << "}" << std::endl;
+
+    /* Compare the fused expression with the classic approach of one temporary array per operation */
+    typedef heap_multi_array<float, 256, 256, 16> my_tensor_t;
+
+    my_tensor_t x(1.0f), y(2.0f), z(3.0f), w;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    {
+        for (int i = 0; i < 10; ++i)
+            w = x * y + z * x - y;
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    {
+        my_tensor_t tmp0, tmp1, tmp2;
+        for (int i = 0; i < 10; ++i)
+        {
+            std::transform(x.begin(), x.end(), y.begin(), tmp0.begin(), std::multiplies<float>());
+            std::transform(z.begin(), z.end(), x.begin(), tmp1.begin(), std::multiplies<float>());
+            std::transform(tmp0.begin(), tmp0.end(), tmp1.begin(), tmp2.begin(), std::plus<float>());
+            std::transform(tmp2.begin(), tmp2.end(), y.begin(), w.begin(), std::minus<float>());
+        }
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "fused expression:     " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us" << std::endl;
+    std::cout << "temporary arrays:     " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us" << std::endl;
+    std::cout << "w[0][0][0] = " << w[0][0][0] << std::endl;
+}
+
+/* --- multi_array storage test -- */
+
+static void multi_array_storage_test()
+{
+    TEST_HEADLINE;
+
+    typedef heap_multi_array<float, 512, 512, 64> my_tensor_t;
+    typedef basic_multi_array<float, heap_storage<4096, true>, row_major_layout, 512, 512, 64> my_huge_tensor_t;
+
+    std::cout << "sizeof(multi_array<float, 512, 512, 64>) =\t" << sizeof(multi_array<float, 512, 512, 64>) << std::endl;
+    std::cout << "sizeof(heap_multi_array<float, 512, 512, 64>) =\t" << sizeof(my_tensor_t) << std::endl;
+
+    my_tensor_t a(1.0f);
+    my_huge_tensor_t b;
+
+    b.fill(2.0f);
+    b[511][511][63] = 3.0f;
+
+    std::cout << "a.data() aligned to 64 bytes:\t" << std::boolalpha << (reinterpret_cast<std::uintptr_t>(a.data()) % 64 == 0) << std::endl;
+    std::cout << "b.data() aligned to 4096 bytes:\t" << std::boolalpha << (reinterpret_cast<std::uintptr_t>(b.data()) % 4096 == 0) << std::endl;
+
+    my_tensor_t c = a;
+    c[1][2][3] = 5.0f;
+
+    std::cout << "a[1][2][3] = " << a[1][2][3] << ", c[1][2][3] = " << c[1][2][3] << std::endl;
+
+    my_tensor_t d = std::move(c);
+    std::cout << "d[1][2][3] = " << d[1][2][3] << ", moved-from c.data() = " << c.data() << std::endl;
+
+    c = d;
+    std::cout << "c[1][2][3] = " << c[1][2][3] << " (after copy assignment)" << std::endl;
+    std::cout << "b.back() = " << b.back() << std::endl;
+
+    heap_multi_array<std::string, 2, 3> strings;
+    strings[1][2] = "Hello World";
+    std::cout << "strings[1][2] = " << strings[1][2] << std::endl;
+}
+
+/* --- multi_array layout test -- */
+
+template <class Array>
+NOINLINE void layout_stencil(const Array& src, Array& dst)
+{
+    const size_t n = src.template slices<0>();
+    for (size_t x = 1; x + 1 < n; ++x)
+    {
+        for (size_t y = 1; y + 1 < n; ++y)
+            dst(x, y) = src(x - 1, y) + src(x + 1, y) + src(x, y - 1) + src(x, y + 1) - 4.0f * src(x, y);
+    }
+}
+
+template <class Array>
+NOINLINE float layout_column_sum(const Array& src)
+{
+    const size_t n = src.template slices<0>();
+    float sum = 0.0f;
+    for (size_t y = 0; y < n; ++y)
+    {
+        for (size_t x = 0; x < n; ++x)
+            sum += src(x, y);
+    }
+    return sum;
+}
+
+template <class Array>
+static void layout_benchmark(const char* name)
+{
+    std::unique_ptr<Array> src { new Array() }, dst { new Array(0.0f) };
+
+    /* Write the logical row-major index into each element, so all layouts produce the same results */
+    for (size_t x = 0; x < 1024; ++x)
+    {
+        for (size_t y = 0; y < 1024; ++y)
+            (*src)(x, y) = static_cast<float>((x * 1024 + y) % 7);
+    }
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    {
+        for (int i = 0; i < 10; ++i)
+            layout_stencil(*src, *dst);
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    float sum = 0.0f;
+    {
+        for (int i = 0; i < 10; ++i)
+            sum += layout_column_sum(*src);
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::cout << name << ":\tstencil " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us";
+    std::cout << ",\tcolumn walk " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us";
+    std::cout << "\t(dst(5, 7) = " << (*dst)(5, 7) << ", sum = " << sum << ")" << std::endl;
+}
+
+static void multi_array_layout_test()
+{
+    TEST_HEADLINE;
+
+    typedef basic_multi_array<int, array_storage, column_major_layout, 3, 4, 2> my_column_array_t;
+    typedef basic_multi_array<int, array_storage, tiled_layout<2>, 4, 4, 2> my_tiled_array_t;
+    typedef basic_multi_array<int, array_storage, morton_layout, 4, 8> my_morton_array_t;
+
+    static_assert(my_column_array_t::flat_index(2, 1, 1) == 2 + 1*3 + 1*12, "column_major_layout::flat_index failed");
+    static_assert(my_morton_array_t::flat_index(3, 5) == 27, "morton_layout::flat_index failed");
+
+    my_tiled_array_t tiled_array;
+    for (size_t x = 0; x < 4; ++x)
+    {
+        for (size_t y = 0; y < 4; ++y)
+        {
+            for (size_t z = 0; z < 2; ++z)
+                tiled_array[x][y][z] = static_cast<int>(x*100 + y*10 + z);
+        }
+    }
+
+    std::cout << "tiled_array in storage order = { ";
+    for (auto x : tiled_array)
+        std::cout << x << ", ";
+    std::cout << "}" << std::endl;
+
+    auto indices = my_tiled_array_t::unravel_index(my_tiled_array_t::flat_index(3, 2, 1));
+    std::cout << "tiled_array unravel_index(flat_index(3, 2, 1)) = { " << indices[0] << ", " << indices[1] << ", " << indices[2] << " }" << std::endl;
+
+    my_morton_array_t morton_array;
+    for (size_t x = 0; x < 4; ++x)
+    {
+        for (size_t y = 0; y < 8; ++y)
+            morton_array(x, y) = static_cast<int>(x*10 + y);
+    }
+
+    std::cout << "morton_array in storage order = { ";
+    for (auto x : morton_array)
+        std::cout << x << ", ";
+    std::cout << "}" << std::endl;
+
+    morton_array[2] = 0;
+    std::cout << "morton_array[2][5] = " << morton_array[2][5] << " (after slice fill)" << std::endl;
+
+    /* Compare stencil operations and column walks with different layouts */
+    layout_benchmark<basic_multi_array<float, heap_storage<>, row_major_layout, 1024, 1024>>("row_major_layout");
+    layout_benchmark<basic_multi_array<float, heap_storage<>, tiled_layout<8>, 1024, 1024>>("tiled_layout<8>");
+    layout_benchmark<basic_multi_array<float, heap_storage<>, morton_layout, 1024, 1024>>("morton_layout");
+}
+
+/* --- multi_array reduce test -- */
+
+static void multi_array_reduce_test()
+{
+    TEST_HEADLINE;
+
+    typedef multi_array<int, 2, 3, 4> my_array_t;
+
+    my_array_t a;
+    for (size_t i = 0; i < my_array_t::num_elements; ++i)
+        a.data()[i] = static_cast<int>((i * 7) % 10);
+
+    auto PrintArray = [](const int* data, size_t n, const char* name)
+    {
+        std::cout << name << " = { ";
+        for (size_t i = 0; i < n; ++i)
+            std::cout << data[i] << ", ";
+        std::cout << "}" << std::endl;
+    };
+
+    PrintArray(a.data(), a.size(), "a");
+
+    auto sum0 = reduce_sum<0>(a);
+    auto sum1 = reduce_sum<1>(a);
+    auto sum2 = reduce_sum<2>(a);
+    PrintArray(sum0.data(), sum0.size(), "reduce_sum<0>(a)");
+    PrintArray(sum1.data(), sum1.size(), "reduce_sum<1>(a)");
+    PrintArray(sum2.data(), sum2.size(), "reduce_sum<2>(a)");
+
+    auto max2 = reduce_max<2>(a);
+    auto argmax2 = reduce_argmax<2>(a);
+    auto min0 = reduce_min<0>(a);
+    PrintArray(max2.data(), max2.size(), "reduce_max<2>(a)");
+    std::cout << "reduce_argmax<2>(a) = { ";
+    for (auto x : argmax2)
+        std::cout << x << ", ";
+    std::cout << "}" << std::endl;
+    PrintArray(min0.data(), min0.size(), "reduce_min<0>(a)");
+
+    /* Same reduction with column-major layout */
+    basic_multi_array<int, array_storage, column_major_layout, 2, 3, 4> b;
+    for (size_t x = 0; x < 2; ++x)
+    {
+        for (size_t y = 0; y < 3; ++y)
+        {
+            for (size_t z = 0; z < 4; ++z)
+                b(x, y, z) = a(x, y, z);
+        }
+    }
+
+    auto sum1_b = reduce_sum<1>(b);
+    auto argmax1_b = reduce_argmax<1>(b);
+    auto argmax1 = reduce_argmax<1>(a);
+    std::cout << "reduce_sum<1>(b)(1, 2) = " << sum1_b(1, 2) << ", reduce_sum<1>(a)(1, 2) = " << sum1(1, 2) << std::endl;
+    std::cout << "reduce_argmax<1>(b)(0, 3) = " << argmax1_b(0, 3) << ", reduce_argmax<1>(a)(0, 3) = " << argmax1(0, 3) << std::endl;
+
+    /* Compare with hand-written reductions over nested slices */
+    typedef heap_multi_array<float, 1024, 1024> my_matrix_t;
+
+    my_matrix_t m;
+    for (size_t i = 0; i < my_matrix_t::num_elements; ++i)
+        m.data()[i] = static_cast<float>(i % 3);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    float check0 = 0.0f;
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            multi_array<float, 1024> sums;
+            for (size_t x = 0; x < 1024; ++x)
+            {
+                float sum = 0.0f;
+                for (size_t y = 0; y < 1024; ++y)
+                    sum += m[x][y];
+                sums[x] = sum;
+            }
+            check0 += sums[5];
+        }
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    float check1 = 0.0f;
+    {
+        for (int i = 0; i < 10; ++i)
+            check1 += reduce_sum<1>(m)[5];
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "inner axis (slices):  " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us (" << check0 << ")" << std::endl;
+    std::cout << "inner axis (reduce):  " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us (" << check1 << ")" << std::endl;
+
+    t0 = std::chrono::high_resolution_clock::now();
+    check0 = 0.0f;
+    {
+        for (int i = 0; i < 10; ++i)
+        {
+            multi_array<float, 1024> sums;
+            for (size_t y = 0; y < 1024; ++y)
+            {
+                float sum = 0.0f;
+                for (size_t x = 0; x < 1024; ++x)
+                    sum += m[x][y];
+                sums[y] = sum;
+            }
+            check0 += sums[5];
+        }
+    }
+    t1 = std::chrono::high_resolution_clock::now();
+    check1 = 0.0f;
+    {
+        for (int i = 0; i < 10; ++i)
+            check1 += reduce_sum<0>(m)[5];
+    }
+    t2 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "outer axis (slices):  " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us (" << check0 << ")" << std::endl;
+    std::cout << "outer axis (reduce):  " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us (" << check1 << ")" << std::endl;
+}
+
+/* --- matrix_multiply test -- */
+
+template <std::size_t M, std::size_t K, std::size_t N>
+NOINLINE void naive_matmul(const multi_array<float, M, K>& a, const multi_array<float, K, N>& b, multi_array<float, M, N>& c)
+{
+    for (size_t i = 0; i < M; ++i)
+    {
+        for (size_t j = 0; j < N; ++j)
+        {
+            float sum = 0.0f;
+            for (size_t p = 0; p < K; ++p)
+                sum += a[i][p] * b[p][j];
+            c[i][j] = sum;
+        }
+    }
+}
+
+static void matrix_multiply_test()
+{
+    TEST_HEADLINE;
+
+    const char* level_names[] = { "scalar", "sse", "avx2" };
+    std::cout << "cpu_simd_level = " << level_names[static_cast<int>(details::cpu_simd_level())] << std::endl;
+
+    /* Compare all kernels with odd matrix sizes, so the edges of the register tiles are tested as well */
+    grid_vector<float> a, b, c;
+    a.resize(53, 37);
+    b.resize(29, 53);
+    for (size_t i = 0; i < 53*37; ++i)
+        a.data()[i] = static_cast<float>(i % 5) - 2.0f;
+    for (size_t i = 0; i < 29*53; ++i)
+        b.data()[i] = static_cast<float>(i % 7) - 3.0f;
+
+    matmul(a, b, c);
+    std::cout << "matmul(grid_vector) size = " << c.width() << " x " << c.height() << std::endl;
+
+    for (int level = 0; level <= static_cast<int>(details::cpu_simd_level()); ++level)
+    {
+        std::vector<float> d(29*37);
+        details::gemm(static_cast<details::simd_level>(level), 37, 29, 53, a.data(), 53, b.data(), 29, d.data(), 29);
+        std::cout << level_names[level] << " gemm equal: " << std::boolalpha << std::equal(d.begin(), d.end(), c.begin()) << std::endl;
+    }
+
+    std::vector<float> x(53, 1.0f), y;
+    gemv(a, x, y);
+
+    float row_sum = 0.0f;
+    for (size_t j = 0; j < 53; ++j)
+        row_sum += a(j, 3);
+    std::cout << "gemv(grid_vector)[3] = " << y[3] << " (expected " << row_sum << ")" << std::endl;
+
+    /* Compare with the naive triple loop */
+    typedef multi_array<float, 256, 256> my_matrix_t;
+
+    std::unique_ptr<my_matrix_t> ma { new my_matrix_t() }, mb { new my_matrix_t() }, mc { new my_matrix_t() }, md { new my_matrix_t() };
+    for (size_t i = 0; i < my_matrix_t::num_elements; ++i)
+    {
+        ma->data()[i] = static_cast<float>(i % 3);
+        mb->data()[i] = static_cast<float>(i % 5);
+    }
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    {
+        for (int i = 0; i < 10; ++i)
+            naive_matmul(*ma, *mb, *mc);
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    {
+        for (int i = 0; i < 10; ++i)
+            matmul(*ma, *mb, *md);
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "naive matmul 256x256: " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us" << std::endl;
+    std::cout << "matmul 256x256:       " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us" << std::endl;
+    std::cout << "results equal: " << std::boolalpha << std::equal(mc->begin(), mc->end(), md->begin()) << std::endl;
+
+    multi_array<float, 256> vx(1.0f), vy0, vy1;
+
+    t0 = std::chrono::high_resolution_clock::now();
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            for (size_t r = 0; r < 256; ++r)
+            {
+                float sum = 0.0f;
+                for (size_t j = 0; j < 256; ++j)
+                    sum += (*ma)[r][j] * vx[j];
+                vy0[r] = sum;
+            }
+        }
+    }
+    t1 = std::chrono::high_resolution_clock::now();
+    {
+        for (int i = 0; i < 1000; ++i)
+            gemv(*ma, vx, vy1);
+    }
+    t2 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "naive gemv 256x256:   " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us" << std::endl;
+    std::cout << "gemv 256x256:         " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us" << std::endl;
+    std::cout << "results equal: " << std::boolalpha << std::equal(vy0.begin(), vy0.end(), vy1.begin()) << std::endl;
+}
+
+/* --- mapped_array test -- */
+
+static void mapped_array_test()
+{
+    TEST_HEADLINE;
+
+    typedef heap_multi_array<float, 512, 512, 16> my_tensor_t;
+
+    my_tensor_t a;
+    for (size_t i = 0; i < my_tensor_t::num_elements; ++i)
+        a.data()[i] = static_cast<float>(i % 1000);
+
+    save("mapped_array_test.bin", a);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    mapped_multi_array_view<float, 512, 512, 16> mapped("mapped_array_test.bin");
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "mapped_multi_array_view opened in " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us" << std::endl;
+    std::cout << "mapped(1, 2, 3) = " << mapped(1, 2, 3) << ", a(1, 2, 3) = " << a(1, 2, 3) << std::endl;
+    std::cout << "mapped[1][2][3] = " << mapped[1][2][3] << std::endl;
+    std::cout << "mapped equal: " << std::boolalpha << std::equal(mapped.begin(), mapped.end(), a.begin()) << std::endl;
+
+    try
+    {
+        mapped_multi_array_view<float, 512, 16, 512> wrong_extents("mapped_array_test.bin");
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cout << "mapped_multi_array_view<float, 512, 16, 512> failed: " << e.what() << std::endl;
+    }
+
+    try
+    {
+        mapped_grid_view<double> wrong_type("mapped_array_test.bin");
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cout << "mapped_grid_view<double> failed: " << e.what() << std::endl;
+    }
+
+    grid_vector<int> grid;
+    grid.resize(300, 200, 1);
+    grid(299, 199) = 42;
+    save("mapped_grid_test.bin", grid);
+
+    mapped_grid_view<int> mapped_grid("mapped_grid_test.bin");
+    std::cout << "mapped_grid size = " << mapped_grid.width() << " x " << mapped_grid.height() << std::endl;
+    std::cout << "mapped_grid(299, 199) = " << mapped_grid(299, 199) << ", mapped_grid.at(0, 0) = " << mapped_grid.at(0, 0) << std::endl;
+
+    // Extents of a crafted header whose number of bytes wraps around to zero
+    {
+        const std::uint64_t crafted_extents[] = { std::uint64_t(1) << 62, 4 };
+        std::fstream file("mapped_grid_test.bin", std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(offsetof(details::array_file_header, extents));
+        file.write(reinterpret_cast<const char*>(crafted_extents), sizeof(crafted_extents));
+    }
+    try
+    {
+        mapped_grid_view<int> crafted("mapped_grid_test.bin");
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cout << "mapped_grid_view with crafted extents failed: " << e.what() << std::endl;
+    }
+
+    std::remove("mapped_array_test.bin");
+    std::remove("mapped_grid_test.bin");
+}
+
+/* --- sparse_multi_array test -- */
+
+static void sparse_multi_array_test()
+{
+    TEST_HEADLINE;
+
+    typedef sparse_multi_array<float, 1024, 1024, 1024> my_volume_t;
+
+    my_volume_t volume(-1.0f);
+
+    volume[10][20][30] = 1.0f;
+    volume(11, 20, 30) = 2.0f;
+    volume(1000, 1000, 1000) = 3.0f;
+
+    const my_volume_t& cvolume = volume;
+    std::cout << "num_bricks = " << my_volume_t::num_bricks << ", allocated_bricks() = " << volume.allocated_bricks() << std::endl;
+    std::cout << "volume[10][20][30] = " << cvolume[10][20][30] << ", volume(11, 20, 30) = " << cvolume(11, 20, 30) << std::endl;
+    std::cout << "volume[500][500][500] = " << cvolume[500][500][500] << std::endl;
+
+    float x = volume[500][500][500];
+    std::cout << "read through proxy = " << x << ", allocated_bricks() = " << volume.allocated_bricks() << std::endl;
+
+    std::size_t n = 0;
+    float sum = 0.0f;
+    for (auto it = volume.begin(); it != volume.end(); ++it)
+    {
+        if (*it != volume.background())
+        {
+            auto idx = it.indices();
+            std::cout << "  (" << idx[0] << ", " << idx[1] << ", " << idx[2] << ") = " << *it << std::endl;
+        }
+        sum += *it;
+        ++n;
+    }
+    std::cout << "visited " << n << " elements, sum = " << sum << std::endl;
+
+    // Partial bricks: elements outside of the extents are skipped
+    sparse_multi_array<int, 10, 10> partial(0);
+    partial[9][9] = 5;
+    std::cout << "partial elements visited = " << std::distance(partial.begin(), partial.end()) << std::endl;
+
+    // 1-dimensional arrays return the element proxy from operator[]
+    sparse_multi_array<int, 100> line(0);
+    line[3] = 5;
+    const auto& cline = line;
+    std::cout << "line[3] = " << cline[3] << ", line[4] = " << cline[4] << ", allocated_bricks() = " << line.allocated_bricks() << std::endl;
+
+    try
+    {
+        cvolume.at(1024, 0, 0);
+    }
+    catch (const std::out_of_range& e)
+    {
+        std::cout << "volume.at(1024, 0, 0) failed: " << e.what() << std::endl;
+    }
+
+    volume.clear();
+    std::cout << "after clear: allocated_bricks() = " << volume.allocated_bricks() << ", volume(10, 20, 30) = " << cvolume(10, 20, 30) << std::endl;
+}
+
+/* --- stencil test -- */
+
+static void stencil_test()
+{
+    TEST_HEADLINE;
+
+    typedef heap_multi_array<float, 128, 128, 128> my_volume_t;
+
+    my_volume_t a, b, c;
+    for (size_t i = 0; i < my_volume_t::num_elements; ++i)
+        a.data()[i] = static_cast<float>(i % 97);
+
+    auto clamp = [](int i) { return (i < 0 ? 0 : (i > 127 ? 127 : i)); };
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    {
+        // Naive 3x3x3 box filter with boundary checks for every neighbor
+        for (int z = 0; z < 128; ++z)
+        {
+            for (int y = 0; y < 128; ++y)
+            {
+                for (int x = 0; x < 128; ++x)
+                {
+                    float sum = 0.0f;
+                    for (int k = -1; k <= 1; ++k)
+                        for (int j = -1; j <= 1; ++j)
+                            for (int i = -1; i <= 1; ++i)
+                                sum += a(clamp(z + k), clamp(y + j), clamp(x + i));
+                    b(z, y, x) = sum / 27.0f;
+                }
+            }
+        }
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    {
+        stencil_transform<1>(a, c, clamp_border(), [](const neighborhood<float, 3>& n)
+        {
+            float sum = 0.0f;
+            for (int k = -1; k <= 1; ++k)
+                for (int j = -1; j <= 1; ++j)
+                    for (int i = -1; i <= 1; ++i)
+                        sum += n(k, j, i);
+            return sum / 27.0f;
+        });
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "naive box filter 3x3x3:   " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us" << std::endl;
+    std::cout << "stencil_transform 3x3x3:  " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us" << std::endl;
+    std::cout << "results equal: " << std::boolalpha << std::equal(b.begin(), b.end(), c.begin()) << std::endl;
+
+    auto PrintGrid = [](const grid_vector<int>& g, const char* name)
+    {
+        std::cout << name << ":" << std::endl;
+        for (size_t y = 0; y < g.height(); ++y)
+        {
+            for (size_t x = 0; x < g.width(); ++x)
+                std::cout << ' ' << std::setw(2) << g(x, y);
+            std::cout << std::endl;
+        }
+    };
+
+    grid_vector<int> grid, laplace;
+    grid.resize(5, 4, 0);
+    grid(0, 0) = 1;
+
+    stencil_transform<1>(grid, laplace, wrap_border(), [](const neighborhood<int, 2>& n)
+    {
+        return n(-1, 0) + n(1, 0) + n(0, -1) + n(0, 1) - 4*n.center();
+    });
+    PrintGrid(laplace, "wrapped laplace");
+
+    stencil_transform<1>(grid, laplace, make_constant_border(10), [](const neighborhood<int, 2>& n)
+    {
+        return n(-1, -1);
+    });
+    PrintGrid(laplace, "constant border shifted");
+}
+
+/* --- convolution test -- */
+
+static void convolution_test()
+{
+    TEST_HEADLINE;
+
+    const char* level_names[] = { "scalar", "sse", "avx2" };
+
+    /* Odd sizes, so the edges of the SIMD kernels are tested as well */
+    const size_t width = 203, height = 77;
+
+    padded_grid_vector<float> image;
+    image.resize_padded(width, height, width + 5);
+    for (size_t y = 0; y < height; ++y)
+    {
+        for (size_t x = 0; x < width; ++x)
+            image(x, y) = static_cast<float>((x * 3 + y * 7) % 11);
+    }
+
+    grid_vector<float> kernel;
+    kernel.resize(5, 3);
+    for (size_t i = 0; i < 15; ++i)
+        kernel.data()[i] = static_cast<float>(static_cast<int>(i % 4) - 1) * 0.25f;
+
+    // Naive convolution with clamped borders
+    auto Clamp = [](std::ptrdiff_t i, size_t n) { return static_cast<size_t>(i < 0 ? 0 : (i >= static_cast<std::ptrdiff_t>(n) ? n - 1 : i)); };
+    grid_vector<float> expected;
+    expected.resize(width, height);
+    for (size_t y = 0; y < height; ++y)
+    {
+        for (size_t x = 0; x < width; ++x)
+        {
+            float sum = 0.0f;
+            for (size_t j = 0; j < 3; ++j)
+            {
+                for (size_t i = 0; i < 5; ++i)
+                    sum += kernel(i, j) * image(Clamp(static_cast<std::ptrdiff_t>(x + i) - 2, width), Clamp(static_cast<std::ptrdiff_t>(y + j) - 1, height));
+            }
+            expected(x, y) = sum;
+        }
+    }
+
+    auto MaxDiff = [](const grid_vector<float>& a, const grid_vector<float>& b)
+    {
+        float diff = 0.0f;
+        for (size_t y = 0; y < a.height(); ++y)
+        {
+            for (size_t x = 0; x < a.width(); ++x)
+                diff = std::max(diff, std::abs(a(x, y) - b(x, y)));
+        }
+        return diff;
+    };
+
+    for (int level = 0; level <= static_cast<int>(details::cpu_simd_level()); ++level)
+    {
+        std::vector<float> weights(kernel.begin(), kernel.end());
+        grid_vector<float> result;
+        result.resize(width, height);
+        details::convolve_2d(
+            static_cast<details::simd_level>(level), default_thread_pool(),
+            image.data(), image.pitch(), result.data(), result.pitch(), width, height,
+            weights.data(), 5, 3, clamp_border()
+        );
+        std::cout << level_names[level] << " convolve max. difference: " << MaxDiff(result, expected) << std::endl;
+    }
+
+    // Separable kernels are equal to the outer product of both kernels
+    const std::vector<float> gauss { 1/16.0f, 4/16.0f, 6/16.0f, 4/16.0f, 1/16.0f };
+    grid_vector<float> gauss2d, blurred0, blurred1;
+    gauss2d.resize(5, 5);
+    for (size_t j = 0; j < 5; ++j)
+    {
+        for (size_t i = 0; i < 5; ++i)
+            gauss2d(i, j) = gauss[i] * gauss[j];
+    }
+
+    convolve(image, blurred0, gauss2d, make_constant_border(1.0f));
+    convolve_separable(image, blurred1, gauss, gauss, make_constant_border(1.0f));
+    std::cout << "separable max. difference: " << MaxDiff(blurred0, blurred1) << std::endl;
+
+    // 8-bit images are rounded and saturated
+    grid_vector<std::uint8_t> gray, sharpened;
+    gray.resize(8, 3, 100);
+    gray(4, 1) = 250;
+    const std::vector<float> sharpen { -1.0f, 3.0f, -1.0f }, identity { 1.0f };
+    convolve_separable(gray, sharpened, sharpen, identity, wrap_border());
+    std::cout << "sharpen(uint8_t) row 1:";
+    for (size_t x = 0; x < 8; ++x)
+        std::cout << ' ' << static_cast<int>(sharpened(x, 1));
+    std::cout << std::endl;
+
+    // Benchmark with a 7x7 Gaussian blur
+    const size_t size = 1024;
+    const std::vector<float> gauss7 { 1/64.0f, 6/64.0f, 15/64.0f, 20/64.0f, 15/64.0f, 6/64.0f, 1/64.0f };
+    grid_vector<float> gauss7x7, big, out0, out1, out2;
+    gauss7x7.resize(7, 7);
+    for (size_t j = 0; j < 7; ++j)
+    {
+        for (size_t i = 0; i < 7; ++i)
+            gauss7x7(i, j) = gauss7[i] * gauss7[j];
+    }
+    big.resize(size, size);
+    for (size_t i = 0; i < size*size; ++i)
+        big.data()[i] = static_cast<float>(i % 251);
+    out0.resize(size, size);
+
+    std::vector<float> weights7x7(gauss7x7.begin(), gauss7x7.end());
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    details::convolve_2d(details::simd_level::scalar, default_thread_pool(), big.data(), size, out0.data(), size, size, size, weights7x7.data(), 7, 7, clamp_border());
+    auto t1 = std::chrono::high_resolution_clock::now();
+    convolve(big, out1, gauss7x7, clamp_border());
+    auto t2 = std::chrono::high_resolution_clock::now();
+    convolve_separable(big, out2, gauss7, gauss7, clamp_border());
+    auto t3 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "scalar convolve 7x7:      " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us" << std::endl;
+    std::cout << "convolve 7x7:             " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us" << std::endl;
+    std::cout << "convolve_separable 7+7:   " << std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() << " us" << std::endl;
+    std::cout << "max. difference: " << std::max(MaxDiff(out0, out1), MaxDiff(out0, out2)) << std::endl;
+}
+
+/* --- multi_array slice copy test -- */
+
+static void multi_array_slice_copy_test()
+{
+    TEST_HEADLINE;
+
+    typedef heap_multi_array<float, 16, 256, 256> ring_buffer_t;
+
+    ring_buffer_t frames, ring;
+    for (size_t i = 0; i < ring_buffer_t::num_elements; ++i)
+        frames.data()[i] = static_cast<float>(i % 1000);
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    {
+        // Element-wise copy of each slice
+        for (int n = 0; n < 100; ++n)
+        {
+            for (size_t i = 0; i < 16; ++i)
+            {
+                for (size_t y = 0; y < 256; ++y)
+                {
+                    for (size_t x = 0; x < 256; ++x)
+                        ring[(i + n) % 16][y][x] = frames[i][y][x];
+                }
+            }
+        }
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    {
+        for (int n = 0; n < 100; ++n)
+        {
+            for (size_t i = 0; i < 16; ++i)
+                copy_slice(frames[i], ring[(i + n) % 16]);
+        }
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "element-wise slice copy:  " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us" << std::endl;
+    std::cout << "copy_slice:               " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us" << std::endl;
+    std::cout << "ring[2] == frames[15]: " << std::boolalpha << std::equal(frames[15].data(), frames[15].data() + 65536, ring[2].data()) << std::endl;
+
+    // Slice assignment between arrays with different storage and from a range
+    multi_array<int, 2, 3, 4> a(0);
+    const heap_multi_array<int, 2, 3, 4> b(7);
+    a[0] = b[1];
+    a[1][2] = a[0][1];
+
+    std::vector<int> values { 1, 2, 3, 4 };
+    a[1][0].assign(values.begin(), values.end());
+    std::cout << "a[0][2][3] = " << a[0][2][3] << ", a[1][2][0] = " << a[1][2][0] << ", a[1][0][3] = " << a[1][0][3] << std::endl;
+
+    // Non-contiguous slices are copied element-wise
+    basic_multi_array<int, array_storage, column_major_layout, 2, 4> c(0);
+    c[1] = a[1][0];
+    std::cout << "c[1][3] = " << c[1][3] << std::endl;
+
+    // Types that are not trivially copyable are moved element-wise
+    multi_array<std::string, 2, 2> strings;
+    strings[0][0] = "hello";
+    strings[0][1] = "world";
+    move_slice(strings[0], strings[1]);
+    std::cout << "strings[1] = " << strings[1][0] << " " << strings[1][1] << ", strings[0][0].empty() = " << strings[0][0].empty() << std::endl;
+}
+
+/* --- multi_array constexpr test -- */
+
+// CRC-32 lookup table entry (constexpr function object, so it also works with C++14)
+struct crc32_table_entry
+{
+    CPPLIBEXT_CONSTEXPR14 std::uint32_t operator () (size_t n) const
+    {
+        std::uint32_t c = static_cast<std::uint32_t>(n);
+        for (int k = 0; k < 8; ++k)
+            c = ((c & 1) != 0 ? 0xEDB88320u ^ (c >> 1) : (c >> 1));
+        return c;
+    }
+};
+
+static void multi_array_constexpr_test()
+{
+    TEST_HEADLINE;
+
+    #if CPPLIBEXT_CPLUSPLUS >= 201402L
+    static constexpr auto crc32_table = make_multi_array<std::uint32_t, 256>(crc32_table_entry());
+    static_assert(crc32_table[1] == 0x77073096u, "CRC-32 table must be computed at compile time");
+    std::cout << "CRC-32 table computed at compile time" << std::endl;
+    #else
+    static const auto crc32_table = make_multi_array<std::uint32_t, 256>(crc32_table_entry());
+    std::cout << "CRC-32 table computed at runtime (C++11)" << std::endl;
+    #endif
+
+    std::uint32_t crc = 0xFFFFFFFFu;
+    for (char c : std::string("123456789"))
+        crc = crc32_table[(crc ^ static_cast<std::uint8_t>(c)) & 0xFF] ^ (crc >> 8);
+    std::cout << "crc32(\"123456789\") = " << std::hex << (crc ^ 0xFFFFFFFFu) << std::dec << " (expected cbf43926)" << std::endl;
+
+    auto gamma = make_multi_array<std::uint8_t, 4, 4>([](size_t i, size_t j) { return static_cast<std::uint8_t>(i * 4 + j); });
+    std::cout << "gamma(3, 2) = " << static_cast<int>(gamma(3, 2)) << std::endl;
+
+    heap_multi_array<float, 2, 3> zeros { value_init_tag() };
+    std::cout << "zeros(1, 2) = " << zeros(1, 2) << std::endl;
+}
+
+/* --- parallel_algorithm test -- */
+
+static void parallel_algorithm_test()
+{
+    TEST_HEADLINE;
+
+    typedef heap_multi_array<float, 256, 512, 512> my_tensor_t;
+
+    my_tensor_t a(0.0f), b(0.0f);
+
+    thread_pool pool(4);
+    std::cout << "pool.concurrency() = " << pool.concurrency() << std::endl;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    {
+        a.fill(1.0f);
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    {
+        parallel_fill(pool, a, 1.0f);
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "fill:                 " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us" << std::endl;
+    std::cout << "parallel_fill:        " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us" << std::endl;
+
+    parallel_for_each(pool, a[3], [](float& x) { x = 2.0f; });
+    parallel_transform(pool, a, b, [](float x) { return x * 0.5f; });
+
+    t0 = std::chrono::high_resolution_clock::now();
+    float sum0 = 0.0f;
+    {
+        for (auto x : b)
+            sum0 += x;
+    }
+    t1 = std::chrono::high_resolution_clock::now();
+    float sum1 = 0.0f;
+    {
+        sum1 = parallel_reduce(pool, b, 0.0f, std::plus<float>());
+    }
+    t2 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "sequential sum:       " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us (sum = " << sum0 << ")" << std::endl;
+    std::cout << "parallel_reduce:      " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us (sum = " << sum1 << ")" << std::endl;
+    std::cout << "(the sequential float sum loses precision, while the partial sums of each chunk stay small)" << std::endl;
+
+    /* The reduction order only depends on the outermost dimension, so the result is the same for any number of threads */
+    thread_pool single_pool(1);
+    float sum2 = parallel_reduce(single_pool, b, 0.0f, std::plus<float>());
+    std::cout << "deterministic reduction: " << std::boolalpha << (sum1 == sum2) << std::endl;
+
+    grid_vector<int> grid;
+    grid.resize(100, 50, 1);
+    std::cout << "parallel_reduce(grid) = " << parallel_reduce(grid, 0, std::plus<int>()) << std::endl;
+    std::cout << "max of a[3] = " << parallel_reduce(a[3], 0.0f, [](float x, float y) { return std::max(x, y); }) << std::endl;
+
+    // Reduction of bool elements, whose partial results must not be packed into the same word
+    thread_pool mask_pool(8);
+    heap_multi_array<bool, 256, 256> mask(false);
+    const bool any0 = parallel_reduce(mask_pool, mask, false, std::logical_or<bool>());
+    mask[200][17] = true;
+    const bool any1 = parallel_reduce(mask_pool, mask, false, std::logical_or<bool>());
+    std::cout << "any of mask = " << any0 << " (expected false), after write = " << any1 << " (expected true)" << std::endl;
+}
+
+/* --- dynamic_multi_array test -- */
+
+static void dynamic_multi_array_test()
+{
+    TEST_HEADLINE;
+
+    dynamic_multi_array<int, 3> my_array { 3, 4, 2 };
+
+    std::cout << "# of dimensions:\t" << my_array.num_dimensions << std::endl;
+    std::cout << "# of elements:\t\t" << my_array.size() << std::endl;
+    std::cout << "extents:\t\t" << my_array.slices<0>() << ", " << my_array.slices<1>() << ", " << my_array.slices<2>() << std::endl;
+    std::cout << "strides:\t\t" << my_array.strides()[0] << ", " << my_array.strides()[1] << ", " << my_array.strides()[2] << std::endl;
+
+    std::cout << std::endl;
+
+    for (size_t x = 0; x < 3; ++x)
+    {
+        for (size_t y = 0; y < 4; ++y)
+        {
+            for (size_t z = 0; z < 2; ++z)
+                my_array.at(x).at(y).at(z) = static_cast<int>((x + 1)*(y + 1)*(z + 1));
+        }
+    }
+
+    my_array[1] = -1;
+    my_array[2][1] = -3;
+    my_array[2][2][0] = -5;
+
+    const auto& const_array = my_array;
+
+    for (size_t x = 0; x < 3; ++x)
+    {
+        for (size_t y = 0; y < 4; ++y)
+        {
+            for (size_t z = 0; z < 2; ++z)
+                std::cout << "my_array[" << x << "]" << "[" << y << "]" << "[" << z << "] = " << const_array[x][y][z] << std::endl;
+        }
+    }
+
+    dynamic_multi_array<int, 1> single_dim_array { 5 };
+    single_dim_array.fill(3);
+    single_dim_array[4] = 7;
+
+    std::cout << std::endl << "single_dim_array:" << std::endl;
+    for (auto v : single_dim_array)
+        std::cout << "single_dim_array[x] = " << v << std::endl;
+}
+
+/* --- multi_array_view test -- */
+
+static void multi_array_view_test()
+{
+    TEST_HEADLINE;
+
+    multi_array<int, 3, 4> my_array;
+
+    for (size_t x = 0; x < 3; ++x)
+    {
+        for (size_t y = 0; y < 4; ++y)
+            my_array(x, y) = static_cast<int>(x*10 + y);
+    }
+
+    auto PrintView = [](const multi_array_view<const int, 2>& v, const char* name)
+    {
+        std::cout << name << " (" << v.extents()[0] << " x " << v.extents()[1] << ", contiguous: " << std::boolalpha << v.is_contiguous() << "):" << std::endl;
+        for (size_t x = 0; x < v.extents()[0]; ++x)
+        {
+            std::cout << "  ";
+            for (size_t y = 0; y < v.extents()[1]; ++y)
+                std::cout << v(x, y) << '\t';
+            std::cout << std::endl;
+        }
+    };
+
+    auto view = make_multi_array_view(my_array);
+
+    PrintView(view, "view");
+    PrintView(view.transpose(0, 1), "view.transpose(0, 1)");
+    PrintView(view.subarray({{ 1, 1 }}, {{ 3, 3 }}), "view.subarray({ 1, 1 }, { 3, 3 })");
+    PrintView(view.reverse(1), "view.reverse(1)");
+    PrintView(view.step(1, 2), "view.step(1, 2)");
+
+    view.subarray({{ 0, 2 }}, {{ 3, 4 }}).step(0, 2) = -1;
+    PrintView(view, "view after filling view.subarray({ 0, 2 }, { 3, 4 }).step(0, 2)");
+
+    std::cout << "view.transpose()[2][1] = " << view.transpose()[2][1] << std::endl;
+
+    std::cout << "view.reverse(0) in logical order:";
+    for (auto x : view.reverse(0))
+        std::cout << ' ' << x;
+    std::cout << std::endl;
+
+    std::cout << "iterator of the temporary view.transpose():";
+    for (auto it = view.transpose().begin(), end = view.transpose().end(); it != end; ++it)
+        std::cout << ' ' << *it;
+    std::cout << std::endl;
+
+    std::cout << "view.transpose() in memory order:";
+    view.transpose().for_each([](int x) { std::cout << ' ' << x; });
+    std::cout << std::endl;
+}
+
 /* --- grid_vector test -- */
 
 static void grid_vector_test()
@@ -210,6 +1307,448 @@ static void grid_vector_test()
     std::cout << "grid size = ( " << grid.width() << ", " << grid.height() << " )" << std::endl;
 }
 
+/* --- grid_vector pitch test --- */
+
+static void grid_vector_pitch_test()
+{
+    TEST_HEADLINE;
+
+    const size_t size = 1024;
+
+    grid_vector<float> dense;
+    dense.resize(size, size, 1.0f);
+    padded_grid_vector<float> padded;
+    padded.resize_padded(size, size, padded_grid_vector<float>::padded_pitch(size), 1.0f);
+
+    std::cout << "dense.pitch() = " << dense.pitch() << ", padded.pitch() = " << padded.pitch() << std::endl;
+
+    // Column-wise traversal, where each row of the dense grid maps to the same cache sets
+    auto ColumnSums = [size](const float* data, size_t pitch, std::vector<float>& sums)
+    {
+        sums.assign(size, 0.0f);
+        for (size_t x = 0; x < size; x += 8)
+        {
+            for (size_t y = 0; y < size; ++y)
+            {
+                const float* row = data + y*pitch + x;
+                for (size_t i = 0; i < 8; ++i)
+                    sums[x + i] += row[i];
+            }
+        }
+    };
+
+    std::vector<float> sums0, sums1;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < 10; ++i)
+        ColumnSums(dense.data(), dense.pitch(), sums0);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < 10; ++i)
+        ColumnSums(padded.data(), padded.pitch(), sums1);
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "column sums (pitch " << dense.pitch() << "):  " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us" << std::endl;
+    std::cout << "column sums (pitch " << padded.pitch() << "):  " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us" << std::endl;
+    std::cout << "results equal: " << std::boolalpha << (sums0 == sums1) << std::endl;
+
+    // Iterators and algorithms skip the padding
+    padded_grid_vector<int> grid;
+    grid.resize_padded(3, 2, 4, -1);
+    int n = 0;
+    for (auto& x : grid)
+        x = ++n;
+
+    std::cout << "grid =";
+    for (auto it = grid.rbegin(); it != grid.rend(); ++it)
+        std::cout << ' ' << *it;
+    std::cout << " (reversed), distance = " << std::distance(grid.begin(), grid.end()) << ", grid(2, 1) = " << grid(2, 1) << ", padding = " << grid.data()[3] << std::endl;
+    std::cout << "parallel_reduce = " << parallel_reduce(grid, 0, std::plus<int>()) << std::endl;
+}
+
+/* --- grid_vector resize test --- */
+
+static void grid_vector_resize_test()
+{
+    TEST_HEADLINE;
+
+    auto PrintGrid = [](const grid_vector<int>& g, const char* name)
+    {
+        std::cout << name << " (" << g.width() << " x " << g.height() << "):" << std::endl;
+        for (size_t y = 0; y < g.height(); ++y)
+        {
+            for (size_t x = 0; x < g.width(); ++x)
+                std::cout << std::setw(3) << g(x, y);
+            std::cout << std::endl;
+        }
+    };
+
+    grid_vector<int> grid;
+    grid.resize(4, 3);
+    int n = 0;
+    for (auto& x : grid)
+        x = ++n;
+
+    PrintGrid(grid, "grid");
+
+    // Shrinking shuffles the rows in place
+    grid.resize(3, 2);
+    PrintGrid(grid, "resize(3, 2)");
+
+    // Growing reallocates once and keeps the elements at their (x, y) coordinates
+    grid.resize(5, 4, 0);
+    PrintGrid(grid, "resize(5, 4, 0)");
+
+    padded_grid_vector<int> padded_grid;
+    padded_grid.resize(5, 4);
+    std::copy(grid.begin(), grid.end(), padded_grid.begin());
+    padded_grid.resize_padded(5, 4, 8);
+    std::cout << "resize_padded(5, 4, 8): pitch = " << padded_grid.pitch() << ", grid(2, 1) = " << padded_grid(2, 1) << " (expected 7)" << std::endl;
+
+    // Reshaping keeps the order in memory
+    grid_vector<int> flat;
+    flat.resize(6, 2);
+    n = 0;
+    for (auto& x : flat)
+        x = ++n;
+    flat.reshape(3, 4);
+    PrintGrid(flat, "reshape(3, 4)");
+
+    try
+    {
+        flat.reshape(5, 2);
+    }
+    catch (const std::invalid_argument& e)
+    {
+        std::cout << "reshape(5, 2) failed: " << e.what() << std::endl;
+    }
+}
+
+/* --- grid_vector dirty tracking test --- */
+
+static void grid_vector_dirty_test()
+{
+    TEST_HEADLINE;
+
+    auto PrintRegions = [](const tracked_grid_vector<int>& g, const char* name)
+    {
+        std::cout << name << ':';
+        for (const auto& r : g.dirty_regions())
+            std::cout << " (" << r.x << ", " << r.y << ", " << r.width << " x " << r.height << ")";
+        std::cout << std::endl;
+    };
+
+    tracked_grid_vector<int> grid;
+    grid.resize(100, 100, 0);
+
+    // Rectangles: row-wise writes are coalesced into a single region
+    grid.enable_dirty_tracking(dirty_tracking::rectangles);
+    for (size_t y = 10; y < 20; ++y)
+    {
+        for (size_t x = 5; x < 25; ++x)
+            grid(x, y) = 1;
+    }
+    grid(90, 90) = 2;
+    grid.at(91, 90) = 3;
+    PrintRegions(grid, "rectangles");
+
+    grid.clear_dirty();
+    std::cout << "after clear_dirty: is_dirty() = " << std::boolalpha << grid.is_dirty() << std::endl;
+
+    // Tiles: one bit per 16x16 tile
+    grid.enable_dirty_tracking(dirty_tracking::tiles, 16, 16);
+    grid(0, 0) = 1;
+    grid(17, 5) = 1;
+    grid(3, 20) = 1;
+    grid(20, 20) = 1;
+    grid.mark_dirty(95, 95, 10, 10);
+    PrintRegions(grid, "tiles");
+
+    // Parallel algorithms mark the entire grid
+    grid.clear_dirty();
+    parallel_fill(grid, 7);
+    PrintRegions(grid, "parallel_fill");
+
+    // Cost of operator() with the untracked policy, with tracking disabled, and with tile tracking
+    grid_vector<float> plain;
+    tracked_grid_vector<float> disabled, tracked;
+    plain.resize(1024, 1024);
+    disabled.resize(1024, 1024);
+    tracked.resize(1024, 1024);
+    tracked.enable_dirty_tracking(dirty_tracking::tiles);
+
+    auto FillPlain = [](grid_vector<float>& g)
+    {
+        for (size_t y = 0; y < g.height(); ++y)
+        {
+            for (size_t x = 0; x < g.width(); ++x)
+                g(x, y) = static_cast<float>(x + y);
+        }
+    };
+
+    auto FillTracked = [](tracked_grid_vector<float>& g)
+    {
+        for (size_t y = 0; y < g.height(); ++y)
+        {
+            for (size_t x = 0; x < g.width(); ++x)
+                g(x, y) = static_cast<float>(x + y);
+        }
+    };
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < 10; ++i)
+        FillPlain(plain);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < 10; ++i)
+        FillTracked(disabled);
+    auto t2 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < 10; ++i)
+        FillTracked(tracked);
+    auto t3 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "fill (untracked):          " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us" << std::endl;
+    std::cout << "fill (tracking disabled):  " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us" << std::endl;
+    std::cout << "fill (tile tracking):      " << std::chrono::duration_cast<std::chrono::microseconds>(t3 - t2).count() << " us" << std::endl;
+}
+
+/* --- grid_vector views test --- */
+
+static void grid_vector_views_test()
+{
+    TEST_HEADLINE;
+
+    padded_grid_vector<int> grid;
+    grid.resize_padded(5, 4, 8);
+    for (std::size_t y = 0; y < grid.height(); ++y)
+    {
+        for (std::size_t x = 0; x < grid.width(); ++x)
+            grid(x, y) = static_cast<int>(y * 10 + x);
+    }
+
+    // Row and column views
+    auto row = grid.row(2);
+    std::cout << "row(2) =";
+    for (auto x : row)
+        std::cout << ' ' << x;
+    std::cout << " (size " << row.size() << ")" << std::endl;
+
+    const auto& const_grid = grid;
+    auto column = const_grid.column(3);
+    std::cout << "column(3) =";
+    for (auto x : column)
+        std::cout << ' ' << x;
+    std::cout << " (stride " << column.stride() << ", sum " << std::accumulate(column.begin(), column.end(), 0) << ")" << std::endl;
+
+    std::sort(grid.column(1).begin(), grid.column(1).end(), std::greater<int>());
+    std::cout << "sorted column(1) descending: " << grid(1, 0) << ' ' << grid(1, 1) << ' ' << grid(1, 2) << ' ' << grid(1, 3) << std::endl;
+
+    const int* raw_row = grid.row(3);
+    std::cout << "raw row(3)[4] = " << raw_row[4] << std::endl;
+
+    // Splitting the rows into blocks
+    auto rows = grid.rows();
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        auto block = rows.split(i, 3);
+        std::cout << "rows.split(" << i << ", 3) = [" << block.first() << ", " << block.last() << ")" << std::endl;
+    }
+
+    // Dirty tracking of column views
+    tracked_grid_vector<int> tracked;
+    tracked.resize(64, 64);
+    tracked.enable_dirty_tracking(dirty_tracking::rectangles);
+    tracked.column(7)[10] = 1;
+    for (const auto& r : tracked.dirty_regions())
+        std::cout << "dirty region after column(7): (" << r.x << ", " << r.y << ", " << r.width << ", " << r.height << ")" << std::endl;
+
+    // Parallel row iteration on a padded grid
+    padded_grid_vector<float> image;
+    image.resize_padded(1000, 1000, padded_grid_vector<float>::padded_pitch(1024));
+    parallel_for_each_row(
+        image,
+        [](grid_row<float> row, std::size_t y)
+        {
+            for (std::size_t x = 0; x < row.size(); ++x)
+                row[x] = static_cast<float>(x + y);
+        }
+    );
+
+    bool equal = true;
+    for (std::size_t y = 0; y < image.height(); ++y)
+    {
+        for (std::size_t x = 0; x < image.width(); ++x)
+            equal = equal && (image(x, y) == static_cast<float>(x + y));
+    }
+    std::cout << "parallel_for_each_row equals index math: " << std::boolalpha << equal << std::endl;
+}
+
+/* --- chunked_grid test --- */
+
+static void chunked_grid_test()
+{
+    TEST_HEADLINE;
+
+    typedef chunked_grid<int, 16, 16> my_world_t;
+
+    my_world_t world(-1);
+
+    world(0, 0) = 1;
+    world(-1, -1) = 2;
+    world(-16, 15) = 3;
+    world(1000000, -2000000) = 4;
+
+    const my_world_t& cworld = world;
+    std::cout << "allocated_chunks() = " << world.allocated_chunks() << std::endl;
+    std::cout << "world(0, 0) = " << cworld(0, 0) << ", world(-1, -1) = " << cworld(-1, -1) << ", world(-16, 15) = " << cworld(-16, 15) << std::endl;
+    std::cout << "world(1000000, -2000000) = " << cworld(1000000, -2000000) << ", world(500, 500) = " << cworld(500, 500) << std::endl;
+
+    int x = world(-500, 500);
+    std::cout << "read through proxy = " << x << ", allocated_chunks() = " << world.allocated_chunks() << std::endl;
+
+    // Fill a region across many chunks, which also grows the hash table
+    for (int y = -100; y < 100; ++y)
+    {
+        for (int x = -100; x < 100; ++x)
+            world(x, y) = x + y;
+    }
+    std::cout << "after fill: allocated_chunks() = " << world.allocated_chunks() << ", world(-100, 99) = " << cworld(-100, 99) << ", world(-1000, 0) = " << cworld(-1000, 0) << std::endl;
+
+    // Per-chunk iteration
+    std::size_t negative_chunks = 0;
+    cworld.for_each_chunk([&negative_chunks](const my_world_t::chunk& c)
+    {
+        if (c.x() < 0 && c.y() < 0)
+            ++negative_chunks;
+    });
+    std::cout << "chunks with negative coordinates = " << negative_chunks << std::endl;
+
+    // Element iteration with coordinates
+    const my_world_t copy = world;
+    bool equal = true;
+    std::size_t n = 0;
+    for (auto it = copy.begin(); it != copy.end(); ++it, ++n)
+    {
+        if (*it != cworld(it.x(), it.y()))
+            equal = false;
+    }
+    std::cout << "copy visited " << n << " elements, equal = " << std::boolalpha << equal << std::endl;
+
+    world.clear();
+    std::cout << "after clear: allocated_chunks() = " << world.allocated_chunks() << ", world(0, 0) = " << cworld(0, 0) << ", copy(0, 0) = " << copy(0, 0) << std::endl;
+}
+
+/* --- integral_grid test --- */
+
+static void integral_grid_test()
+{
+    TEST_HEADLINE;
+
+    const std::size_t size = 1024;
+
+    grid_vector<std::uint32_t> heatmap;
+    heatmap.resize(size, size);
+    for (std::size_t y = 0; y < size; ++y)
+    {
+        for (std::size_t x = 0; x < size; ++x)
+            heatmap(x, y) = static_cast<std::uint32_t>((x * 7 + y * 13) % 100);
+    }
+
+    auto WalkSum = [&heatmap](std::size_t x, std::size_t y, std::size_t w, std::size_t h)
+    {
+        std::uint64_t sum = 0;
+        for (std::size_t j = y; j < y + h; ++j)
+        {
+            for (std::size_t i = x; i < x + w; ++i)
+                sum += heatmap(i, j);
+        }
+        return sum;
+    };
+
+    integral_grid<std::uint32_t> table(heatmap), parallel_table;
+    parallel_table.build(default_thread_pool(), heatmap);
+
+    std::cout << "sum(10, 20, 64, 32) = " << table.sum(10, 20, 64, 32) << " (expected " << WalkSum(10, 20, 64, 32) << ")" << std::endl;
+    std::cout << "parallel sum() = " << parallel_table.sum() << " (expected " << WalkSum(0, 0, size, size) << ")" << std::endl;
+    std::cout << "count(-8, -8, 16, 16) = " << table.count(-8, -8, 16, 16) << ", mean(-8, -8, 16, 16) = " << table.mean(-8, -8, 16, 16)
+        << " (expected " << static_cast<double>(WalkSum(0, 0, 8, 8)) / 64.0 << ")" << std::endl;
+
+    // Incremental rebuild of dirty rows
+    for (std::size_t x = 0; x < size; ++x)
+        heatmap(x, 500) += 1;
+    heatmap(3, 501) = 1000;
+    table.update_rows(heatmap, 500, 502);
+    std::cout << "after update_rows: sum(0, 400, 100, 200) = " << table.sum(0, 400, 100, 200) << " (expected " << WalkSum(0, 400, 100, 200) << ")" << std::endl;
+
+    // Rectangle queries compared to walking the rectangle
+    const int num_queries = 10000;
+    std::uint64_t sum0 = 0, sum1 = 0;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_queries; ++i)
+        sum0 += WalkSum((i * 37) % 900, (i * 91) % 900, 64, 64);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_queries; ++i)
+        sum1 += table.sum((i * 37) % 900, (i * 91) % 900, 64, 64);
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "walk rectangles:     " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us" << std::endl;
+    std::cout << "integral_grid::sum:  " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us" << std::endl;
+    std::cout << "results equal: " << std::boolalpha << (sum0 == sum1) << std::endl;
+}
+
+/* --- grid_pyramid test --- */
+
+static void grid_pyramid_test()
+{
+    TEST_HEADLINE;
+
+    const std::size_t width = 1001, height = 777;
+
+    tracked_grid_vector<float> map;
+    map.resize(width, height);
+    for (std::size_t y = 0; y < height; ++y)
+    {
+        for (std::size_t x = 0; x < width; ++x)
+            map(x, y) = static_cast<float>((x * 7 + y * 13) % 100);
+    }
+
+    grid_pyramid<float, max_reducer> max_lod;
+    grid_pyramid<float, sum_reducer> sum_lod;
+    max_lod.build(map);
+    sum_lod.build(map);
+
+    std::cout << "levels = " << max_lod.levels() << ", level(0) = " << max_lod.level(0).width() << "x" << max_lod.level(0).height()
+        << ", last level = " << max_lod.level(max_lod.levels() - 1).width() << "x" << max_lod.level(max_lod.levels() - 1).height() << std::endl;
+
+    double sum = 0.0;
+    for (auto v : map)
+        sum += v;
+    std::cout << "top sum = " << sum_lod.level(sum_lod.levels() - 1)(0, 0) << " (expected " << sum << ")" << std::endl;
+    std::cout << "top max = " << max_lod.level(max_lod.levels() - 1)(0, 0) << " (expected 99)" << std::endl;
+
+    // Incremental update with the dirty regions of the source grid
+    map.enable_dirty_tracking(dirty_tracking::tiles);
+    map(500, 300) = 1000.0f;
+    map(1000, 776) = 2000.0f;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    max_lod.update(map, map.dirty_regions());
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    grid_pyramid<float, max_reducer> rebuilt_lod;
+    rebuilt_lod.build(map);
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    bool equal = true;
+    for (std::size_t i = 0; i < max_lod.levels(); ++i)
+        equal = equal && std::equal(max_lod.level(i).begin(), max_lod.level(i).end(), rebuilt_lod.level(i).begin());
+
+    std::cout << "level(0)(250, 150) = " << max_lod.level(0)(250, 150) << ", level(0)(500, 388) = " << max_lod.level(0)(500, 388) << std::endl;
+    std::cout << "top max after update = " << max_lod.level(max_lod.levels() - 1)(0, 0) << " (expected 2000)" << std::endl;
+    std::cout << "update equals rebuild: " << std::boolalpha << equal << std::endl;
+    std::cout << "grid_pyramid::update: " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us" << std::endl;
+    std::cout << "grid_pyramid::build:  " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us" << std::endl;
+}
+
 /* --- command_line test --- */
 
 static void command_line_test(int argc, char* argv[])
@@ -517,6 +2056,17 @@ static void member_function_test()
 
 /* --- local_vector --- */
 
+struct Counted
+{
+    Counted() { ++ctors; }
+    Counted(const Counted&) { ++ctors; }
+    ~Counted() { ++dtors; }
+    static int ctors, dtors;
+};
+
+int Counted::ctors = 0;
+int Counted::dtors = 0;
+
 static void local_vector_test()
 {
     local_vector<int, 32> a;
@@ -539,6 +2089,258 @@ static void local_vector_test()
     // Print sorted list
     std::sort(a.begin(), a.end());
     PrintList(a, "a");
+
+    // Emplace and erase
+    a.emplace(a.begin(), -1);
+    a.erase(a.begin() + 2, a.begin() + 4);
+    a.erase(a.end() - 1);
+    a.emplace_back(7);
+    PrintList(a, "a");
+
+    // Range insertion and assignment
+    const int values[] = { 10, 20, 30 };
+    a.insert(a.begin() + 1, std::begin(values), std::end(values));
+    a.insert(a.end(), { 100, 200 });
+    PrintList(a, "a");
+
+    a.assign(3, 5);
+    a.resize(5);
+    PrintList(a, "a");
+
+    // Elements are only constructed on insertion and destroyed on removal
+    {
+        local_vector<Counted, 64> b;
+        std::cout << "empty local_vector<Counted, 64>: " << Counted::ctors << " constructors" << std::endl;
+        b.resize(3);
+        b.pop_back();
+        b.emplace_back();
+        b.erase(b.begin());
+        std::cout << "after resize(3), pop_back, emplace_back, erase: size = " << b.size() << ", "
+            << Counted::ctors << " constructors, " << Counted::dtors << " destructors" << std::endl;
+    }
+    std::cout << "after destruction: " << Counted::ctors << " constructors, " << Counted::dtors << " destructors" << std::endl;
+
+    // Strings in local storage
+    local_vector<std::string, 64> c;
+    c.push_back("world");
+    c.emplace(c.begin(), "hello");
+    c.emplace_back(3, '!');
+    const std::string words[] = { "foo", "bar" };
+    c.insert(c.begin() + 1, std::begin(words), std::end(words));
+    c.erase(c.begin() + 1, c.begin() + 3);
+    local_vector<std::string, 64> d = std::move(c);
+    std::cout << "d = " << d.front() << ' ' << *(d.begin() + 1) << d.back() << " (size " << d.size() << "), c.size() = " << c.size() << std::endl;
+    std::cout << "is_nothrow_move_constructible = " << std::boolalpha << std::is_nothrow_move_constructible<local_vector<std::string, 64>>::value
+        << ", is_nothrow_move_assignable = " << std::is_nothrow_move_assignable<local_vector<std::string, 64>>::value << std::endl;
+
+    const int num_iterations = 1000000;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    std::size_t total = 0;
+    for (int i = 0; i < num_iterations; ++i)
+    {
+        local_vector<std::string, 64> e;
+        total += e.size() + e.capacity();
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    std::cout << "create empty local_vector<std::string, 64> " << num_iterations << " times: "
+        << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us (" << total << ")" << std::endl;
+}
+
+/* --- local_vector benchmark --- */
+
+// Runs 'func' the specified number of times and returns the duration in microseconds.
+template <typename Func>
+static long long local_vector_benchmark_run(int num_iterations, Func func)
+{
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_iterations; ++i)
+        func(i);
+    auto t1 = std::chrono::high_resolution_clock::now();
+    return static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count());
+}
+
+template <class Vector>
+static void local_vector_benchmark_size(const char* name, std::size_t size)
+{
+    const int num_iterations = 200000;
+    std::size_t checksum = 0;
+
+    Vector source;
+    for (std::size_t i = 0; i < size; ++i)
+        source.push_back(static_cast<int>(i));
+
+    const int extra[4] = { 1, 2, 3, 4 };
+
+    auto copy_time = local_vector_benchmark_run(
+        num_iterations,
+        [&](int)
+        {
+            Vector v(source);
+            checksum += v.size();
+        }
+    );
+
+    auto insert_time = local_vector_benchmark_run(
+        num_iterations,
+        [&](int i)
+        {
+            Vector v(source);
+            v.insert(v.begin(), i);
+            v.insert(v.begin() + 1, extra, extra + 4);
+            checksum += static_cast<std::size_t>(v.front()) + v.size();
+        }
+    );
+
+    auto resize_time = local_vector_benchmark_run(
+        num_iterations,
+        [&](int)
+        {
+            Vector v;
+            v.resize(size);
+            v.resize(size + 8, -1);
+            checksum += v.size();
+        }
+    );
+
+    auto assign_time = local_vector_benchmark_run(
+        num_iterations,
+        [&](int)
+        {
+            Vector v;
+            v.assign(source.begin(), source.end());
+            checksum += v.size();
+        }
+    );
+
+    std::cout << std::setw(24) << std::left << name << " size " << std::setw(3) << size << ": copy " << std::setw(6) << copy_time
+        << " us, insert " << std::setw(6) << insert_time << " us, resize " << std::setw(6) << resize_time
+        << " us, assign " << std::setw(6) << assign_time << " us (" << checksum << ")" << std::endl;
+}
+
+static void local_vector_benchmark()
+{
+    TEST_HEADLINE;
+
+    for (std::size_t size : { 4, 16, 48 })
+    {
+        local_vector_benchmark_size<std::vector<int>>("std::vector<int>", size);
+        local_vector_benchmark_size<local_vector<int, 64>>("local_vector<int, 64>", size);
+    }
+}
+
+/* --- small_vector --- */
+
+// Stateful allocator, which does not propagate on move assignment, so only allocators with the same id can take each other's memory.
+template <typename T>
+struct TaggedAllocator
+{
+    using value_type = T;
+
+    explicit TaggedAllocator(int id) : id { id } {}
+    template <typename U> TaggedAllocator(const TaggedAllocator<U>& rhs) : id { rhs.id } {}
+
+    T* allocate(std::size_t n) { return std::allocator<T>().allocate(n); }
+    void deallocate(T* p, std::size_t n) { std::allocator<T>().deallocate(p, n); }
+
+    int id;
+};
+
+template <typename T, typename U>
+bool operator == (const TaggedAllocator<T>& lhs, const TaggedAllocator<U>& rhs) { return (lhs.id == rhs.id); }
+
+template <typename T, typename U>
+bool operator != (const TaggedAllocator<T>& lhs, const TaggedAllocator<U>& rhs) { return (lhs.id != rhs.id); }
+
+static void small_vector_test()
+{
+    TEST_HEADLINE;
+
+    auto PrintList = [](const small_vector<std::string, 4>& l, const char* name)
+    {
+        std::cout << name << " = { ";
+        for (const auto& x : l)
+            std::cout << x << ", ";
+        std::cout << "} (size " << l.size() << ", capacity " << l.capacity() << ", inline " << std::boolalpha << l.is_inline() << ")" << std::endl;
+    };
+
+    small_vector<std::string, 4> a = { "a", "b", "c" };
+    PrintList(a, "a");
+
+    a.push_back(a.front());
+    PrintList(a, "a");
+
+    a.push_back(a.front());         // Spills to the heap, while the argument refers to the inline storage
+    a.emplace(a.begin() + 1, 3, 'x');
+    PrintList(a, "a");
+
+    a.erase(a.begin() + 1, a.begin() + 4);
+    PrintList(a, "a");
+
+    a.shrink_to_fit();
+    PrintList(a, "a");
+
+    small_vector<std::string, 4> b = std::move(a);
+    PrintList(b, "b");
+    PrintList(a, "a");
+
+    // Range insertion and assignment
+    const std::string words[] = { "p", "q", "r", "s", "t" };
+    small_vector<std::string, 4> e(std::begin(words), std::begin(words) + 2);
+    e.insert(e.begin() + 1, std::begin(words) + 2, std::end(words));
+    PrintList(e, "e");
+
+    e.insert(e.end(), { "u", "v" });
+    PrintList(e, "e");
+
+    e.assign(3, "w");
+    PrintList(e, "e");
+
+    e.assign({ "x", "y" });
+    PrintList(e, "e");
+
+    // Inline moves of trivially relocatable types
+    small_vector<int, 8> c = { 1, 2, 3, 4, 5 };
+    small_vector<int, 8> d = std::move(c);
+    d.resize(20, d.front());
+    std::cout << "d.size() = " << d.size() << ", d.capacity() = " << d.capacity() << ", d.back() = " << d.back()
+        << ", is_trivially_relocatable<int> = " << is_trivially_relocatable<int>::value
+        << ", is_nothrow_move_constructible = " << std::is_nothrow_move_constructible<small_vector<int, 8>>::value << std::endl;
+
+    // Move assignment with stateful allocators that do not propagate
+    typedef small_vector<int, 2, TaggedAllocator<int>> tagged_vector_t;
+    tagged_vector_t f(TaggedAllocator<int>(1)), g(TaggedAllocator<int>(2));
+    f.assign({ 1, 2, 3, 4 });
+    const int* f_data = f.data();
+    g = std::move(f);
+    std::cout << "move to other allocator: g.size() = " << g.size() << ", g.get_allocator().id = " << g.get_allocator().id
+        << ", memory taken = " << (g.data() == f_data) << ", is_nothrow_move_assignable = " << std::is_nothrow_move_assignable<tagged_vector_t>::value
+        << " (small_vector<int, 8>: " << std::is_nothrow_move_assignable<small_vector<int, 8>>::value << ")" << std::endl;
+
+    // Per-request lists with 2 to 8 items
+    const int num_iterations = 1000000;
+    std::size_t sum0 = 0, sum1 = 0;
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_iterations; ++i)
+    {
+        std::vector<int> list;
+        for (int j = 0, n = 2 + i % 7; j < n; ++j)
+            list.push_back(j);
+        sum0 += list.size();
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < num_iterations; ++i)
+    {
+        small_vector<int, 8> list;
+        for (int j = 0, n = 2 + i % 7; j < n; ++j)
+            list.push_back(j);
+        sum1 += list.size();
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    std::cout << "std::vector<int>:         " << std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count() << " us" << std::endl;
+    std::cout << "small_vector<int, 8>:     " << std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() << " us" << std::endl;
+    std::cout << "results equal: " << (sum0 == sum1) << std::endl;
 }
 
 /* --- main --- */
@@ -549,8 +2351,52 @@ int main(int argc, char* argv[])
     {
         //multi_array_test();
 
+        //multi_array_index_test();
+
+        //multi_array_storage_test();
+
+        //array_expression_test();
+
+        //multi_array_layout_test();
+
+        //multi_array_slice_copy_test();
+
+        //multi_array_constexpr_test();
+
+        //multi_array_reduce_test();
+
+        //parallel_algorithm_test();
+
+        //matrix_multiply_test();
+
+        //mapped_array_test();
+
+        //sparse_multi_array_test();
+
+        //stencil_test();
+
+        //convolution_test();
+
+        //dynamic_multi_array_test();
+
+        //multi_array_view_test();
+
         //grid_vector_test();
 
+        //grid_vector_pitch_test();
+
+        //grid_vector_resize_test();
+
+        //grid_vector_dirty_test();
+
+        //grid_vector_views_test();
+
+        //chunked_grid_test();
+
+        //integral_grid_test();
+
+        //grid_pyramid_test();
+
         //command_line_test(argc, argv);
 
         //bit_mask_test();
@@ -570,6 +2416,10 @@ int main(int argc, char* argv[])
         //member_function_test();
         
         local_vector_test();
+
+        //local_vector_benchmark();
+
+        //small_vector_test();
     }
     catch (const std::exception& err)
     {